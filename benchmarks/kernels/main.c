@@ -0,0 +1,177 @@
+//Measures the pixel row kernels of graphTe on the framebuffer backend, for every instruction set the processor supports.
+//Build: gcc -O2 -I../.. main.c -lm -pthread
+//The throughput is given in bytes moved per cycle of the time stamp counter, reads and writes both count.
+
+#define GRAPHTE_BACKEND_FRAMEBUFFER
+#include "graphTe.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	#define CYCLES() (double)__rdtsc()
+#else
+	//without a cycle counter the results are in bytes per nanosecond
+	#define CYCLES() (getTime() * 1e6)
+#endif
+
+const uint16 width = 1920, height = 1080;
+const int repeats = 200;
+
+const char* levelNames[4] = {"scalar", "sse2", "avx2", "avx512"};
+
+uint32_t* sourcePixels;
+uint32_t* translucentPixels;
+
+//a premultiplied pixel with pseudo-random color and alpha, in the 0xTTRRGGBB layout of graphTe (TT = 255 - alpha)
+uint32_t randomTranslucent(uint32_t seed)
+{
+	uint32_t bits = seed * 2654435761u, alpha = bits >> 24;
+	return (255 - alpha) << 24 | gtDiv255((bits >> 16 & 0xFF) * alpha) << 16 | gtDiv255((bits >> 8 & 0xFF) * alpha) << 8 | gtDiv255((bits & 0xFF) * alpha);
+}
+
+//a source image where one pixel in three has the transparent color, a pattern a per-pixel branch cannot predict,
+//and a translucent image for the blending kernels
+void makeSource()
+{
+	sourcePixels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+	translucentPixels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+	for(size_t i = 0; i < (size_t)width * height; i++)
+	{
+		sourcePixels[i] = i % 3 ? (uint32_t)(i * 2654435761u) & 0xFFFFFF : 0xFF00FF;
+		translucentPixels[i] = randomTranslucent((uint32_t)i);
+	}
+}
+
+void runFill()
+{
+	fill(rgb(12, 34, 56));
+}
+
+//an unaligned rectangle, the rows start and end in the middle of a vector
+void runRect()
+{
+	rect(13, 7, width - 27, height - 15, rgb(200, 100, 50));
+}
+
+void runCopy()
+{
+	gtBlit(0, 0, width, height, sourcePixels, width, FALSE, FALSE, 0);
+}
+
+void runKeyed()
+{
+	gtBlit(0, 0, width, height, sourcePixels, width, FALSE, TRUE, 0xFF00FF);
+}
+
+//a translucent overlay rectangle, every pixel is read, blended and written back
+void runBlend()
+{
+	rect(13, 7, width - 27, height - 15, rgba(200, 100, 50, 128));
+}
+
+//an image with a per-pixel alpha drawn at half opacity
+void runAlphaBlit()
+{
+	setOpacity(128);
+	gtBlit(0, 0, width, height, translucentPixels, width, TRUE, FALSE, 0);
+	setOpacity(255);
+}
+
+//the average bytes per cycle of one kernel, after a warm-up run
+double measure(void (*run)(), double bytes)
+{
+	run();
+
+	double start = CYCLES();
+	for(int i = 0; i < repeats; i++)
+		run();
+
+	return bytes * repeats / (CYCLES() - start);
+}
+
+//runs one kernel of the selected level: fill, copy, keyed copy, then the blend kernels in every mode, with and without opacity
+void runKernel(int kernel, uint32_t* destination, const uint32_t* source, int count)
+{
+	blendMode mode = (blendMode)((kernel - 3) % 3);
+
+	if(kernel == 0) gtKernels.fillRow(destination, count, 0x123456);
+	if(kernel == 1) gtKernels.copyRow(destination, source, count);
+	if(kernel == 2) gtKernels.keyRow(destination, source, count, 0xFF00FF);
+	if(kernel >= 3 && kernel < 6) gtKernels.blendRow(destination, count, source[0], mode);
+	if(kernel >= 6 && kernel < 9) gtKernels.blendCopyRow(destination, source, count, 255, mode);
+	if(kernel >= 9) gtKernels.blendCopyRow(destination, source, count, 77, mode);
+}
+
+//checks one kernel level against the scalar kernels on every length and alignment up to 64 pixels
+BOOL verify()
+{
+	uint32_t source[160], translucent[160], canvas[160], expected[160], actual[160];
+	kernelLevel level = gtKernels.level;
+
+	for(int i = 0; i < 160; i++)
+	{
+		source[i] = i % 5 ? (uint32_t)(i * 2654435761u) : 0xFF00FF;
+		translucent[i] = randomTranslucent(i + 1);
+		canvas[i] = (uint32_t)(i * 40503u * 2654435761u) & 0xFFFFFF;
+	}
+
+	for(int offset = 0; offset < 16; offset++)
+	{
+		for(int count = 0; count <= 64; count++)
+		{
+			for(int kernel = 0; kernel < 12; kernel++)
+			{
+				const uint32_t* input = kernel < 3 ? source + 3 : translucent + offset;
+
+				memcpy(expected, canvas, sizeof(canvas));
+				memcpy(actual, canvas, sizeof(canvas));
+
+				gtUseKernels(KERNELS_SCALAR);
+				runKernel(kernel, expected + offset, input, count);
+
+				gtUseKernels(level);
+				runKernel(kernel, actual + offset, input, count);
+
+				if(memcmp(expected, actual, sizeof(actual)))
+					return FALSE;
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+int main()
+{
+	initHost();
+	setWindowSize(width, height);
+	makeSource();
+
+	double pixels = (double)width * height, rectPixels = (double)(width - 27) * (height - 15);
+
+	printf("%ux%u canvas, %d runs per kernel, bytes per cycle\n", width, height, repeats);
+	printf("%-8s %8s %8s %8s %8s %8s %8s %8s\n", "kernels", "fill", "rect", "copy", "keyed", "blend", "alpha", "check");
+
+	for(int level = KERNELS_SCALAR; level <= KERNELS_AVX512; level++)
+	{
+		if(gtUseKernels((kernelLevel)level) != level)
+			break;
+
+		double fillRate = measure(runFill, pixels * 4);
+		double rectRate = measure(runRect, rectPixels * 4);
+		double copyRate = measure(runCopy, pixels * 8);
+		double keyedRate = measure(runKeyed, pixels * 8);
+		double blendRate = measure(runBlend, rectPixels * 8);
+		double alphaRate = measure(runAlphaBlit, pixels * 12);
+
+		printf("%-8s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f %8s\n", levelNames[level], fillRate, rectRate, copyRate, keyedRate, blendRate, alphaRate, verify() ? "ok" : "FAILED");
+	}
+
+	free(sourcePixels);
+	free(translucentPixels);
+	releaseHost();
+	return 0;
+}
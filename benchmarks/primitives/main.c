@@ -0,0 +1,450 @@
+//Measures every drawing primitive of graphTe at several sizes, then replays the scenes of the examples, on the framebuffer backend.
+//Build: gcc -O2 -I../.. main.c -lm -pthread
+//Run it from this directory, the image benchmarks load the assets of the examples.
+//The results are printed as CSV (benchmark,size,ns/call,Mpixels/s), save them to a file to keep them as a baseline:
+//	./a.out > baseline.csv
+//Passing that file compares a new run with it, the benchmarks that got slower than the tolerance (10% by default) are reported
+//on stderr and the exit code is 1:
+//	./a.out baseline.csv [tolerance in percent]
+
+#define GRAPHTE_BACKEND_FRAMEBUFFER
+#include "graphTe.h"
+
+#define MAX_RESULTS 64
+
+//the time each benchmark is repeated for, in milliseconds
+const double minimumTime = 200;
+
+char* imagePath = "../../examples/tetris/assets/controls.bmp";
+char* atlasImagePath = "../../examples/Chess/pieces/atlas.bmp";
+char* atlasIndexPath = "../../examples/Chess/pieces/atlas.txt";
+
+typedef struct
+{
+	char name[32];
+	int size;
+	double nanoseconds;
+	double megapixels;
+}
+result;
+
+result results[MAX_RESULTS];
+int resultCount = 0;
+
+//the size the current benchmark runs at
+int size;
+//the width and height of what one call of the current benchmark draws
+int extentX, extentY;
+
+//a position for the i-th call that keeps an extentX x extentY shape inside the canvas, so consecutive calls do not draw at the same place
+int16 positionX(int i)
+{
+	return (int16)(i * 37 % (getWindowSize().x - extentX + 1));
+}
+
+int16 positionY(int i)
+{
+	return (int16)(i * 23 % (getWindowSize().y - extentY + 1));
+}
+
+////////////////////////////////////////////////////////////
+// Primitives
+////////////////////////////////////////////////////////////
+
+void runPixel(int i)
+{
+	pixel(positionX(i), positionY(i), rgb(i, 128, 255));
+}
+
+void runRect(int i)
+{
+	rect(positionX(i), positionY(i), size, size, rgb(i, 128, 255));
+}
+
+void runFill(int i)
+{
+	fill(rgb(i, 34, 56));
+}
+
+//a diagonal line of size pixels
+void runLine(int i)
+{
+	int16 x = positionX(i), y = positionY(i);
+	line(x, y, x + size, y + size, 1, rgb(i, 200, 50));
+}
+
+void runEllipse(int i)
+{
+	ellipse(positionX(i), positionY(i), size, size / 2, rgb(i, 100, 200));
+}
+
+void runCircle(int i)
+{
+	circle(positionX(i), positionY(i), size / 2, rgb(i, 100, 200));
+}
+
+//the image is decoded once for every size and then drawn from the texture cache
+void runImage(int i)
+{
+	image(positionX(i), positionY(i), size, size, imagePath);
+}
+
+void runTransparentImage(int i)
+{
+	transparentImage(positionX(i), positionY(i), size, size, imagePath, rgb(0, 0, 0));
+}
+
+void runText(int i)
+{
+	text(positionX(i), positionY(i), "graphTe 0123456789", rgb(255, 255, 255));
+}
+
+//presents a frame where a size x size square was drawn, which also copies that square into the new back buffer
+void runDisplay(int i)
+{
+	gtAddDamage(0, 0, size, size);
+	display();
+}
+
+////////////////////////////////////////////////////////////
+// Scenes of the examples
+////////////////////////////////////////////////////////////
+
+//examples/mandelBrot set fractal, with every point computed on the calling thread and the shade() pool
+color mandelbrot(uint16 x, uint16 y, void* userData)
+{
+	double fx = (double)x / size * 4 - 2, fy = (double)y / size * 4 - 2;
+	double a = fx, b = fy;
+	int i = 0;
+
+	while(i++ < 100 && a * a + b * b < 100)
+	{
+		double next = a * a - b * b + fx;
+		b = 2 * a * b + fy;
+		a = next;
+	}
+
+	return rgb(i * 255 / 101, i * 255 / 101, i > 80 ? 80 + (i - 80) * 175 / 21 : 80);
+}
+
+void runMandelbrot(int i)
+{
+	shade(0, 0, size, size, mandelbrot, NULL);
+	display();
+}
+
+//examples/koch snowflake fractal, the outline of four recursion levels drawn with one antialiased polyline
+vector2f kochOutline[3 * 256 + 1];
+int kochCount = 0;
+
+void kochLine(vector2f start, vector2f end, int level)
+{
+	if(level == 4)
+	{
+		kochOutline[kochCount++] = start;
+		return;
+	}
+
+	vector2f b = {start.x * 2 / 3 + end.x / 3, start.y * 2 / 3 + end.y / 3};
+	vector2f d = {start.x / 3 + end.x * 2 / 3, start.y / 3 + end.y * 2 / 3};
+	float angle = -3.14159265f / 3;
+	vector2f c = {(d.x - b.x) * cosf(angle) - (d.y - b.y) * sinf(angle) + b.x, (d.x - b.x) * sinf(angle) + (d.y - b.y) * cosf(angle) + b.y};
+
+	kochLine(start, b, level + 1);
+	kochLine(b, c, level + 1);
+	kochLine(c, d, level + 1);
+	kochLine(d, end, level + 1);
+}
+
+void runKoch(int i)
+{
+	fill(rgb(10, 10, 10));
+	setAntialiasing(TRUE);
+	polyline(kochOutline, kochCount, 2, rgb(100, 255, 100));
+	setAntialiasing(FALSE);
+	display();
+}
+
+//examples/3d cube, 12 shaded and depth tested triangles turning a little every frame
+void runCube(int i)
+{
+	int faces[6][4] = {{0, 1, 2, 3}, {4, 5, 6, 7}, {0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, {3, 0, 4, 7}};
+	float angle = i * 0.01f, half = size / 4.0f;
+	vertex corners[8];
+
+	for(int j = 0; j < 8; j++)
+	{
+		float x = j % 4 == 1 || j % 4 == 2 ? half : -half, y = j % 4 >= 2 ? half : -half, z = j >= 4 ? half : -half;
+		float turnedX = x * cosf(angle) + z * sinf(angle), turnedZ = z * cosf(angle) - x * sinf(angle);
+		float turnedY = y * cosf(angle * 0.7f) - turnedZ * sinf(angle * 0.7f);
+		turnedZ = y * sinf(angle * 0.7f) + turnedZ * cosf(angle * 0.7f);
+		uint16 light = (uint16)(255 - (turnedZ / half + 1) * 90);
+		corners[j] = (vertex){size / 2 + turnedX, size / 2 + turnedY, turnedZ / (4 * half) + 0.5f, rgb(0, light, light)};
+	}
+
+	fill(rgb(50, 50, 50));
+	clearDepth();
+	for(int j = 0; j < 6; j++)
+	{
+		shadedTriangle(corners[faces[j][0]], corners[faces[j][1]], corners[faces[j][2]]);
+		shadedTriangle(corners[faces[j][0]], corners[faces[j][2]], corners[faces[j][3]]);
+	}
+	display();
+}
+
+//examples/tetris, the background image, a half filled board, the grid and the score
+void runTetris(int i)
+{
+	const uint16 square = 32;
+	color colors[8] = {rgb(0, 0, 0), rgb(0, 255, 255), rgb(255, 255, 0), rgb(128, 0, 128), rgb(0, 255, 0), rgb(255, 0, 0), rgb(0, 0, 255), rgb(255, 128, 0)};
+
+	fill(colors[0]);
+	image(0, 0, 600, 700, imagePath);
+
+	for(int x = 0; x < 10; x++)
+		for(int y = 10; y < 20; y++)
+			if((x * 7 + y * 3 + i) % 5)
+				rect(x * square, y * square, square, square, colors[1 + (x + y) % 7]);
+
+	for(int x = 0; x <= 10; x++)
+		line(x * square, 0, x * square, square * 20, square / 16, rgb(30, 30, 30));
+	for(int y = 0; y <= 20; y++)
+		line(0, y * square, 10 * square, y * square, square / 16, rgb(30, 30, 30));
+
+	text(400, 64, "score: 1250", rgb(255, 255, 255));
+	text(400, 128, "level: 3", rgb(255, 255, 255));
+	display();
+}
+
+//examples/Chess, the recorded board and notation, and the 32 pieces drawn from the atlas in one batch
+commandBuffer boardCommands, notationCommands;
+spriteAtlas piecesAtlas;
+spriteDraw chessPieces[32];
+
+void prepareChess()
+{
+	const char* names[6] = {"Rook", "Knight", "Bishop", "Queen", "King", "Pawn"};
+	const int order[8] = {0, 1, 2, 3, 4, 2, 1, 0};
+	char name[16];
+
+	boardCommands = createCommandBuffer();
+	beginCommands(boardCommands);
+	for(int x = 0; x < 8; x++)
+		for(int y = 0; y < 8; y++)
+			rect(x * 100, y * 100, 100, 100, (x + y) % 2 ? rgb(184, 136, 97) : rgb(239, 220, 180));
+	endCommands();
+	sortCommands(boardCommands);
+
+	notationCommands = createCommandBuffer();
+	beginCommands(notationCommands);
+	for(int i = 0; i < 8; i++)
+	{
+		char letter[2] = {'A' + i, 0}, digit[2] = {'8' - i, 0};
+		text((i + 1) * 100 - 15, 800 - 15, letter, rgb(0, 0, 0));
+		text(0, i * 100, digit, rgb(0, 0, 0));
+	}
+	endCommands();
+
+	piecesAtlas = loadSpriteAtlas(atlasImagePath, atlasIndexPath);
+	for(int x = 0; x < 8; x++)
+	{
+		sprintf(name, "black%s", names[order[x]]);
+		chessPieces[x] = (spriteDraw){findSprite(piecesAtlas, name), x * 100, 0};
+		sprintf(name, "white%s", names[order[x]]);
+		chessPieces[8 + x] = (spriteDraw){findSprite(piecesAtlas, name), x * 100, 700};
+		chessPieces[16 + x] = (spriteDraw){findSprite(piecesAtlas, "blackPawn"), x * 100, 100};
+		chessPieces[24 + x] = (spriteDraw){findSprite(piecesAtlas, "whitePawn"), x * 100, 600};
+	}
+}
+
+void runChess(int i)
+{
+	fill(rgb(0, 0, 0));
+	drawCommands(boardCommands);
+	drawSprites(piecesAtlas, chessPieces, 32);
+	drawCommands(notationCommands);
+	display();
+}
+
+////////////////////////////////////////////////////////////
+// Measures
+////////////////////////////////////////////////////////////
+
+//the average time of one call in nanoseconds, the calls are doubled until they take at least minimumTime
+double measure(void (*run)(int i))
+{
+	//the first call loads the caches (images, text layouts) and is not counted
+	run(0);
+	display();
+
+	long calls = 1;
+	double time;
+	for(;;)
+	{
+		double start = getTime();
+		for(long i = 0; i < calls; i++)
+			run((int)i);
+		time = getTime() - start;
+
+		if(time >= minimumTime)
+			break;
+		calls *= 2;
+	}
+
+	display();
+	return time * 1e6 / calls;
+}
+
+//measures one benchmark and prints its CSV line, one call draws into a width x height area and covers pixels of it
+void benchArea(char* name, void (*run)(int i), int benchSize, int width, int height, double pixels)
+{
+	size = benchSize;
+	extentX = width;
+	extentY = height;
+	double nanoseconds = measure(run);
+
+	result* entry = &results[resultCount++];
+	snprintf(entry->name, sizeof(entry->name), "%s", name);
+	entry->size = benchSize;
+	entry->nanoseconds = nanoseconds;
+	entry->megapixels = pixels * 1e3 / nanoseconds;
+
+	printf("%s,%d,%.1f,%.2f\n", entry->name, entry->size, entry->nanoseconds, entry->megapixels);
+	fflush(stdout);
+}
+
+//measures a benchmark drawing size x size shapes
+void bench(char* name, void (*run)(int i), int benchSize, double pixels)
+{
+	benchArea(name, run, benchSize, benchSize, benchSize, pixels);
+}
+
+//compares the results with the ones of an earlier run, returns the number of benchmarks slower than the tolerance
+int compare(char* baselinePath, double tolerance)
+{
+	FILE* file = fopen(baselinePath, "r");
+	if(!file)
+	{
+		fprintf(stderr, "cannot open %s\n", baselinePath);
+		return -1;
+	}
+
+	char line[256], name[32];
+	int benchSize, slower = 0;
+	double nanoseconds, megapixels;
+
+	while(fgets(line, sizeof(line), file))
+	{
+		if(sscanf(line, "%31[^,],%d,%lf,%lf", name, &benchSize, &nanoseconds, &megapixels) != 4)
+			continue;
+
+		for(int i = 0; i < resultCount; i++)
+		{
+			if(strcmp(results[i].name, name) || results[i].size != benchSize)
+				continue;
+
+			double change = (results[i].nanoseconds / nanoseconds - 1) * 100;
+			if(change > tolerance)
+			{
+				fprintf(stderr, "SLOWER  %-18s %5d %10.1f ns -> %10.1f ns (%+.1f%%)\n", name, benchSize, nanoseconds, results[i].nanoseconds, change);
+				slower++;
+			}
+			else if(change < -tolerance)
+				fprintf(stderr, "faster  %-18s %5d %10.1f ns -> %10.1f ns (%+.1f%%)\n", name, benchSize, nanoseconds, results[i].nanoseconds, change);
+		}
+	}
+
+	fclose(file);
+	return slower;
+}
+
+int main(int argc, char** argv)
+{
+	const int shapeSizes[3] = {4, 32, 256}, canvasSizes[3] = {320, 1280, 1920};
+
+	initHost();
+	printf("benchmark,size,ns/call,Mpixels/s\n");
+
+	setWindowSize(1280, 720);
+	bench("pixel", runPixel, 1, 1);
+	for(int i = 0; i < 3; i++)
+	{
+		int s = shapeSizes[i];
+		bench("rect", runRect, s, (double)s * s);
+		bench("line", runLine, s, s);
+		bench("ellipse", runEllipse, s, 3.14159 * s * s / 8);
+		bench("circle", runCircle, s, 3.14159 * s * s / 4);
+	}
+
+	//the image benchmarks need the assets of the examples
+	FILE* asset = fopen(imagePath, "rb");
+	BOOL haveAssets = asset != NULL;
+	if(haveAssets)
+	{
+		fclose(asset);
+		for(int i = 1; i < 3; i++)
+		{
+			int s = shapeSizes[i];
+			bench("image", runImage, s, (double)s * s);
+			bench("transparentImage", runTransparentImage, s, (double)s * s);
+		}
+	}
+	else
+		fprintf(stderr, "%s not found, the image benchmarks are skipped\n", imagePath);
+
+	for(int textSize = 8; textSize <= 32; textSize *= 2)
+	{
+		setTextSize(textSize);
+		vector2u extent = measureText("graphTe 0123456789");
+		benchArea("text", runText, textSize, extent.x, extent.y, (double)extent.x * extent.y);
+	}
+	setTextSize(0);
+
+	for(int i = 0; i < 3; i++)
+	{
+		int s = canvasSizes[i];
+		setWindowSize(s, s * 9 / 16);
+		bench("fill", runFill, s, (double)s * (s * 9 / 16));
+		bench("display", runDisplay, s * 9 / 16, (double)(s * 9 / 16) * (s * 9 / 16));
+	}
+
+	//the scenes draw a whole frame, display() included, at the canvas size of the example
+	setWindowSize(500, 500);
+	bench("mandelbrot", runMandelbrot, 500, 500.0 * 500);
+
+	setWindowSize(1000, 1000);
+	kochLine((vector2f){500, 300}, (vector2f){750, 700}, 0);
+	kochLine((vector2f){750, 700}, (vector2f){250, 700}, 0);
+	kochLine((vector2f){250, 700}, (vector2f){500, 300}, 0);
+	kochOutline[kochCount++] = kochOutline[0];
+	bench("koch", runKoch, 1000, 1000.0 * 1000);
+
+	setDepthBuffer(DEPTH_16);
+	bench("cube", runCube, 1000, 1000.0 * 1000);
+	setDepthBuffer(DEPTH_NONE);
+
+	if(haveAssets)
+	{
+		setWindowSize(600, 700);
+		bench("tetris", runTetris, 600, 600.0 * 700);
+
+		setWindowSize(800, 800);
+		prepareChess();
+		bench("chess", runChess, 800, 800.0 * 800);
+		freeCommandBuffer(boardCommands);
+		freeCommandBuffer(notationCommands);
+		freeSpriteAtlas(piecesAtlas);
+	}
+
+	releaseHost();
+
+	if(argc > 1)
+	{
+		int slower = compare(argv[1], argc > 2 ? atof(argv[2]) : 10);
+		if(slower > 0)
+			fprintf(stderr, "%d benchmarks are slower than the baseline\n", slower);
+		return slower != 0;
+	}
+
+	return 0;
+}
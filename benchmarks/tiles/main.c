@@ -0,0 +1,116 @@
+//Measures how drawCommands() scales with the number of threads, on the framebuffer backend.
+//Build: gcc -O2 -I../.. main.c -lm -pthread
+//The scene is drawn once on a single thread, then with more and more threads, every frame is compared with the single thread one.
+
+#define GRAPHTE_BACKEND_FRAMEBUFFER
+#include "graphTe.h"
+
+const uint16 width = 1920, height = 1080;
+const int repeats = 20;
+
+uint32_t seed = 12345;
+
+//a pseudo-random number in [0, range)
+float randomFloat(float range)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (seed >> 8) * (1.0f / 16777216) * range;
+}
+
+color randomColor(uint16 alpha)
+{
+	return rgba((uint16)randomFloat(256), (uint16)randomFloat(256), (uint16)randomFloat(256), alpha);
+}
+
+//a mix of everything the tiles draw: a background, depth tested triangles, translucent rectangles and ellipses, then antialiased paths over them
+void recordScene(commandBuffer scene)
+{
+	beginCommands(scene);
+
+	rect(0, 0, width, height, rgb(20, 24, 32));
+
+	for(int i = 0; i < 20000; i++)
+	{
+		float x = randomFloat(width), y = randomFloat(height), size = 4 + randomFloat(60), z = randomFloat(1);
+		vertex a = {x, y, z, randomColor(255)};
+		vertex b = {x + randomFloat(size) - size / 2, y + randomFloat(size) - size / 2, z, randomColor(255)};
+		vertex c = {x + randomFloat(size) - size / 2, y + randomFloat(size) - size / 2, z, randomColor(255)};
+		shadedTriangle(a, b, c);
+	}
+
+	setBlendMode(BLEND_ALPHA);
+	for(int i = 0; i < 2000; i++)
+	{
+		if(i % 2)
+			rect((int16)randomFloat(width), (int16)randomFloat(height), (uint16)randomFloat(200), (uint16)randomFloat(200), randomColor(100));
+		else
+			ellipse((int16)randomFloat(width), (int16)randomFloat(height), (uint16)randomFloat(200), (uint16)randomFloat(200), randomColor(150));
+	}
+
+	setAntialiasing(TRUE);
+	for(int i = 0; i < 300; i++)
+	{
+		vector2f points[16] = {{randomFloat(width), randomFloat(height)}};
+		for(int j = 1; j < 16; j++)
+			points[j] = (vector2f){points[j - 1].x + randomFloat(80) - 40, points[j - 1].y + randomFloat(80) - 40};
+		polyline(points, 16, 1 + randomFloat(6), randomColor(200));
+	}
+	setAntialiasing(FALSE);
+
+	for(int i = 0; i < 2000; i++)
+		line((int16)randomFloat(width), (int16)randomFloat(height), (int16)randomFloat(width), (int16)randomFloat(height), 1 + (uint16)randomFloat(3), randomColor(255));
+
+	endCommands();
+}
+
+void drawFrame(commandBuffer scene)
+{
+	clearDepth();
+	drawCommands(scene);
+}
+
+int main()
+{
+	initHost();
+	setWindowSize(width, height);
+	setDepthBuffer(DEPTH_16);
+
+	commandBuffer scene = createCommandBuffer();
+	recordScene(scene);
+
+	size_t pixelCount = (size_t)host.stride * height;
+	uint32_t* expected = (uint32_t*)malloc(pixelCount * sizeof(uint32_t));
+	setThreadCount(1);
+	drawFrame(scene);
+	memcpy(expected, host.pixels, pixelCount * sizeof(uint32_t));
+
+	int processors = gtProcessorCount();
+	double single = 0;
+
+	printf("%ux%u canvas, %u commands, %d frames per thread count\n", width, height, gtCommands.entries[scene].count, repeats);
+	printf("%-8s %10s %8s %8s\n", "threads", "ms/frame", "speedup", "check");
+	//1, 2, 4... threads, up to one per processor
+	for(int threads = 1; ; threads *= 2)
+	{
+		if(threads > processors)
+			threads = processors;
+		setThreadCount(threads);
+		drawFrame(scene);
+
+		double start = getTime();
+		for(int i = 0; i < repeats; i++)
+			drawFrame(scene);
+		double time = (getTime() - start) / repeats;
+		if(threads == 1)
+			single = time;
+
+		printf("%-8d %10.2f %8.2f %8s\n", threads, time, single / time, memcmp(expected, host.pixels, pixelCount * sizeof(uint32_t)) ? "FAILED" : "ok");
+		if(threads == processors)
+			break;
+	}
+
+	free(expected);
+	freeCommandBuffer(scene);
+	releaseHost();
+	return 0;
+}
@@ -1,5 +1,4 @@
 #include "graphTe.h"
-#include <time.h>
 #include <math.h>
 
 #define PI 3.14159265359
@@ -9,114 +8,154 @@ typedef struct
 	double x, y, z;
 }POINT3D;
 
-typedef struct 
-{
-	int x, y;
-}POINT2D;
+//constants:
+color COLOR_BG = (color){50, 50, 50};
+color COLOR_CUBE = (color){0, 255, 255};
 
-int main()
-{
-	initHost();
+double SPEED_X = 0.05;
+double SPEED_Y = 0.15;
+double SPEED_Z = 0.10;
 
-	//constants:
-	color COLOR_BG = (color){50, 50, 50, 1};
-	color COLOR_CUBE = (color){0, 255, 255, 1};
+double h = 1000;
+double w = 1000;
 
-	double SPEED_X = 0.05;
-	double SPEED_Y = 0.15;
-	double SPEED_Z = 0.10;
+double cx, cy, cz, size;
 
-	double h = 1000;
-	double w = 1000;
+//the cube after the last update and the one before it, the frames are interpolated between both
+POINT3D vertices[8], previousVertices[8];
 
-	double lineWidth = w / 100;
+//the faces as quads of vertices, each one drawn as two triangles
+int faces[6][4] = 
+{
+	{0, 1, 2, 3}, {4, 5, 6, 7}, //back and front faces
+	{0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, {3, 0, 4, 7} //connecting sides 
+};
 
-	double timeDelta, timeNow, timeLast = 0;
+//advances the rotation by one fixed step of the game loop
+void rotate(double timeDelta)
+{
+	for(int i = 0; i < 8; i++)
+		previousVertices[i] = vertices[i];
 
-	double cx = w / 2;
-	double cy = h / 2;
-	double cz = 0;
-	double size = h / 4;
-	POINT3D vertices[8] = 
+	//rotate the cube along the z axis
+	double angle = timeDelta * 0.001 * SPEED_Z * PI * 2;
+	for(int i = 0; i < 8; i++)
 	{
-		{cx - size, cy - size, cz - size},
-		{cx + size, cy - size, cz - size},
-		{cx + size, cy + size, cz - size},
-		{cx - size, cy + size, cz - size},
-		{cx - size, cy - size, cz + size},
-		{cx + size, cy - size, cz + size},
-		{cx + size, cy + size, cz + size},
-		{cx - size, cy + size, cz + size}
-	};
+		double dx = vertices[i].x - cx;
+		double dy = vertices[i].y - cy;
+		double x = dx * cos(angle) - dy * sin(angle);
+		double y = dx * sin(angle) + dy * cos(angle);
+
+		vertices[i].x = x + cx;
+		vertices[i].y = y + cy;
+	}
 
-	POINT2D edges[12] = 
+	//rotate the cube along the x axis
+	angle = timeDelta * 0.001 * SPEED_X * PI * 2;
+	for(int i = 0; i < 8; i++)
 	{
-		{0, 1}, {1, 2}, {2, 3}, {3, 0}, //back face
-		{4, 5}, {5, 6}, {6, 7}, {7, 4}, //front face
-		{0, 4}, {1, 5}, {2, 6}, {3, 7}  //connecting sides 
-	};
+		double dy = vertices[i].y - cy;
+		double dz = vertices[i].z - cz;
+		double y = dy * cos(angle) - dz * sin(angle);
+		double z = dy * sin(angle) + dz * cos(angle);
 
-	setWindowTitle("3d cube");
-	setWindowSize(w, h);
-	update();
+		vertices[i].y = y + cy;
+		vertices[i].z = z + cz;
+	}
 
-	while(1)
+	//rotate the cube along the y axis
+	angle = timeDelta * 0.001 * SPEED_Y * PI * 2;
+	for(int i = 0; i < 8; i++)
 	{
-		timeNow = clock();
-		timeDelta =  timeNow - timeLast;
-		timeLast = timeNow;
+		double dx = vertices[i].x - cx;
+		double dz = vertices[i].z - cz;
+		double x = dz * sin(angle) + dx * cos(angle);
+		double z = dz * cos(angle) - dx * sin(angle);
 
-		//background:
-		fill(COLOR_BG);
-
-		//rotate the cube along the z axis
-		double angle = timeDelta * 0.001 * SPEED_Z * PI * 2;
-		for(int i = 0; i < 8; i++)
-		{
-			double dx = vertices[i].x - cx;
-			double dy = vertices[i].y - cy;
-			double x = dx * cos(angle) - dy * sin(angle);
-			double y = dx * sin(angle) + dy * cos(angle);
+		vertices[i].x = x + cx;
+		vertices[i].z = z + cz;
+	}
+}
 
-			vertices[i].x = x + cx;
-			vertices[i].y = y + cy;
-		}
+//draws the cube between the last two updates
+void render(double alpha)
+{
+	//background:
+	fill(COLOR_BG);
 
-		//rotate the cube along the x axis
-		angle = timeDelta * 0.001 * SPEED_X * PI * 2;
-		for(int i = 0; i < 8; i++)
-		{
-			double dy = vertices[i].y - cy;
-			double dz = vertices[i].z - cz;
-			double y = dy * cos(angle) - dz * sin(angle);
-			double z = dy * sin(angle) + dz * cos(angle);
+	//the depth buffer sorts the faces, so they can be drawn in any order
+	clearDepth();
 
-			vertices[i].y = y + cy;
-			vertices[i].z = z + cz;
-		}
+	POINT3D current[8];
+	vertex projected[8];
+	for(int i = 0; i < 8; i++)
+	{
+		current[i].x = previousVertices[i].x + (vertices[i].x - previousVertices[i].x) * alpha;
+		current[i].y = previousVertices[i].y + (vertices[i].y - previousVertices[i].y) * alpha;
+		current[i].z = previousVertices[i].z + (vertices[i].z - previousVertices[i].z) * alpha;
 
-		//rotate the cube along the y axis
-		angle = timeDelta * 0.001 * SPEED_Y * PI * 2;
-		for(int i = 0; i < 8; i++)
-		{
-			double dx = vertices[i].x - cx;
-			double dz = vertices[i].z - cz;
-			double x = dz * sin(angle) + dx * cos(angle);
-			double z = dz * cos(angle) - dx * sin(angle);
+		//the farther half of the cube fades into the background
+		double depth = (current[i].z - cz) / (4 * size) + 0.5;
+		projected[i] = (vertex){current[i].x, current[i].y, depth, COLOR_CUBE};
+	}
 
-			vertices[i].x = x + cx;
-			vertices[i].z = z + cz;
-		}
+	//draw the cube:
+	for(int i = 0; i < 6; i++)
+	{
+		POINT3D a = current[faces[i][0]], b = current[faces[i][1]], c = current[faces[i][2]];
 
+		//the light comes from the viewer, a face is lit by how much it faces the screen
+		double nx = (b.y - a.y) * (c.z - a.z) - (b.z - a.z) * (c.y - a.y);
+		double ny = (b.z - a.z) * (c.x - a.x) - (b.x - a.x) * (c.z - a.z);
+		double nz = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		double light = 0.25 + 0.75 * fabs(nz) / sqrt(nx * nx + ny * ny + nz * nz);
 
-		//draw the cube:
-		for(int i = 0; i < 12; i++)
+		vertex corners[4];
+		for(int j = 0; j < 4; j++)
 		{
-			line(vertices[edges[i].x].x, vertices[edges[i].x].y, vertices[edges[i].y].x, vertices[edges[i].y].y, lineWidth, COLOR_CUBE);
+			double shade = light * (1 - 0.75 * projected[faces[i][j]].z);
+			corners[j] = projected[faces[i][j]];
+			corners[j].fillColor = rgb(COLOR_CUBE.red * shade, COLOR_CUBE.green * shade, COLOR_CUBE.blue * shade);
 		}
 
-		display();
+		shadedTriangle(corners[0], corners[1], corners[2]);
+		shadedTriangle(corners[0], corners[2], corners[3]);
 	}
+
+	display();
+}
+
+int main()
+{
+	initHost();
+
+	cx = w / 2;
+	cy = h / 2;
+	cz = 0;
+	size = h / 4;
+	POINT3D cube[8] = 
+	{
+		{cx - size, cy - size, cz - size},
+		{cx + size, cy - size, cz - size},
+		{cx + size, cy + size, cz - size},
+		{cx - size, cy + size, cz - size},
+		{cx - size, cy - size, cz + size},
+		{cx + size, cy - size, cz + size},
+		{cx + size, cy + size, cz + size},
+		{cx - size, cy + size, cz + size}
+	};
+
+	for(int i = 0; i < 8; i++)
+		vertices[i] = previousVertices[i] = cube[i];
+
+	setWindowTitle("3d cube");
+	setWindowSize(w, h);
+	setDepthBuffer(DEPTH_16);
+	//the next frame is drawn while the previous one is written to the terminal, a late frame is replaced by the newer one (does nothing on GDI)
+	setPresentMode(PRESENT_DROP);
+
+	//100 rotation steps per second, drawn at 60 frames per second
+	runGameLoop(rotate, render, 100, 60);
 		
 	releaseHost();
 }
@@ -126,48 +126,55 @@ void drawNotation()
 	text(0, 0 * pieceSize, "8", rgb(0, 0, 0));
 }
 
+//all 12 pieces are packed into a single sprite atlas, loaded once at startup
+spriteAtlas piecesAtlas;
+sprite pieceSprites[128];
+
+void loadPieces()
+{
+	const char* names[12][2] = {{"r", "blackRook"}, {"n", "blackKnight"}, {"b", "blackBishop"}, {"q", "blackQueen"}, {"k", "blackKing"}, {"p", "blackPawn"},
+								{"R", "whiteRook"}, {"N", "whiteKnight"}, {"B", "whiteBishop"}, {"Q", "whiteQueen"}, {"K", "whiteKing"}, {"P", "whitePawn"}};
+
+	piecesAtlas = loadSpriteAtlas("pieces/atlas.bmp", "pieces/atlas.txt");
+
+	for(int i = 0; i < 128; i++)
+		pieceSprites[i] = -1;
+	for(int i = 0; i < 12; i++)
+		pieceSprites[(int)names[i][0][0]] = findSprite(piecesAtlas, (char*)names[i][1]);
+}
+
 void drawPiece(int x, int y, int posX, int posY)
 {
-	switch(pieces[x][y])
+	if(pieces[x][y])
+		drawSprite(piecesAtlas, pieceSprites[(int)pieces[x][y]], posX, posY);
+}
+
+//the squares and the notation never change, they are recorded once and replayed every frame
+commandBuffer boardCommands, notationCommands;
+
+void recordBoard()
+{
+	boardCommands = createCommandBuffer();
+	beginCommands(boardCommands);
+	for(int x = 0; x < 8; x++)
 	{
-		case 'r':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/blackRook.bmp",rgb(0, 255, 0));
-			break;
-		case 'n':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/blackKnight.bmp",rgb(0, 255, 0));
-			break;
-		case 'b':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/blackBishop.bmp",rgb(0, 255, 0));
-			break;
-		case 'q':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/blackQueen.bmp",rgb(0, 255, 0));
-			break;
-		case 'k':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/blackKing.bmp",rgb(0, 255, 0));
-			break;
-		case 'p':
-	transparentImage(posX, posY, pieceSize, pieceSize, "pieces/blackPawn.bmp",rgb(0, 255, 0));
-			break;
-
-		case 'R':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/whiteRook.bmp",rgb(0, 255, 0));
-			break;
-		case 'N':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/whiteKnight.bmp",rgb(0, 255, 0));
-			break;
-		case 'B':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/whiteBishop.bmp",rgb(0, 255, 0));
-			break;
-		case 'Q':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/whiteQueen.bmp",rgb(0, 255, 0));
-			break;
-		case 'K':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/whiteKing.bmp",rgb(0, 255, 0));
-			break;
-		case 'P':
-			transparentImage(posX, posY, pieceSize, pieceSize, "pieces/whitePawn.bmp",rgb(0, 255, 0));
-			break;
+		for(int y = 0; y < 8; y++)
+		{
+			if((x + y) % 2)
+				rect(x * pieceSize, y * pieceSize, pieceSize, pieceSize, rgb(184, 136, 97));
+			else
+				rect(x * pieceSize, y * pieceSize, pieceSize, pieceSize, rgb(239, 220, 180));
+		}
 	}
+	endCommands();
+
+	//the squares do not overlap, so all the squares of one color end up next to each other
+	sortCommands(boardCommands);
+
+	notationCommands = createCommandBuffer();
+	beginCommands(notationCommands);
+	drawNotation();
+	endCommands();
 }
 
 void changeMouseState()
@@ -184,18 +191,18 @@ void render()
 	fill(rgb(0, 0, 0));
 
 	//board:
+	spriteDraw boardPieces[64];
+	uint16 pieceCount = 0;
+
+	drawCommands(boardCommands);
+
 	for(int x = 0; x < 8; x++)
-	{
 		for(int y = 0; y < 8; y++)
-		{
-			if((x + y) % 2)
-				rect(x * pieceSize, y * pieceSize, pieceSize, pieceSize, rgb(184, 136, 97));
-			else
-				rect(x * pieceSize, y * pieceSize, pieceSize, pieceSize, rgb(239, 220, 180));
+			if(pieces[x][y])
+				boardPieces[pieceCount++] = (spriteDraw){pieceSprites[(int)pieces[x][y]], x * pieceSize, y * pieceSize};
 
-			drawPiece(x, y, x * pieceSize, y * pieceSize);
-		}
-	}
+	//every piece on the board is drawn from the atlas in a single batch
+	drawSprites(piecesAtlas, boardPieces, pieceCount);
 	
 	//MousePiece:
 	if(mouseState == 1)
@@ -205,12 +212,12 @@ void render()
 		else
 			rect(selectedX * pieceSize, selectedY * pieceSize, pieceSize, pieceSize, rgb(239, 220, 180));
 
-		drawNotation();
+		drawCommands(notationCommands);
 		drawPiece(selectedX, selectedY, mPos.x - pieceSize / 2, mPos.y - pieceSize / 2);
 	}
 	else
 	{
-		drawNotation();
+		drawCommands(notationCommands);
 	}
 	
 
@@ -275,14 +282,17 @@ int main()
 	initHost();
 	setWindowTitle("Chess - Ene Alexandru_Florin");
 	setWindowSize(2000, 1000);
-	update();
 	
 	resetBoard();
+	loadPieces();
+	recordBoard();
 	while(1)
 	{		
 		playerInput();
 		render();
 	}
 
+	freeCommandBuffer(boardCommands);
+	freeCommandBuffer(notationCommands);
 	releaseHost();
 }
\ No newline at end of file
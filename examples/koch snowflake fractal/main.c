@@ -12,15 +12,18 @@ point;
 #define w 1000
 #define h 1000
 
-color lColor = {100, 255, 100, TRUE};
-color bgColor = {10, 10, 10, TRUE};
+color lColor = {100, 255, 100};
+color bgColor = {10, 10, 10};
 
+//every side ends up as 4^MAX_I segments, the outline is collected and drawn with a single polyline() call
+vector2f outline[3 * 256 + 1];
+int outlineCount = 0;
 
 
 void kochLine(point start, point end, unsigned int i)
 {
 	if(i >= MAX_I)
-		line(start.x, start.y, end.x, end.y, lWidth, lColor); //graphTe function
+		outline[outlineCount++] = (vector2f){start.x, start.y};
 	else
 	{
 		point a = start;
@@ -43,14 +46,16 @@ int main()
 	setWindowTitle("Triangle fractal"); //graphTe function
 	setWindowSize(w, h); //graphTe function
 
-	update(); //graphTe function
-
 	point a = {500, 300}, b = {750, 700}, c = {250, 700};
 	fill(bgColor); //graphTe function
 
 	kochLine(a, b, 0);
 	kochLine(b, c, 0);
 	kochLine(c, a, 0);
+	outline[outlineCount++] = outline[0];
+
+	setAntialiasing(TRUE); //graphTe function
+	polyline(outline, outlineCount, lWidth, lColor); //graphTe function
 
 	display(); //graphTe function
 
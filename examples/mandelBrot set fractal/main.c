@@ -2,50 +2,51 @@
 
 int maxI = 100, INF = 10;
 
-int main()
+//the color of one point of the fractal, called by shade() from several threads at once
+color mandelbrot(uint16 x, uint16 y, void* userData)
 {
-	initHost();
-	setWindowTitle("Mandelbrot's Set");
-	setWindowSize(1000, 1000);
-	update();
-
 	double a1, a2, b1, b2, i, fx, fy;
 	color colorVal = rgb(0, 0, 0);
 
-	for(int x = 0; x < 1000; x++)
+	fx = map(x, 0, 1000, -2, 2);
+	fy = map(y, 0, 1000, -2, 2);
+
+	i = 0;
+
+	a1 = fx;
+	b1 = fy;
+
+	while(i++ < maxI)
 	{
-		for(int y = 0; y < 1000; y++)
-		{
-			fx = map(x, 0, 1000, -2, 2);
-			fy = map(y, 0, 1000, -2, 2);
+		a2 = a1 * a1 - b1 * b1;
+		b2 = 2 * a1 * b1;
 
-			i = 0;
+		a1 = a2 + fx;
+		b1 = b2 + fy;
 
-			a1 = fx;
-			b1 = fy;
+		if(abs(a1 + a2) > INF)
+			break;
+	}
 
-			while(i++ < maxI)
-			{
-				a2 = a1 * a1 - b1 * b1;
-				b2 = 2 * a1 * b1;
+	colorVal.red = map(i, 0, maxI, 0, 255);
+	colorVal.green = map(i, 0, maxI, 0, 255);
+	colorVal.blue = map(i, 80, maxI, 80, 255);
 
-				a1 = a2 + fx;
-				b1 = b2 + fy;
+	return colorVal;
+}
 
-				if(abs(a1 + a2) > INF)
-					break;
-			}
+int main()
+{
+	initHost();
+	setWindowTitle("Mandelbrot's Set");
+	setWindowSize(1000, 1000);
 
-			colorVal.red = map(i, 0, maxI, 0, 255);
-			colorVal.green = map(i, 0, maxI, 0, 255);
-			colorVal.blue = map(i, 80, maxI, 80, 255);
-			pixel(x, y, colorVal);
-		}
-	}
+	//every point is computed on its own, the rows are shared between all the processors
+	shade(0, 0, 1000, 1000, mandelbrot, NULL);
 
 	display();
 
 	forceInput();
 
 	releaseHost();
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -7,7 +7,7 @@
 //Used for the rand module
 #include <stdlib.h>
 
-//Used for gravity timing
+//Used for seeding the random pieces
 #include <time.h>
 
 //Used for updating the score and level texts
@@ -22,9 +22,6 @@ const uint16 squareSize = 32;
 //Time in milliseconds between a game moves. A game move counts as gravity + input
 float moveTime = 500;
 
-//Time in milliseconds that in required before a new user input
-const float moveCooldown = 50;
-
 //a simple array that will be intialized later with the rgb values for the pieces
 color colors[9];
 
@@ -46,9 +43,6 @@ struct
 }
 selectedTetrimino;
 
-//deltaTime stores the time in process clocks between each individual frame
-clock_t deltaTime = 0;
-
 //elapsed time stores the time in milliseconds that has passed since the last gravity drop
 float elapsedTime = 0;
 
@@ -116,8 +110,8 @@ void newTetrimino()
 }
 
 //this function is responsible for drawing everything to the screen
-//a frame call starts with this function effectively setting the framerate to the bufferTime of display()
-void render()
+//it is called by the game loop once per frame, the pieces move by whole squares so the interpolation factor is not used
+void render(double alpha)
 {
 	//background drawing:
 	fill(colors[0]);
@@ -150,15 +144,13 @@ void render()
 }
 
 //this function makes the selected piece drop down when the moveTime has passed
-void gravity()
+void gravity(double step)
 {
-	//calculation of the elapsed time variable:
-	deltaTime = clock() - deltaTime;
-	elapsedTime += (float)deltaTime / CLOCKS_PER_SEC;
-	deltaTime = clock();
+	//the game loop advances the game by fixed steps of milliseconds
+	elapsedTime += step;
 
 	//only if moveTime has passed the piece gets dropped down
-	if(elapsedTime * 1000 >= MAX(moveTime - level * additionalMoveTime, 50))
+	if(elapsedTime >= MAX(moveTime - level * additionalMoveTime, 50))
 	{
 		elapsedTime = 0;
 		selectedTetrimino.y++;
@@ -387,51 +379,54 @@ void checkTetris()
 	}
 }
 
-//this function checks for new user input and runs the coresponding code
+//this function takes the key presses since the last game step and runs the coresponding code
+//every press (and every auto-repeat of a held key) moves the piece once, so no press is lost between two steps
 void move()
 {
-	//move selected piece left
-	if(checkKeyLiveInput(VK_LEFT))
-	{
-		selectedTetrimino.x--;
-		if(collisionLeftRight())
-			selectedTetrimino.x++;
+	event keyEvent;
 
-		Sleep(moveCooldown);
-	}
-	//move selected piece right
-	else if(checkKeyLiveInput(VK_RIGHT))
+	while(pollEvent(&keyEvent))
 	{
-		selectedTetrimino.x++;
-		if(collisionLeftRight())
-			selectedTetrimino.x--;
+		if(keyEvent.type != EVENT_KEY_DOWN)
+			continue;
 
-		Sleep(moveCooldown);
-	}
-	//rotates selected piece clockwise
-	else if(checkKeyLiveInput(VK_UP))
-	{
-		selectedTetrimino.rotation++;
-		if(selectedTetrimino.rotation > 3)
-			selectedTetrimino.rotation = 0;
-
-		if(collisionLeftRight())
+		//move selected piece left
+		if(keyEvent.key == VK_LEFT)
 		{
-			if(selectedTetrimino.rotation == 0)
-			{
-				selectedTetrimino.rotation = 3;
-			}
-			else
+			selectedTetrimino.x--;
+			if(collisionLeftRight())
+				selectedTetrimino.x++;
+		}
+		//move selected piece right
+		else if(keyEvent.key == VK_RIGHT)
+		{
+			selectedTetrimino.x++;
+			if(collisionLeftRight())
+				selectedTetrimino.x--;
+		}
+		//rotates selected piece clockwise
+		else if(keyEvent.key == VK_UP)
+		{
+			selectedTetrimino.rotation++;
+			if(selectedTetrimino.rotation > 3)
+				selectedTetrimino.rotation = 0;
+
+			if(collisionLeftRight())
 			{
-				selectedTetrimino.rotation--;
+				if(selectedTetrimino.rotation == 0)
+				{
+					selectedTetrimino.rotation = 3;
+				}
+				else
+				{
+					selectedTetrimino.rotation--;
+				}
 			}
 		}
-
-		render();
-		Sleep(moveCooldown * 4);
 	}
-	//speeds up the game time (this game mechanic is called soft-drop)
-	else if(checkKeyLiveInput(VK_DOWN))
+
+	//speeds up the game time while the key is held (this game mechanic is called soft-drop)
+	if(checkKeyLiveInput(VK_DOWN))
 	{
 		moveTime = 50;
 	}
@@ -451,6 +446,19 @@ void checkEndgame()
 	}
 }
 
+//one fixed step of the game, called by the game loop
+void updateGame(double step)
+{
+	move();
+	gravity(step);
+	collision();
+	checkTetris();
+	checkEndgame();
+
+	if(!gameLoop)
+		stopGameLoop();
+}
+
 int main()
 {
 	//this is required to be at the start of each program that uses graphTe as it enables the graphical mode on the console
@@ -461,9 +469,6 @@ int main()
 	setWindowTitle("Tetris");
 	setWindowSize(600, 700);
 
-	//this function updates the canvas in memory to the new window resolution
-	update();
-
 	//start screen
 	image(0, 0, 600, 700, "assets/start.bmp");
 	display();
@@ -480,16 +485,8 @@ int main()
 	updateScore();
 	updateLevel();
 
-	//frameloop
-	while(gameLoop)
-	{
-		render();
-		move();
-		gravity();
-		collision();
-		checkTetris();
-		checkEndgame();
-	}
+	//frameloop: 60 game steps and 60 frames per second
+	runGameLoop(updateGame, render, 60, 60);
 
 	//endscreen
 	image(0, 0, 600, 700, "assets/endscreen.bmp");
@@ -17,13 +17,60 @@
 #ifndef _GRAPHTE_H_
 #define _GRAPHTE_H_
 
+////////////////////////////////////////////////////////////
+// Backend selection
+////////////////////////////////////////////////////////////
+//! GRAPHTE_BACKEND_GDI draws on the console window through winAPI GDI calls (default on Windows).
+//! GRAPHTE_BACKEND_FRAMEBUFFER draws into a CPU-owned 32-bit pixel array without any window (default everywhere else).
+//! GRAPHTE_BACKEND_TERMINAL draws into a CPU-owned pixel array and presents it on a POSIX terminal with 24-bit ANSI colors.
+//! Define one of them before including graphTe.h to select the backend at compile time.
+#if !defined(GRAPHTE_BACKEND_GDI) && !defined(GRAPHTE_BACKEND_FRAMEBUFFER) && !defined(GRAPHTE_BACKEND_TERMINAL)
+	#ifdef _WIN32
+		#define GRAPHTE_BACKEND_GDI
+	#else
+		#define GRAPHTE_BACKEND_FRAMEBUFFER
+	#endif
+#endif
+
+//! Every backend other than GDI rasterizes in software into the host pixel array.
+#ifndef GRAPHTE_BACKEND_GDI
+	#define GRAPHTE_SOFTWARE
+#endif
+
+#if defined(GRAPHTE_BACKEND_TERMINAL) && defined(_WIN32)
+	#error "The terminal backend requires a POSIX terminal."
+#endif
+
 ////////////////////////////////////////////////////////////
 // Headers
 ////////////////////////////////////////////////////////////
-#include <windows.h>
+#ifdef _WIN32
+	//! Condition variables require Windows Vista.
+	#ifndef _WIN32_WINNT
+		#define _WIN32_WINNT 0x0600
+	#endif
+	#include <windows.h>
+	#include <conio.h>
+#else
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <pthread.h>
+	#include <unistd.h>
+	#include <time.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+#ifdef GRAPHTE_BACKEND_TERMINAL
+	#include <poll.h>
+	#include <signal.h>
+	#include <termios.h>
+	#include <sys/ioctl.h>
+#endif
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <conio.h>
+#include <math.h>
 
 //! Constant for the maximum char* size.
 #define _CMAX 10000
@@ -34,6 +81,104 @@
 //! Macro for the declaration of a unsigned short int.
 #define uint16 unsigned short int
 
+//! Interval, in milliseconds, under which two presses of the same key received from a terminal count as the key being held down.
+#ifndef GRAPHTE_KEY_REPEAT
+	#define GRAPHTE_KEY_REPEAT 100
+#endif
+
+//! Default size of the pixel array used by the software backends before the first setWindowSize() call.
+#ifndef GRAPHTE_DEFAULT_WIDTH
+	#define GRAPHTE_DEFAULT_WIDTH 800
+#endif
+#ifndef GRAPHTE_DEFAULT_HEIGHT
+	#define GRAPHTE_DEFAULT_HEIGHT 600
+#endif
+
+//! Time, in milliseconds, a window resized by the user has to keep its size before the canvas follows it.
+#ifndef GRAPHTE_RESIZE_DEBOUNCE
+	#define GRAPHTE_RESIZE_DEBOUNCE 100
+#endif
+
+#ifndef _WIN32
+////////////////////////////////////////////////////////////
+// winAPI compatibility for non-Windows platforms
+////////////////////////////////////////////////////////////
+//! Boolean type and values used across the graphTe interface.
+typedef int BOOL;
+#define TRUE 1
+#define FALSE 0
+
+//! 16-bit unsigned type used for the virtual key codes.
+typedef unsigned short WORD;
+
+//! Structure containing the coords of a point, as returned by getMousePosition().
+typedef struct
+{
+	long x, y;
+}
+POINT;
+
+//! Virtual key codes matching the winAPI values, used by checkKeyLiveInput().
+#define VK_LBUTTON 0x01
+#define VK_RBUTTON 0x02
+#define VK_MBUTTON 0x04
+#define VK_BACK 0x08
+#define VK_TAB 0x09
+#define VK_RETURN 0x0D
+#define VK_ESCAPE 0x1B
+#define VK_SPACE 0x20
+#define VK_END 0x23
+#define VK_HOME 0x24
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that suspends the execution of the current thread.
+ * 
+ * \details This function mirrors the winAPI Sleep() function so programs written against graphTe keep their timing on other platforms.
+ * 
+ * \param[in]    milliseconds  The time interval for which execution is to be suspended, in milliseconds.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void Sleep(unsigned long milliseconds)
+{
+	struct timespec duration;
+	duration.tv_sec = milliseconds / 1000;
+	duration.tv_nsec = (milliseconds % 1000) * 1000000L;
+	nanosleep(&duration, NULL);
+}
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the time of a monotonic clock.
+ * 
+ * \details This function reads the performance counter on Windows and CLOCK_MONOTONIC elsewhere, neither is affected by changes of the system time.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  Returns the current time, in milliseconds.
+ */
+////////////////////////////////////////////////////////////
+double gtMilliseconds()
+{
+#ifdef _WIN32
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&frequency);
+	return now.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
 ////////////////////////////////////////////////////////////
 /**
  * \brief   A function that re-maps a value to another range.
@@ -60,16 +205,18 @@ long double map(long double x, long double inMin, long double inMax, long double
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   Structure containing a color broken down into its RGB components.
+ * \brief   Structure containing a color broken down into its RGB components and its transparency.
  * 
- * \details The structure contains 3 members of type uint16(in the following order), which are: red, green, blue.
+ * \details The structure contains 4 members of type uint16(in the following order), which are: red, green, blue, transparency.
  * 
  * \note    All functions from the graphTe wrapper exchange and store color data through the use of this rgb color type.
+ *          A transparency of 0 is opaque and 255 fully transparent, so colors written as {red, green, blue} stay opaque. Colors made with rgb() are opaque,
+ *          rgba() takes an alpha instead. See setBlendMode() for how translucent colors are drawn.
  */
 ////////////////////////////////////////////////////////////
 typedef struct
 {
-	uint16 red, green, blue;
+	uint16 red, green, blue, transparency;
 }
 color;
 
@@ -91,9 +238,57 @@ color;
 ////////////////////////////////////////////////////////////
 color rgb(uint16 red, uint16 green, uint16 blue)
 {
-	return (color){red, green, blue};
+	return (color){red, green, blue, 0};
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function creates a translucent color variable from the given RGBA parameters.
+ * 
+ * \details This function provides a red, green, blue color with an opacity.
+ * 
+ * \note    The intensity for each argument is in the range 0 through 255. An alpha of 255 is opaque, the same as rgb(), and 0 draws nothing.
+ *          The color stores 255 minus the alpha as its transparency.
+ * 
+ * \param[in]    red   The intensity of the red color.
+ * \param[in]    green The intensity of the green color.
+ * \param[in]    blue  The intensity of the blue color.
+ * \param[in]    alpha The opacity of the color.
+ * 
+ * \return       Returns the color from its 4 RGBA components as a graphTe color type.
+ */
+////////////////////////////////////////////////////////////
+color rgba(uint16 red, uint16 green, uint16 blue, uint16 alpha)
+{
+	return (color){red, green, blue, (uint16)(alpha > 255 ? 0 : 255 - alpha)};
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that converts a graphTe color into the format of the pixel buffers.
+ * 
+ * \details This function packs the color into a 32-bit 0x00RRGGBB value, the format of the buffers returned by lockPixels().
+ * 
+ * \note    Only the low byte of every component is kept, the same way the winAPI RGB() macro does. The alpha is not part of the value,
+ *          the pixels of the back buffer are always opaque.
+ * 
+ * \param[in]    fillColor  The color to be converted. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return       Returns the packed pixel value.
+ */
+////////////////////////////////////////////////////////////
+uint32_t pixelValue(color fillColor)
+{
+	return ((uint32_t)(fillColor.red & 0xFF) << 16) | ((uint32_t)(fillColor.green & 0xFF) << 8) | (uint32_t)(fillColor.blue & 0xFF);
 }
 
+#ifdef _WIN32
+//! A handle to a thread started by gtStartThread().
+typedef HANDLE gtThread;
+#else
+typedef pthread_t gtThread;
+#endif
+
 ////////////////////////////////////////////////////////////
 /**
  * \brief   Structure containing winAPI instances.
@@ -106,13 +301,54 @@ color rgb(uint16 red, uint16 green, uint16 blue)
 ////////////////////////////////////////////////////////////
 struct
 {
+#ifdef GRAPHTE_BACKEND_GDI
 	HWND hwnd; //! A handle to the console window.
 	HDC hdc, bufferDC, imageDC; //! Device context for the memory canvas and the image buffer.
 	HBITMAP bufferBitmap;//! A bitmap used for memory drawing (effectively enabling double-buffering frames).
 	RECT rect; //! A rectangle containing the window position and size.
-	uint16 width, height; //! The width and height of the host window.
+	HGDIOBJ selectedImage; //! The bitmap currently selected into imageDC.
+	HGDIOBJ defaultImage; //! The bitmap imageDC was created with, selected back before deleting a texture.
+#endif
+#ifdef _WIN32
 	HANDLE outputHandle; //! A handle to the standard console output.
-	HPEN linePen; //! The pen that is used to draw lines.
+#endif
+#ifdef GRAPHTE_BACKEND_GDI
+	HANDLE inputHandle; //! A handle to the standard console input.
+	DWORD savedInputMode; //! The console input mode before initHost().
+	volatile long readerRunning; //! Cleared by releaseHost() to end the input reader thread.
+#endif
+#if defined(GRAPHTE_BACKEND_GDI) || defined(GRAPHTE_BACKEND_TERMINAL)
+	gtThread reader; //! The thread turning console input into events, see pollEvent().
+	BOOL readerStarted; //! TRUE while the input reader thread runs.
+#endif
+	uint32_t* pixels; //! The back buffer every primitive draws into, one 0x00RRGGBB value per pixel (the bits of bufferBitmap on GDI).
+	uint16 stride; //! The distance, in pixels, between the starts of two consecutive rows of the back buffer.
+	uint16 capacityWidth, capacityHeight; //! The allocated size of the back buffer, the canvas uses its top left width x height pixels.
+	BOOL pixelsLocked; //! TRUE between lockPixels() and unlockPixels().
+#ifdef GRAPHTE_SOFTWARE
+	uint32_t* frontPixels; //! The buffer holding the last frame handed to display().
+	uint32_t* sparePixels; //! The third buffer while the present thread runs, see setPresentMode().
+	int16 x, y; //! The virtual position of the window.
+#endif
+#ifdef GRAPHTE_BACKEND_TERMINAL
+	uint16 columns, rows; //! The size of the terminal, in character cells.
+	uint16 layoutWidth, layoutHeight; //! The buffer size the cell sampling was computed for.
+	uint64_t* cells; //! The top (high half) and bottom (low half) colors currently shown by every cell.
+	int* sampleX; //! The buffer column sampled by every cell column, -1 for the letterbox.
+	int* sampleY; //! The buffer row sampled by every half cell row, -1 for the letterbox.
+	char* output; //! The escape sequences of the frame being presented.
+	size_t outputCapacity; //! The allocated size of the output buffer.
+	size_t frameBytes; //! The number of bytes written to the terminal for the last frame presented.
+	struct termios savedMode; //! The line discipline of the terminal before initHost().
+	BOOL terminalActive; //! TRUE while the terminal is in graphical mode.
+#endif
+#if defined(GRAPHTE_BACKEND_GDI) || defined(GRAPHTE_BACKEND_TERMINAL)
+	BOOL resizePending; //! TRUE while a size change made by the user waits for GRAPHTE_RESIZE_DEBOUNCE milliseconds without further changes.
+	uint16 pendingWidth, pendingHeight; //! The size the window had when the pending resize was last seen.
+	double resizeTime; //! The time, in milliseconds, the pending size was first seen.
+#endif
+	void (*resizeCallback)(uint16 width, uint16 height); //! The function called after the canvas follows a new window size, see setResizeCallback().
+	uint16 width, height; //! The width and height of the host window.
 	char title[_CMAX]; //! The title of the window.
 }
 host; //! An instance variable
@@ -166,439 +402,9195 @@ vector2u;
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that updates the rectangle of the window host.
+ * \brief   Structure containing the coords of a point with a fractional part.
+ * 
+ * \details The structure defines the x and y coordinates of a point inside the window area. Whole values are the centers of the pixels,
+ *          the same points that the integer coordinates of line() address.
+ * 
+ * \note    The main use for this data type is describing the paths drawn by polyline().
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	float x, y;
+}
+vector2f;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing the hit counters of a graphTe cache.
+ * 
+ * \details A hit is a request served from the cache, a miss is a request that had to create the cached object.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	unsigned long hits, misses;
+}
+cacheStats;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing the counters of the present thread, see setPresentMode().
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	unsigned long presented, dropped;
+}
+presentStats;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the groups of calls measured by the profiler, see getProfileFrame().
+ * 
+ * \details fill() and circle() count as PROFILE_RECT and PROFILE_ELLIPSE, the transparent variants count with the plain ones
+ *          and drawSprite() counts as PROFILE_SPRITES.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	PROFILE_DISPLAY = 0,
+	PROFILE_PIXEL = 1,
+	PROFILE_RECT = 2,
+	PROFILE_LINE = 3,
+	PROFILE_POLYLINE = 4,
+	PROFILE_ELLIPSE = 5,
+	PROFILE_TRIANGLE = 6,
+	PROFILE_SHADED_TRIANGLE = 7,
+	PROFILE_TEXTURE = 8,
+	PROFILE_IMAGE = 9,
+	PROFILE_SPRITES = 10,
+	PROFILE_TEXT = 11,
+	PROFILE_SHADE = 12,
+	PROFILE_COMMANDS = 13,
+	PROFILE_ZONES = 14
+}
+profileZone;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing what one group of calls cost during a frame.
  * 
- * \details This function retrieves a new rectangle with the position and size of the host and refreshes the instance width and height. 
+ * \details The time and the pixels of a call exclude the calls it makes itself, so the calls drawCommands() replays are counted in their own groups.
+ *          The pixels are the area of the clipped rectangles the calls damage, which can be larger than the pixels actually written.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	unsigned long calls;
+	uint64_t pixels;
+	uint64_t nanoseconds;
+}
+profileCounter;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing the profile of a frame, from the end of a display() call to the end of the next one.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	unsigned long number; //! The number of the frame, counted from 1.
+	uint64_t start; //! The time the frame started, in nanoseconds since the first measured call.
+	uint64_t nanoseconds; //! The duration of the frame.
+	profileCounter counters[PROFILE_ZONES];
+}
+profileFrame;
+
+#ifdef GRAPHTE_PROFILE
+////////////////////////////////////////////////////////////
+// Profiling
+////////////////////////////////////////////////////////////
+
+//! The number of frames kept by the profiler, see getProfileFrame().
+#ifndef GRAPHTE_PROFILE_FRAMES
+	#define GRAPHTE_PROFILE_FRAMES 120
+#endif
+
+//! The number of calls kept by the profiler for saveProfileTrace(), older calls are overwritten.
+#ifndef GRAPHTE_PROFILE_EVENTS
+	#define GRAPHTE_PROFILE_EVENTS 32768
+#endif
+
+//! The deepest nesting of measured calls, deeper calls are not measured.
+#define GRAPHTE_PROFILE_DEPTH 8
+
+//! Marks the start and the end of a measured call, both compile to nothing without GRAPHTE_PROFILE.
+#define GRAPHTE_PROFILE_BEGIN(zone) gtProfileBegin(zone)
+#define GRAPHTE_PROFILE_END() gtProfileEnd()
+
+//! A measured call, kept for the trace.
+typedef struct
+{
+	uint64_t start, nanoseconds, pixels;
+	unsigned long frame; //! The number of the frame the call belongs to.
+	uint8_t zone;
+}
+gtProfileEvent;
+
+//! A measured call that has not returned yet.
+typedef struct
+{
+	profileZone zone;
+	uint64_t start, pixels;
+	uint64_t childNanoseconds, childPixels; //! What the calls made by this one cost, excluded from its own counter.
+}
+gtProfileScope;
+
+//! The state of the profiler. Only the drawing thread is measured.
+struct
+{
+	BOOL started; //! TRUE once the clock origin has been read.
+	BOOL paused; //! TRUE while the profiler draws its own overlay.
+	uint64_t origin; //! The clock value of the first measured call.
+	uint64_t pixels; //! The area damaged since the start of the program, see gtAddDamage().
+	profileFrame current; //! The frame being measured.
+	profileFrame frames[GRAPHTE_PROFILE_FRAMES]; //! The last completed frames, frame n is at index n % GRAPHTE_PROFILE_FRAMES.
+	gtProfileEvent events[GRAPHTE_PROFILE_EVENTS]; //! The last measured calls, event n is at index n % GRAPHTE_PROFILE_EVENTS.
+	unsigned long long eventCount;
+	gtProfileScope stack[GRAPHTE_PROFILE_DEPTH];
+	int depth;
+}
+gtProfile;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads the monotonic clock of the profiler.
  * 
  * \param   This function does not have any parameters.
  * 
+ * \return  Returns the current time, in nanoseconds since the first measured call.
+ */
+////////////////////////////////////////////////////////////
+uint64_t gtProfileClock()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER now;
+	if(!frequency.QuadPart)
+		QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+	uint64_t time = (uint64_t)(now.QuadPart / frequency.QuadPart) * 1000000000 + (uint64_t)(now.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	uint64_t time = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+
+	if(!gtProfile.started)
+	{
+		gtProfile.started = TRUE;
+		gtProfile.origin = time;
+		gtProfile.current.number = 1;
+	}
+	return time - gtProfile.origin;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that starts measuring a call.
+ * 
+ * \param[in]    zone  The group the call is counted in.
+ * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void updateWindowBounds()
+void gtProfileBegin(profileZone zone)
 {
-	GetWindowRect(host.hwnd, &host.rect);
-	host.width = host.rect.right - host.rect.left;
-	host.height = host.rect.bottom - host.rect.top;
+	if(gtProfile.paused)
+		return;
+
+	if(gtProfile.depth < GRAPHTE_PROFILE_DEPTH)
+	{
+		gtProfileScope* scope = &gtProfile.stack[gtProfile.depth];
+		scope->zone = zone;
+		scope->pixels = gtProfile.pixels;
+		scope->childNanoseconds = scope->childPixels = 0;
+		scope->start = gtProfileClock();
+	}
+	gtProfile.depth++;
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that disables the flashing console cursor.
+ * \brief   A function that ends the measure of the innermost call.
  * 
- * \details This function resizes the console cursor and negates its visibility, which makes it stop flickering on frame rendering most of the time.
+ * \details The call is added to the counters of the frame and to the trace. The end of the outermost display() call also ends the frame,
+ *          which moves into the ring of completed frames.
  * 
  * \param   This function does not have any parameters.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void disableConsoleCursor()
+void gtProfileEnd()
 {
-	CONSOLE_CURSOR_INFO cInfo;
-	cInfo.dwSize = 100;
-    cInfo.bVisible = FALSE;
-	SetConsoleCursorInfo(host.outputHandle, &cInfo);
+	if(gtProfile.paused)
+		return;
+
+	uint64_t end = gtProfileClock();
+	if(--gtProfile.depth >= GRAPHTE_PROFILE_DEPTH)
+		return;
+
+	gtProfileScope* scope = &gtProfile.stack[gtProfile.depth];
+	uint64_t nanoseconds = end - scope->start, pixels = gtProfile.pixels - scope->pixels;
+
+	profileCounter* counter = &gtProfile.current.counters[scope->zone];
+	counter->calls++;
+	counter->nanoseconds += nanoseconds - scope->childNanoseconds;
+	counter->pixels += pixels - scope->childPixels;
+	if(gtProfile.depth)
+	{
+		gtProfile.stack[gtProfile.depth - 1].childNanoseconds += nanoseconds;
+		gtProfile.stack[gtProfile.depth - 1].childPixels += pixels;
+	}
+
+	gtProfileEvent* event = &gtProfile.events[gtProfile.eventCount++ % GRAPHTE_PROFILE_EVENTS];
+	*event = (gtProfileEvent){scope->start, nanoseconds, pixels, gtProfile.current.number, (uint8_t)scope->zone};
+
+	if(scope->zone == PROFILE_DISPLAY && !gtProfile.depth)
+	{
+		gtProfile.current.nanoseconds = end - gtProfile.current.start;
+		gtProfile.frames[gtProfile.current.number % GRAPHTE_PROFILE_FRAMES] = gtProfile.current;
+
+		unsigned long number = gtProfile.current.number + 1;
+		memset(&gtProfile.current, 0, sizeof(gtProfile.current));
+		gtProfile.current.number = number;
+		gtProfile.current.start = end;
+	}
+}
+#else
+#define GRAPHTE_PROFILE_BEGIN(zone) ((void)0)
+#define GRAPHTE_PROFILE_END() ((void)0)
+#endif
+
+////////////////////////////////////////////////////////////
+// Damage tracking
+////////////////////////////////////////////////////////////
+
+//! The maximum number of separate damaged rectangles kept for a frame. Further rectangles are merged into the closest one.
+#ifndef GRAPHTE_DAMAGE_RECTS
+	#define GRAPHTE_DAMAGE_RECTS 16
+#endif
+
+//! A rectangle of the back buffer, from (left, top) included to (right, bottom) excluded.
+typedef struct
+{
+	int left, top, right, bottom;
+}
+gtRect;
+
+//! The regions of the back buffer drawn since the last display() call.
+struct
+{
+	gtRect rects[GRAPHTE_DAMAGE_RECTS]; //! Disjoint (or at least not touching) damaged rectangles.
+	int count; //! The number of rectangles in use.
+	BOOL full; //! TRUE when the whole buffer is damaged, the rectangles are then ignored.
+	BOOL forceFull; //! TRUE to present the whole buffer on every display() call, see setFullPresent().
+#ifdef GRAPHTE_SOFTWARE
+	gtRect pending[2 * GRAPHTE_DAMAGE_RECTS]; //! The damage of the last displayed frame (and of the one before with the present thread), not yet copied into the new back buffer.
+	int pendingCount;
+	BOOL pendingFull;
+#endif
+}
+gtDamageList;
+
+#ifdef GRAPHTE_SOFTWARE
+//! A frame handed over by display() to be presented: its pixels and the regions drawn since the frame before.
+typedef struct
+{
+	uint32_t* pixels;
+	uint16 width, height, stride;
+	gtRect damage[GRAPHTE_DAMAGE_RECTS];
+	int damageCount;
+	BOOL full; //! TRUE to present every pixel, the damage is then ignored.
+	BOOL hold; //! TRUE while a resize of the terminal settles, nothing is written.
+	unsigned long number; //! The number of the frame, counted by display() from 1. 0 for a buffer whose content is unknown.
 }
+gtFrame;
+#endif
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that updates the memory bitmap canvas to the new window size.
+ * \brief   A function that brings the back buffer up to date with the last displayed frame.
  * 
- * \details This function retrieves the new window bounds and creates new bitmap buffers with the new size and position.
+ * \details After display() swaps the buffers, the new back buffer still holds the frame before the last one. It only differs from the displayed frame
+ *          in the regions damaged during that frame, so copying those regions from the front buffer is enough to make both buffers equal.
+ *          The copy is deferred until the first drawing call of the next frame, which skips it entirely when that call overwrites the whole buffer.
  * 
  * \param   This function does not have any parameters.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void update()
+void gtSyncBackBuffer()
 {
-	updateWindowBounds();
+#ifdef GRAPHTE_SOFTWARE
+	if(gtDamageList.pendingFull)
+	{
+		gtDamageList.pendingCount = 1;
+		gtDamageList.pending[0] = (gtRect){0, 0, host.width, host.height};
+	}
 
-	DeleteObject(host.bufferBitmap);
-	host.bufferBitmap = CreateCompatibleBitmap(host.hdc, host.width, host.height);
-	SelectObject(host.bufferDC, host.bufferBitmap);	
+	for(int i = 0; i < gtDamageList.pendingCount; i++)
+	{
+		gtRect* area = &gtDamageList.pending[i];
+		for(int y = area->top; y < area->bottom; y++)
+			memcpy(host.pixels + (size_t)y * host.stride + area->left, host.frontPixels + (size_t)y * host.stride + area->left, (area->right - area->left) * sizeof(uint32_t));
+	}
 
-	//! A console cursor disable is required after updating the window bounds.
-	disableConsoleCursor();
+	gtDamageList.pendingCount = 0;
+	gtDamageList.pendingFull = FALSE;
+#endif
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that intializes the window instance handles.
- * 
- * \details This function retrieves the window instance handles and stores then in the host variable, enabling the use of graphTe functions in the target program.
+ * \brief   A function that records a region of the back buffer as drawn.
  * 
- * \note   This function must be executed before the use of any library functions that involve graphics.
+ * \details This function clips the rectangle to the buffer and adds it to the damage list of the frame. Rectangles that overlap or touch are merged,
+ *          and once GRAPHTE_DAMAGE_RECTS rectangles are in use the new one is merged into the rectangle whose area grows the least.
+ *          It must be called before drawing, since it completes the deferred copy of gtSyncBackBuffer().
  * 
- * \param   This function does not have any parameters.
+ * \param[in]    left    The x-coordinate of the first damaged column.
+ * \param[in]    top     The y-coordinate of the first damaged row.
+ * \param[in]    right   The x-coordinate one past the last damaged column.
+ * \param[in]    bottom  The y-coordinate one past the last damaged row.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void initHost()
+void gtAddDamage(int left, int top, int right, int bottom)
 {
-	//!Sync the following window handles.
-	host.hwnd = GetConsoleWindow();
-	host.hdc = GetDC(host.hwnd);
-	host.bufferDC = CreateCompatibleDC(host.hdc);
-	host.imageDC = CreateCompatibleDC(host.bufferDC);
-	SelectObject(host.bufferDC, GetStockObject(DC_PEN));
-	SelectObject(host.bufferDC, GetStockObject(DC_BRUSH));
-	//! Standard output handle for the text attribute function
-	host.outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
-	//! Enabling transparent background mode for the transparentImage function.
-	SetBkMode(host.bufferDC, TRANSPARENT);
+#ifdef GRAPHTE_SOFTWARE
+	if(gtDamageList.pendingCount || gtDamageList.pendingFull)
+		gtSyncBackBuffer();
+#endif
 
-	//! A console cursor disable is required after synchronizing the window handles.
-	disableConsoleCursor();
+	if(left < 0) left = 0;
+	if(top < 0) top = 0;
+	if(right > host.width) right = host.width;
+	if(bottom > host.height) bottom = host.height;
+#ifdef GRAPHTE_PROFILE
+	if(left < right && top < bottom)
+		gtProfile.pixels += (uint64_t)(right - left) * (bottom - top);
+#endif
+	if(gtDamageList.full || left >= right || top >= bottom)
+		return;
 
-	update();
+	if(!left && !top && right == host.width && bottom == host.height)
+	{
+		gtDamageList.full = TRUE;
+		gtDamageList.count = 0;
+		return;
+	}
 
-	//! A thread stop of at least 100 ms is required after updating the window position and size.
-	Sleep(100);
-}	
+	gtRect area = {left, top, right, bottom};
+
+	//! Absorb every rectangle overlapping or touching the new one, the grown rectangle can then reach others.
+	for(int i = 0; i < gtDamageList.count;)
+	{
+		gtRect* other = &gtDamageList.rects[i];
+		if(other->left <= area.right && area.left <= other->right && other->top <= area.bottom && area.top <= other->bottom)
+		{
+			if(other->left < area.left) area.left = other->left;
+			if(other->top < area.top) area.top = other->top;
+			if(other->right > area.right) area.right = other->right;
+			if(other->bottom > area.bottom) area.bottom = other->bottom;
+
+			gtDamageList.rects[i] = gtDamageList.rects[--gtDamageList.count];
+			i = 0;
+		}
+		else
+			i++;
+	}
+
+	if(gtDamageList.count == GRAPHTE_DAMAGE_RECTS)
+	{
+		int best = 0;
+		long bestGrowth = -1;
+
+		for(int i = 0; i < gtDamageList.count; i++)
+		{
+			gtRect* other = &gtDamageList.rects[i];
+			long unionArea = (long)((other->right > area.right ? other->right : area.right) - (other->left < area.left ? other->left : area.left)) *
+			                 ((other->bottom > area.bottom ? other->bottom : area.bottom) - (other->top < area.top ? other->top : area.top));
+			long growth = unionArea - (long)(other->right - other->left) * (other->bottom - other->top);
+
+			if(bestGrowth < 0 || growth < bestGrowth)
+			{
+				best = i;
+				bestGrowth = growth;
+			}
+		}
+
+		gtRect* other = &gtDamageList.rects[best];
+		if(other->left < area.left) area.left = other->left;
+		if(other->top < area.top) area.top = other->top;
+		if(other->right > area.right) area.right = other->right;
+		if(other->bottom > area.bottom) area.bottom = other->bottom;
+		gtDamageList.rects[best] = gtDamageList.rects[--gtDamageList.count];
+	}
+
+	gtDamageList.rects[gtDamageList.count++] = area;
+}
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that releases the window handles and frees up residual memory.
- * 
- * \details This function deletes the host device context and releases teh window handle to be used by other programs.
+ * \brief   A function that records the whole back buffer as drawn.
  * 
- * \note   Any use of releaseHost() must be either at the end of the program or followed by a respective initHost().
+ * \details This function is used when the drawn region is unknown, for example once the pixels have been handed out by lockPixels().
  * 
  * \param   This function does not have any parameters.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void releaseHost()
+void gtDamageAll()
 {
-	//! Deletes the residual host buffer linked to the old handle.
-	DeleteObject(host.bufferBitmap);
-	DeleteDC(host.bufferDC);
-	DeleteObject(host.imageDC);
-
-	//! Realeases the main window handle and device context.
-	ReleaseDC(host.hwnd, host.hdc);
+	gtAddDamage(0, 0, host.width, host.height);
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that copies the buffer device context to the host, efectively drawing to screen.
+ * \brief   A function that controls the partial presentation of frames.
  * 
- * \details This function uses a bitmap copy to display the buffer device context(memory canvas) to the screen. Displays on screen what has been rendered to the window so far.
- *          This function is typically called after all winAPI rendering has been done for the current frame, in order to show it on screen.
+ * \details Every drawing function records the bounding box of what it draws, and display() only presents the union of those regions.
+ *          This function disables that optimization, making display() present the whole buffer every time.
  * 
- * \note   display() only updates the buffer to the memory canvas size, therefore resizing the image to the initial window size or the last call of update().
+ * \note    A full present can be needed when something else draws over the window, for example the console repainting its text on GDI.
  * 
- * \param   This function does not have any parameters.
+ * \param[in]   enabled  TRUE to always present the whole buffer, FALSE to only present the damaged regions (the default).
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void display()
+void setFullPresent(BOOL enabled)
+{
+	gtDamageList.forceFull = enabled;
+}
+
+////////////////////////////////////////////////////////////
+// Threads
+////////////////////////////////////////////////////////////
+
+//! Gives every thread its own copy of a global variable, used for the drawing state of the threads drawing tiles in parallel.
+#ifdef _MSC_VER
+	#define GRAPHTE_THREAD_LOCAL __declspec(thread)
+#else
+	#define GRAPHTE_THREAD_LOCAL __thread
+#endif
+
+//! The function and argument of a thread being started, handed over to gtThreadEntry().
+typedef struct
+{
+	void (*function)(void* argument);
+	void* argument;
+}
+gtThreadStart;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads a counter shared between threads.
+ * 
+ * \details The read has acquire semantics: everything the other thread wrote before storing the value is visible after reading it.
+ * 
+ * \param[in]    variable  The shared counter.
+ * 
+ * \return       Returns the value of the counter.
+ */
+////////////////////////////////////////////////////////////
+long gtAtomicLoad(volatile long* variable)
+{
+#ifdef _MSC_VER
+	return InterlockedCompareExchange(variable, 0, 0);
+#else
+	return __atomic_load_n(variable, __ATOMIC_ACQUIRE);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that writes a counter shared between threads.
+ * 
+ * \details The write has release semantics: everything written before it is visible to the thread that reads the new value.
+ * 
+ * \param[in]    variable  The shared counter.
+ * \param[in]    value     The new value of the counter.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtAtomicStore(volatile long* variable, long value)
+{
+#ifdef _MSC_VER
+	InterlockedExchange(variable, value);
+#else
+	__atomic_store_n(variable, value, __ATOMIC_RELEASE);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that runs the function of a new thread.
+ * 
+ * \details This function adapts the thread entry signature of the platform to gtStartThread() and frees the start block.
+ * 
+ * \param[in]    start  The gtThreadStart allocated by gtStartThread().
+ * 
+ * \return       Returns 0.
+ */
+////////////////////////////////////////////////////////////
+#ifdef _WIN32
+DWORD WINAPI gtThreadEntry(LPVOID start)
+#else
+void* gtThreadEntry(void* start)
+#endif
+{
+	gtThreadStart call = *(gtThreadStart*)start;
+	free(start);
+	call.function(call.argument);
+	return 0;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that starts a thread.
+ * 
+ * \param[out]   thread    The handle of the new thread, to be passed to gtJoinThread().
+ * \param[in]    function  The function run by the thread.
+ * \param[in]    argument  The value passed to the function.
+ * 
+ * \return       Returns TRUE if the thread was started and FALSE otherwise.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtStartThread(gtThread* thread, void (*function)(void* argument), void* argument)
+{
+	gtThreadStart* start = (gtThreadStart*)malloc(sizeof(gtThreadStart));
+	if(!start)
+		return FALSE;
+
+	start->function = function;
+	start->argument = argument;
+#ifdef _WIN32
+	*thread = CreateThread(NULL, 0, gtThreadEntry, start, 0, NULL);
+	if(*thread)
+		return TRUE;
+#else
+	if(!pthread_create(thread, NULL, gtThreadEntry, start))
+		return TRUE;
+#endif
+
+	free(start);
+	return FALSE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that waits for a thread to end.
+ * 
+ * \param[in]    thread  The handle returned by gtStartThread(), it is released by this call.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtJoinThread(gtThread thread)
+{
+#ifdef _WIN32
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that adds to a counter shared between threads.
+ * 
+ * \param[in]    variable  The shared counter.
+ * \param[in]    value     The value to be added.
+ * 
+ * \return       Returns the value of the counter after the addition.
+ */
+////////////////////////////////////////////////////////////
+long gtAtomicAdd(volatile long* variable, long value)
+{
+#ifdef _MSC_VER
+	return InterlockedExchangeAdd(variable, value) + value;
+#else
+	return __atomic_add_fetch(variable, value, __ATOMIC_ACQ_REL);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that replaces a 64-bit value shared between threads if it still holds the expected value.
+ * 
+ * \param[in]    variable  The shared value.
+ * \param[in]    expected  The value the variable must hold.
+ * \param[in]    value     The new value.
+ * 
+ * \return       Returns TRUE if the value was replaced and FALSE if another thread changed it first.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtAtomicSwap64(volatile long long* variable, long long expected, long long value)
+{
+#ifdef _MSC_VER
+	return InterlockedCompareExchange64(variable, value, expected) == expected;
+#else
+	return __atomic_compare_exchange_n(variable, &expected, value, FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads a 64-bit value shared between threads.
+ * 
+ * \param[in]    variable  The shared value.
+ * 
+ * \return       Returns the value.
+ */
+////////////////////////////////////////////////////////////
+long long gtAtomicLoad64(volatile long long* variable)
+{
+#ifdef _MSC_VER
+	return InterlockedCompareExchange64(variable, 0, 0);
+#else
+	return __atomic_load_n(variable, __ATOMIC_ACQUIRE);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the number of processors the program can run on.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return       Returns the number of logical processors, at least 1.
+ */
+////////////////////////////////////////////////////////////
+int gtProcessorCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO system;
+	GetSystemInfo(&system);
+	return system.dwNumberOfProcessors ? (int)system.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#endif
+}
+
+//! A lock with a condition threads can wait on, the state it protects is only read and written while holding the lock.
+typedef struct
+{
+#ifdef _WIN32
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE changed;
+#else
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+#endif
+}
+gtMonitor;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Functions that create, destroy, lock and unlock a monitor.
+ * 
+ * \param[in]    monitor  The monitor.
+ * 
+ * \return  These functions do not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtMonitorInit(gtMonitor* monitor)
+{
+#ifdef _WIN32
+	InitializeCriticalSection(&monitor->lock);
+	InitializeConditionVariable(&monitor->changed);
+#else
+	pthread_mutex_init(&monitor->lock, NULL);
+	pthread_cond_init(&monitor->changed, NULL);
+#endif
+}
+void gtMonitorDestroy(gtMonitor* monitor)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(&monitor->lock);
+#else
+	pthread_mutex_destroy(&monitor->lock);
+	pthread_cond_destroy(&monitor->changed);
+#endif
+}
+void gtMonitorEnter(gtMonitor* monitor)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&monitor->lock);
+#else
+	pthread_mutex_lock(&monitor->lock);
+#endif
+}
+void gtMonitorLeave(gtMonitor* monitor)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&monitor->lock);
+#else
+	pthread_mutex_unlock(&monitor->lock);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that waits for another thread to change the state protected by a monitor.
+ * 
+ * \details The lock must be held, it is released during the wait and held again when this function returns.
+ *          The wait can end without a change, the state has to be checked again in a loop. gtMonitorWakeAll() ends the wait of every thread.
+ * 
+ * \param[in]    monitor  The monitor.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtMonitorWait(gtMonitor* monitor)
+{
+#ifdef _WIN32
+	SleepConditionVariableCS(&monitor->changed, &monitor->lock, INFINITE);
+#else
+	pthread_cond_wait(&monitor->changed, &monitor->lock);
+#endif
+}
+void gtMonitorWakeAll(gtMonitor* monitor)
+{
+#ifdef _WIN32
+	WakeAllConditionVariable(&monitor->changed);
+#else
+	pthread_cond_broadcast(&monitor->changed);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// Events
+////////////////////////////////////////////////////////////
+
+//! The number of events each event queue holds, a power of two.
+#ifndef GRAPHTE_EVENT_QUEUE_SIZE
+	#define GRAPHTE_EVENT_QUEUE_SIZE 256
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the kinds of input events.
+ * 
+ * \details Key events carry a virtual key code, mouse events the position of the mouse on the canvas, resize events the new size.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	EVENT_NONE = 0,
+	EVENT_KEY_DOWN = 1,
+	EVENT_KEY_UP = 2,
+	EVENT_MOUSE_MOVE = 3,
+	EVENT_MOUSE_DOWN = 4,
+	EVENT_MOUSE_UP = 5,
+	EVENT_MOUSE_WHEEL = 6,
+	EVENT_RESIZE = 7
+}
+eventType;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing an input event.
+ * 
+ * \details The time is taken when the event is read from the system, on the clock of getTime(), so the order and spacing of the inputs
+ *          are kept no matter how late the frame loop gets to them.
+ * 
+ * \note    Terminals only report key presses: the terminal backend never sends EVENT_KEY_UP, and every auto-repeat of a held key is an EVENT_KEY_DOWN.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	eventType type;
+	double time; //! The time of the event, in milliseconds.
+	WORD key; //! The virtual key code for key events, VK_LBUTTON, VK_RBUTTON or VK_MBUTTON for mouse buttons.
+	char character; //! The character typed by an EVENT_KEY_DOWN, 0 for keys without one.
+	int16 x, y; //! The mouse position on the canvas for mouse events, the new width and height for EVENT_RESIZE.
+	int16 wheel; //! The number of wheel steps of an EVENT_MOUSE_WHEEL, positive away from the user.
+}
+event;
+
+//! A single-producer single-consumer queue of events. Each index is written by one side only, the counters only grow.
+typedef struct
+{
+	event events[GRAPHTE_EVENT_QUEUE_SIZE];
+	volatile long head; //! The number of events taken out, written by the consumer.
+	volatile long tail; //! The number of events put in, written by the producer.
+}
+gtEventQueue;
+
+//! The event queues and the input state built from the events.
+struct
+{
+	gtEventQueue incoming; //! Filled by the input reader thread, emptied by the main thread.
+	gtEventQueue pending; //! The events waiting for pollEvent(), only used by the main thread.
+	volatile long dropped; //! The number of events lost because the incoming queue was full, written by the reader thread.
+	BOOL keyDown[256]; //! TRUE for keys and mouse buttons reported down and not yet up.
+	BOOL keyPending[256]; //! TRUE for keys pressed since the last checkKeyLiveInput() call for them.
+#ifdef GRAPHTE_BACKEND_TERMINAL
+	double keyTime[256], keyPrevious[256]; //! The times, in milliseconds, of the last two presses of every key.
+#endif
+	char characters[64]; //! Characters waiting to be returned by input().
+	uint16 characterHead, characterTail; //! The read and write positions of the character queue.
+	POINT mouse; //! The last mouse position on the canvas.
+}
+gtEvents;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that puts an event into the incoming queue.
+ * 
+ * \details This function is only called by the input reader thread. When the queue is full the event is dropped and counted.
+ * 
+ * \param[in]    item  The event.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtQueueEvent(event item)
+{
+	long tail = gtEvents.incoming.tail;
+
+	if(tail - gtAtomicLoad(&gtEvents.incoming.head) == GRAPHTE_EVENT_QUEUE_SIZE)
+	{
+		gtAtomicStore(&gtEvents.dropped, gtEvents.dropped + 1);
+		return;
+	}
+
+	gtEvents.incoming.events[tail & (GRAPHTE_EVENT_QUEUE_SIZE - 1)] = item;
+	gtAtomicStore(&gtEvents.incoming.tail, tail + 1);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that applies an event to the input state and keeps it for pollEvent().
+ * 
+ * \details This function runs on the main thread. It tracks the held keys, the typed characters and the mouse position read by input(),
+ *          checkKeyLiveInput() and getMousePosition(), then appends the event to the pending queue, dropping the oldest one if it is full.
+ * 
+ * \param[in]    item  The event.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtAcceptEvent(event item)
+{
+	switch(item.type)
+	{
+		case EVENT_KEY_DOWN:
+		case EVENT_MOUSE_DOWN:
+			if(item.key < 256)
+			{
+#ifdef GRAPHTE_BACKEND_TERMINAL
+				//! Without key releases, a key counts as held while its auto-repeat keeps arriving, see checkKeyLiveInput().
+				if(item.type == EVENT_KEY_DOWN)
+				{
+					gtEvents.keyPrevious[item.key] = gtEvents.keyTime[item.key];
+					gtEvents.keyTime[item.key] = item.time;
+				}
+				else
+#endif
+				gtEvents.keyDown[item.key] = TRUE;
+				gtEvents.keyPending[item.key] = TRUE;
+			}
+			if(item.type == EVENT_KEY_DOWN && item.character && (gtEvents.characterTail + 1) % sizeof(gtEvents.characters) != gtEvents.characterHead)
+			{
+				gtEvents.characters[gtEvents.characterTail] = item.character;
+				gtEvents.characterTail = (gtEvents.characterTail + 1) % sizeof(gtEvents.characters);
+			}
+			break;
+		case EVENT_KEY_UP:
+		case EVENT_MOUSE_UP:
+			if(item.key < 256)
+				gtEvents.keyDown[item.key] = FALSE;
+			break;
+		default:
+			break;
+	}
+
+	if(item.type >= EVENT_MOUSE_MOVE && item.type <= EVENT_MOUSE_WHEEL)
+	{
+		gtEvents.mouse.x = item.x;
+		gtEvents.mouse.y = item.y;
+	}
+
+	if(gtEvents.pending.tail - gtEvents.pending.head == GRAPHTE_EVENT_QUEUE_SIZE)
+		gtEvents.pending.head++;
+	gtEvents.pending.events[gtEvents.pending.tail & (GRAPHTE_EVENT_QUEUE_SIZE - 1)] = item;
+	gtEvents.pending.tail++;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that takes the events read by the input reader thread.
+ * 
+ * \details This function moves every event of the incoming queue through gtAcceptEvent(). It is cheap when nothing happened: a single
+ *          comparison of the two counters. This is where terminal mouse positions are converted, the cell sampling only changes on the main thread.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtFetchEvents()
+{
+	long head = gtEvents.incoming.head, tail = gtAtomicLoad(&gtEvents.incoming.tail);
+
+	while(head != tail)
+	{
+		event item = gtEvents.incoming.events[head & (GRAPHTE_EVENT_QUEUE_SIZE - 1)];
+		gtAtomicStore(&gtEvents.incoming.head, ++head);
+
+#ifdef GRAPHTE_BACKEND_TERMINAL
+		//! The terminal reports mouse positions in cells, they are converted to canvas pixels with -1 outside of the picture.
+		if(item.type >= EVENT_MOUSE_MOVE && item.type <= EVENT_MOUSE_WHEEL)
+		{
+			item.x = host.sampleX && item.x >= 0 && item.x < host.columns ? host.sampleX[item.x] : -1;
+			item.y = host.sampleY && item.y >= 0 && item.y < host.rows ? host.sampleY[item.y * 2] : -1;
+		}
+#endif
+		gtAcceptEvent(item);
+	}
+}
+
+////////////////////////////////////////////////////////////
+// Back buffer management
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the ways display() hands frames over to the screen.
+ * 
+ * \details PRESENT_SYNC presents the frame before display() returns. With PRESENT_DROP and PRESENT_QUEUE a present thread writes the frames
+ *          while the program draws the next one: PRESENT_DROP replaces a frame the thread has not started presenting yet with the newer one,
+ *          so display() never waits, PRESENT_QUEUE waits for the thread to take the previous frame, so every frame is presented.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	PRESENT_SYNC = 0,
+	PRESENT_DROP = 1,
+	PRESENT_QUEUE = 2
+}
+presentMode;
+
+//! Set in the present slot while it holds a frame the present thread has not taken yet. The low bits hold the index of the buffer.
+#define GRAPHTE_PRESENT_FRESH 4
+
+#ifdef GRAPHTE_SOFTWARE
+//! The present thread and the three buffers it rotates with the drawing thread: one drawn into, one in the slot, one presented.
+struct
+{
+	presentMode mode;
+	gtMonitor monitor; //! Lets the threads wait for each other, the frames themselves are handed over through the slot.
+	BOOL ready; //! TRUE once the monitor has been initialized.
+	BOOL running; //! TRUE while the present thread runs.
+	BOOL quit; //! Set to end the present thread.
+	BOOL busy; //! TRUE while the present thread writes a frame.
+	gtThread thread;
+	gtFrame frames[3]; //! The buffers and the frame each one holds. A frame is only written by the thread owning its buffer.
+	volatile long long slot; //! The buffer exchanged between display() and the present thread, with GRAPHTE_PRESENT_FRESH until the thread takes it.
+	int draw; //! The buffer host.pixels points to, owned by the drawing thread.
+	int latest; //! The buffer of the last frame handed over, host.frontPixels points to it.
+	int shown; //! The buffer the present thread presents, owned by the present thread.
+	unsigned long number; //! The number of the last frame handed over.
+	unsigned long shownNumber; //! The number of the frame presented last.
+	gtRect history[GRAPHTE_DAMAGE_RECTS]; //! The damage of the frame before the last one, copied into a back buffer two frames old.
+	int historyCount;
+	BOOL historyFull;
+	unsigned long dropped; //! The number of frames replaced before being presented.
+	volatile long presented; //! The number of frames presented by the present thread.
+}
+gtPresent;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that waits until the present thread is idle.
+ * 
+ * \details Once it returns, the present thread has presented the last frame and does not read any buffer until the next display() call,
+ *          so the buffers and the terminal layout can be changed.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtWaitPresenter()
+{
+	if(!gtPresent.running)
+		return;
+
+	gtMonitorEnter(&gtPresent.monitor);
+	while((gtAtomicLoad64(&gtPresent.slot) & GRAPHTE_PRESENT_FRESH) || gtPresent.busy)
+		gtMonitorWait(&gtPresent.monitor);
+	gtMonitorLeave(&gtPresent.monitor);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the stream formats written by startCapture().
+ * 
+ * \details CAPTURE_Y4M writes a YUV4MPEG2 stream of full range 4:2:0 frames (C420jpeg), which video players and encoders read directly.
+ *          CAPTURE_RAW writes every frame exactly as it is stored in memory, like saveFrame() with FRAME_RAW: rows of 32-bit 0x00RRGGBB
+ *          little-endian values without any header, the "bgr0" pixel format of most encoders.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	CAPTURE_Y4M = 0,
+	CAPTURE_RAW = 1
+}
+captureFormat;
+
+//! The capture thread and the frame display() hands over to it.
+struct
+{
+	captureFormat format;
+	gtMonitor monitor; //! Protects fresh and quit.
+	BOOL ready; //! TRUE once the monitor has been initialized.
+	BOOL running; //! TRUE while the capture thread runs.
+	BOOL quit; //! Set to end the capture thread.
+	BOOL fresh; //! TRUE from the hand-over of a frame until the capture thread has written it.
+	BOOL failed; //! TRUE once a write has failed.
+	gtThread thread;
+	FILE* file;
+	BOOL pipe; //! TRUE when the file is a pipe to a command.
+	uint16 width, height; //! The size of the stream, set when the capture starts. Frames of another size are cropped or padded with black.
+	const uint32_t* pixels; //! The front buffer handed over, only read by the capture thread.
+	uint16 frameWidth, frameHeight, frameStride;
+	unsigned char* planes; //! The Y, U and V planes of a converted frame.
+	uint32_t* blackRow; //! A black row of the stream width, written where the frame does not cover the stream.
+	unsigned long frames; //! The number of frames written.
+}
+gtCapture;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that waits until the capture thread has written the last frame handed over.
+ * 
+ * \details The capture thread reads the front buffer, so the buffers are not swapped, re-allocated or drawn into before it is done with it.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtWaitCapture()
+{
+	if(!gtCapture.running)
+		return;
+
+	gtMonitorEnter(&gtCapture.monitor);
+	while(gtCapture.fresh)
+		gtMonitorWait(&gtCapture.monitor);
+	gtMonitorLeave(&gtCapture.monitor);
+}
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that clears a rectangle of a canvas buffer to black.
+ * 
+ * \param[in]    buffer  The buffer to be cleared, laid out with the host stride.
+ * \param[in]    left    The x-coordinate of the first column.
+ * \param[in]    top     The y-coordinate of the first row.
+ * \param[in]    right   The x-coordinate one past the last column.
+ * \param[in]    bottom  The y-coordinate one past the last row.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtClearArea(uint32_t* buffer, int left, int top, int right, int bottom)
+{
+	if(left >= right)
+		return;
+
+	for(int y = top; y < bottom; y++)
+		memset(buffer + (size_t)y * host.stride + left, 0, (right - left) * sizeof(uint32_t));
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that resizes the canvas.
+ * 
+ * \details The buffers are allocated with a capacity that can be larger than the canvas, and host.stride is the allocated width.
+ *          A new size that fits into the capacity only changes host.width and host.height, nothing is re-allocated. Otherwise the capacity grows
+ *          by at least half of its current value, so a window enlarged step by step re-allocates a few times instead of on every step.
+ *          The content of the canvas is kept where the old and new sizes overlap, the newly uncovered area is black.
+ *          On GDI the buffer is a top-down 32-bit DIB section selected into bufferDC, on the software backends it is the back and front pixel arrays,
+ *          plus the third buffer of the present thread when it runs. The present and capture threads are left to finish their frame first.
+ * 
+ * \note    The resize callback is called when the size changes, after the canvas is ready to be drawn on.
+ * 
+ * \param[in]    width   The new width of the canvas.
+ * \param[in]    height  The new height of the canvas.
+ * 
+ * \return       Returns TRUE if the canvas size changed and FALSE if it already had the requested size or the allocation failed.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtResizeBuffers(uint16 width, uint16 height)
+{
+	if(host.pixels && width == host.width && height == host.height)
+		return FALSE;
+
+#ifdef GRAPHTE_SOFTWARE
+	gtWaitPresenter();
+	gtWaitCapture();
+	//! Both buffers have to hold the displayed frame before it is carried over.
+	gtSyncBackBuffer();
+#else
+	GdiFlush();
+#endif
+
+	int keptWidth = host.pixels ? (width < host.width ? width : host.width) : 0;
+	int keptHeight = host.pixels ? (height < host.height ? height : host.height) : 0;
+
+	if(!host.pixels || width > host.capacityWidth || height > host.capacityHeight)
+	{
+		//! The stride is a uint16, which caps the capacity growth of the width.
+		unsigned long capacityWidth = host.pixels ? host.capacityWidth + host.capacityWidth / 2 : 0;
+		unsigned long capacityHeight = host.pixels ? host.capacityHeight + host.capacityHeight / 2 : 0;
+		if(capacityWidth < width) capacityWidth = width;
+		if(capacityWidth > 0xFFFF) capacityWidth = 0xFFFF;
+		if(capacityHeight < height) capacityHeight = height;
+		if(!capacityWidth || !capacityHeight)
+			capacityWidth = capacityHeight = 1;
+
+#ifdef GRAPHTE_BACKEND_GDI
+		BITMAPINFO info;
+		memset(&info, 0, sizeof(info));
+		info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		info.bmiHeader.biWidth = capacityWidth;
+		info.bmiHeader.biHeight = -(LONG)capacityHeight;
+		info.bmiHeader.biPlanes = 1;
+		info.bmiHeader.biBitCount = 32;
+		info.bmiHeader.biCompression = BI_RGB;
+
+		uint32_t* pixels = NULL;
+		HBITMAP bitmap = CreateDIBSection(host.hdc, &info, DIB_RGB_COLORS, (void**)&pixels, NULL, 0);
+		if(!bitmap)
+			return FALSE;
+
+		for(int y = 0; y < keptHeight; y++)
+			memcpy(pixels + (size_t)y * capacityWidth, host.pixels + (size_t)y * host.stride, keptWidth * sizeof(uint32_t));
+
+		SelectObject(host.bufferDC, bitmap);
+		DeleteObject(host.bufferBitmap);
+		host.bufferBitmap = bitmap;
+		host.pixels = pixels;
+#else
+		uint32_t* pixels = (uint32_t*)calloc(capacityWidth * capacityHeight, sizeof(uint32_t));
+		uint32_t* frontPixels = (uint32_t*)calloc(capacityWidth * capacityHeight, sizeof(uint32_t));
+		uint32_t* sparePixels = host.sparePixels ? (uint32_t*)calloc(capacityWidth * capacityHeight, sizeof(uint32_t)) : NULL;
+		if(!pixels || !frontPixels || (host.sparePixels && !sparePixels))
+		{
+			free(pixels);
+			free(frontPixels);
+			free(sparePixels);
+			return FALSE;
+		}
+
+		for(int y = 0; y < keptHeight; y++)
+		{
+			memcpy(pixels + (size_t)y * capacityWidth, host.pixels + (size_t)y * host.stride, keptWidth * sizeof(uint32_t));
+			memcpy(frontPixels + (size_t)y * capacityWidth, host.pixels + (size_t)y * host.stride, keptWidth * sizeof(uint32_t));
+		}
+
+		free(host.pixels);
+		free(host.frontPixels);
+		free(host.sparePixels);
+		host.pixels = pixels;
+		host.frontPixels = frontPixels;
+		host.sparePixels = sparePixels;
+#endif
+		host.stride = capacityWidth;
+		host.capacityWidth = capacityWidth;
+		host.capacityHeight = capacityHeight;
+	}
+	else
+	{
+		//! Everything outside the canvas is kept black, so the area a later size change uncovers is already cleared.
+		gtClearArea(host.pixels, width, 0, host.width, keptHeight);
+		gtClearArea(host.pixels, 0, height, host.width, host.height);
+#ifdef GRAPHTE_SOFTWARE
+		gtClearArea(host.frontPixels, width, 0, host.width, keptHeight);
+		gtClearArea(host.frontPixels, 0, height, host.width, host.height);
+		if(host.sparePixels)
+		{
+			gtClearArea(host.sparePixels, width, 0, host.width, keptHeight);
+			gtClearArea(host.sparePixels, 0, height, host.width, host.height);
+		}
+#endif
+	}
+
+	host.width = width;
+	host.height = height;
+
+#ifdef GRAPHTE_BACKEND_GDI
+	//! GDI draws into the whole bitmap, it is clipped to the canvas so the area outside stays black.
+	HRGN clip = CreateRectRgn(0, 0, width, height);
+	SelectClipRgn(host.bufferDC, clip);
+	DeleteObject(clip);
+#endif
+
+	//! Both buffers hold the same content, nothing is left to copy and the next frame is presented in full.
+#ifdef GRAPHTE_SOFTWARE
+	gtDamageList.pendingCount = gtDamageList.pendingFull = 0;
+	if(gtPresent.running)
+	{
+		//! The idle present thread holds the latest frame, the slot holds the third buffer, whose content is unknown.
+		int spare = 3 - gtPresent.draw - gtPresent.latest;
+		gtPresent.frames[gtPresent.draw].pixels = host.pixels;
+		gtPresent.frames[gtPresent.latest].pixels = host.frontPixels;
+		gtPresent.frames[spare].pixels = host.sparePixels;
+		gtPresent.frames[gtPresent.draw].number = gtPresent.frames[gtPresent.latest].number = gtPresent.number;
+		gtPresent.frames[spare].number = 0;
+	}
+#endif
+	gtDamageList.count = 0;
+	gtDamageList.full = TRUE;
+
+	//! The event carries the new canvas size, in pixels.
+	event item;
+	memset(&item, 0, sizeof(item));
+	item.type = EVENT_RESIZE;
+	item.time = gtMilliseconds();
+	item.x = width;
+	item.y = height;
+	gtFetchEvents();
+	gtAcceptEvent(item);
+
+	if(host.resizeCallback)
+		host.resizeCallback(width, height);
+
+	return TRUE;
+}
+
+#ifdef GRAPHTE_BACKEND_GDI
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that makes the canvas follow the size of the console window.
+ * 
+ * \details This function is called by display(). A new window size is only applied once it has stayed the same for GRAPHTE_RESIZE_DEBOUNCE milliseconds,
+ *          so dragging the window border resizes the canvas once at the end instead of on every frame of the drag.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return       Returns TRUE if the canvas has been resized.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtFollowWindowSize()
+{
+	GetWindowRect(host.hwnd, &host.rect);
+	uint16 width = host.rect.right - host.rect.left, height = host.rect.bottom - host.rect.top;
+
+	if(width == host.width && height == host.height)
+	{
+		host.resizePending = FALSE;
+		return FALSE;
+	}
+
+	double now = gtMilliseconds();
+	if(!host.resizePending || width != host.pendingWidth || height != host.pendingHeight)
+	{
+		host.resizePending = TRUE;
+		host.pendingWidth = width;
+		host.pendingHeight = height;
+		host.resizeTime = now;
+		return FALSE;
+	}
+
+	if(now - host.resizeTime < GRAPHTE_RESIZE_DEBOUNCE)
+		return FALSE;
+
+	host.resizePending = FALSE;
+	return gtResizeBuffers(width, height);
+}
+#endif
+
+////////////////////////////////////////////////////////////
+// Pixel row kernels
+////////////////////////////////////////////////////////////
+
+//! The SIMD kernels are only built for x86 compilers that accept per-function target attributes (or MSVC), define GRAPHTE_NO_SIMD to leave them out.
+#if !defined(GRAPHTE_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && (defined(__GNUC__) || defined(_MSC_VER))
+	#define GRAPHTE_SIMD
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define GRAPHTE_TARGET(features)
+	#else
+		#include <cpuid.h>
+		#define GRAPHTE_TARGET(features) __attribute__((target(features)))
+	#endif
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the instruction sets the pixel row kernels are written for.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	KERNELS_SCALAR = 0,
+	KERNELS_SSE2 = 1,
+	KERNELS_AVX2 = 2,
+	KERNELS_AVX512 = 3
+}
+kernelLevel;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the ways a color is combined with the pixels it is drawn over.
+ * 
+ * \details BLEND_ALPHA draws the color over the canvas by its opacity (source-over), BLEND_ADD adds the color weighted by its opacity,
+ *          which brightens, and BLEND_MULTIPLY multiplies the canvas by the color, which darkens.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	BLEND_ALPHA = 0,
+	BLEND_ADD = 1,
+	BLEND_MULTIPLY = 2
+}
+blendMode;
+
+//! The blend state applied by every drawing function, see setBlendMode() and setOpacity(). The threads drawing tiles set their own for every command.
+GRAPHTE_THREAD_LOCAL struct
+{
+	blendMode mode;
+	uint16 opacity; //! Multiplies the alpha of every color and image drawn, 255 leaves it unchanged.
+}
+gtBlend = {BLEND_ALPHA, 255};
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that divides a product of two 8-bit values by 255, rounding to the nearest.
+ * 
+ * \param[in]    value  The product, at most 255 * 255.
+ * 
+ * \return       Returns the rounded quotient.
+ */
+////////////////////////////////////////////////////////////
+uint32_t gtDiv255(uint32_t value)
+{
+	value += 128;
+	return (value + (value >> 8)) >> 8;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that converts a color to the premultiplied value drawn with the current opacity.
+ * 
+ * \details Translucent pixels are packed as 0xTTRRGGBB, where the color components are already multiplied by the alpha and TT is the transparency,
+ *          255 minus the alpha. An opaque pixel therefore has the same value as pixelValue() gives it, and the back buffer only holds opaque pixels.
+ * 
+ * \param[in]    fillColor  The color to be converted.
+ * 
+ * \return       Returns the premultiplied pixel value.
+ */
+////////////////////////////////////////////////////////////
+uint32_t gtPaint(color fillColor)
+{
+	uint32_t alpha = gtDiv255((fillColor.transparency > 255 ? 0 : 255 - fillColor.transparency) * gtBlend.opacity);
+
+	return (255 - alpha) << 24 | gtDiv255((fillColor.red & 0xFF) * alpha) << 16 | gtDiv255((fillColor.green & 0xFF) * alpha) << 8 | gtDiv255((fillColor.blue & 0xFF) * alpha);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that tells whether a premultiplied value can be written over the canvas without blending.
+ * 
+ * \param[in]    paint  The premultiplied value, see gtPaint().
+ * 
+ * \return       Returns TRUE if the value is opaque and the blend mode is BLEND_ALPHA.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtOpaque(uint32_t paint)
+{
+	return !(paint >> 24) && gtBlend.mode == BLEND_ALPHA;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The scalar pixel row kernels, used when no SIMD instruction set is available.
+ * 
+ * \details The keyed copy compares the color bits only, the same way TransparentBlt() treats its transparent color.
+ */
+////////////////////////////////////////////////////////////
+void gtFillRowScalar(uint32_t* destination, size_t count, uint32_t value)
+{
+	for(size_t i = 0; i < count; i++)
+		destination[i] = value;
+}
+void gtCopyRowScalar(uint32_t* destination, const uint32_t* source, size_t count)
+{
+	memmove(destination, source, count * sizeof(uint32_t));
+}
+void gtKeyRowScalar(uint32_t* destination, const uint32_t* source, size_t count, uint32_t key)
+{
+	for(size_t i = 0; i < count; i++)
+		if((source[i] & 0xFFFFFF) != key)
+			destination[i] = source[i];
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that blends a premultiplied pixel over an opaque one.
+ * 
+ * \details Every color component becomes add + destination * factor / 255, with the add and the factor of the blend mode:
+ *          the source and its transparency for BLEND_ALPHA, the source and 255 for BLEND_ADD, 0 and the source plus its transparency for BLEND_MULTIPLY.
+ * 
+ * \param[in]    destination  The opaque pixel drawn over.
+ * \param[in]    source       The premultiplied pixel, see gtPaint().
+ * \param[in]    mode         The blend mode.
+ * 
+ * \return       Returns the resulting opaque pixel.
+ */
+////////////////////////////////////////////////////////////
+uint32_t gtBlendPixel(uint32_t destination, uint32_t source, blendMode mode)
+{
+	uint32_t transparency = source >> 24, result = 0;
+
+	for(int shift = 0; shift < 24; shift += 8)
+	{
+		uint32_t add = source >> shift & 0xFF, factor = transparency;
+		if(mode == BLEND_ADD)
+			factor = 255;
+		else if(mode == BLEND_MULTIPLY)
+		{
+			factor = add + transparency;
+			add = 0;
+		}
+
+		uint32_t value = add + gtDiv255((destination >> shift & 0xFF) * factor);
+		result |= (value > 255 ? 255 : value) << shift;
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that applies an opacity to a premultiplied pixel.
+ * 
+ * \param[in]    source   The premultiplied pixel, see gtPaint().
+ * \param[in]    opacity  The opacity, 255 leaves the pixel unchanged.
+ * 
+ * \return       Returns the faded premultiplied pixel.
+ */
+////////////////////////////////////////////////////////////
+uint32_t gtFadePixel(uint32_t source, uint16 opacity)
+{
+	uint32_t alpha = gtDiv255((255 - (source >> 24)) * opacity);
+
+	return (255 - alpha) << 24 | gtDiv255((source >> 16 & 0xFF) * opacity) << 16 | gtDiv255((source >> 8 & 0xFF) * opacity) << 8 | gtDiv255((source & 0xFF) * opacity);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The scalar blending row kernels.
+ * 
+ * \details The first blends one premultiplied value over count pixels, the second blends count premultiplied source pixels, faded by an opacity.
+ */
+////////////////////////////////////////////////////////////
+void gtBlendRowScalar(uint32_t* destination, size_t count, uint32_t source, blendMode mode)
+{
+	for(size_t i = 0; i < count; i++)
+		destination[i] = gtBlendPixel(destination[i], source, mode);
+}
+void gtBlendCopyRowScalar(uint32_t* destination, const uint32_t* source, size_t count, uint16 opacity, blendMode mode)
+{
+	for(size_t i = 0; i < count; i++)
+		destination[i] = gtBlendPixel(destination[i], opacity < 255 ? gtFadePixel(source[i], opacity) : source[i], mode);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The scalar kernel converting two rows to full range 4:2:0 YUV, written by the capture thread.
+ * 
+ * \details Every pixel gets its luma, (77R + 150G + 29B + 128) / 256, and every 2x2 block one chroma sample computed from its average color:
+ *          U = (128B - 43R - 85G + 32895) / 256 and V = (128R - 107G - 21B + 32895) / 256, the BT.601 coefficients scaled to 8 bits.
+ *          Every partial result fits in 16 unsigned bits, so the SIMD kernels compute the same values. The last column of an odd width
+ *          forms a block with itself, and the last row of an odd height is converted by passing it as both rows.
+ */
+////////////////////////////////////////////////////////////
+uint32_t gtLuma(uint32_t pixel)
+{
+	return (77 * (pixel >> 16 & 0xFF) + 150 * (pixel >> 8 & 0xFF) + 29 * (pixel & 0xFF) + 128) >> 8;
+}
+void gtYuvRowsScalar(const uint32_t* top, const uint32_t* bottom, size_t count, unsigned char* lumaTop, unsigned char* lumaBottom, unsigned char* u, unsigned char* v)
+{
+	for(size_t i = 0; i < count; i++)
+	{
+		lumaTop[i] = (unsigned char)gtLuma(top[i]);
+		lumaBottom[i] = (unsigned char)gtLuma(bottom[i]);
+	}
+
+	for(size_t i = 0; i < count; i += 2)
+	{
+		size_t next = i + 1 < count ? i + 1 : i;
+		uint32_t average[3];
+		for(int shift = 0; shift < 24; shift += 8)
+			average[shift / 8] = ((top[i] >> shift & 0xFF) + (top[next] >> shift & 0xFF) + (bottom[i] >> shift & 0xFF) + (bottom[next] >> shift & 0xFF) + 2) >> 2;
+
+		u[i / 2] = (unsigned char)((128 * average[0] - 43 * average[2] - 85 * average[1] + 32895) >> 8);
+		v[i / 2] = (unsigned char)((128 * average[2] - 107 * average[1] - 21 * average[0] + 32895) >> 8);
+	}
+}
+
+//! The scalar kernel converting a row of 24-bit BGR pixels, as stored in a bitmap file, to pixel values.
+void gtBgrRowScalar(uint32_t* destination, const unsigned char* source, size_t count)
+{
+	for(size_t i = 0; i < count; i++, source += 3)
+		destination[i] = (uint32_t)source[2] << 16 | source[1] << 8 | source[0];
+}
+
+//! The pixel row kernels in use, every software drawing operation goes through them. initHost() replaces the scalar ones with the widest supported.
+struct
+{
+	kernelLevel level; //! The instruction set of the kernels below.
+	void (*fillRow)(uint32_t* destination, size_t count, uint32_t value); //! Writes the value to count pixels.
+	void (*copyRow)(uint32_t* destination, const uint32_t* source, size_t count); //! Copies count pixels.
+	void (*keyRow)(uint32_t* destination, const uint32_t* source, size_t count, uint32_t key); //! Copies the pixels whose color is not the key.
+	void (*blendRow)(uint32_t* destination, size_t count, uint32_t source, blendMode mode); //! Blends a premultiplied value over count pixels.
+	void (*blendCopyRow)(uint32_t* destination, const uint32_t* source, size_t count, uint16 opacity, blendMode mode); //! Blends count premultiplied pixels.
+	void (*yuvRows)(const uint32_t* top, const uint32_t* bottom, size_t count, unsigned char* lumaTop, unsigned char* lumaBottom, unsigned char* u, unsigned char* v); //! Converts two rows of count pixels to 4:2:0 YUV.
+	void (*bgrRow)(uint32_t* destination, const unsigned char* source, size_t count); //! Converts count 24-bit BGR pixels.
+}
+gtKernels = {KERNELS_SCALAR, gtFillRowScalar, gtCopyRowScalar, gtKeyRowScalar, gtBlendRowScalar, gtBlendCopyRowScalar, gtYuvRowsScalar, gtBgrRowScalar};
+
+#ifdef GRAPHTE_SIMD
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The SSE2 pixel row kernels, 4 pixels per instruction.
+ * 
+ * \details The fill aligns the destination to 16 bytes first, so the wide stores never cross a cache line.
+ *          The keyed copy blends the source and destination with the comparison mask.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("sse2") void gtFillRowSSE2(uint32_t* destination, size_t count, uint32_t value)
+{
+	__m128i wide = _mm_set1_epi32((int)value);
+	size_t i = 0;
+
+	for(; i < count && ((uintptr_t)(destination + i) & 15); i++)
+		destination[i] = value;
+	for(; i + 4 <= count; i += 4)
+		_mm_store_si128((__m128i*)(destination + i), wide);
+	for(; i < count; i++)
+		destination[i] = value;
+}
+GRAPHTE_TARGET("sse2") void gtCopyRowSSE2(uint32_t* destination, const uint32_t* source, size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_loadu_si128((const __m128i*)(source + i)));
+	for(; i < count; i++)
+		destination[i] = source[i];
+}
+GRAPHTE_TARGET("sse2") void gtKeyRowSSE2(uint32_t* destination, const uint32_t* source, size_t count, uint32_t key)
+{
+	__m128i wideKey = _mm_set1_epi32((int)key), colorBits = _mm_set1_epi32(0xFFFFFF);
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((const __m128i*)(source + i));
+		__m128i keep = _mm_cmpeq_epi32(_mm_and_si128(pixels, colorBits), wideKey);
+		__m128i old = _mm_loadu_si128((const __m128i*)(destination + i));
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_or_si128(_mm_and_si128(keep, old), _mm_andnot_si128(keep, pixels)));
+	}
+	gtKeyRowScalar(destination + i, source + i, count - i, key);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The SSE2 blending row kernels, 4 pixels per iteration.
+ * 
+ * \details The components are widened to 16 bits, so a product by a factor and the division by 255 fit without overflow, and packed back
+ *          with unsigned saturation, which clamps BLEND_ADD. See gtBlendPixel() for the arithmetic.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("sse2") __m128i gtDiv255SSE2(__m128i value)
+{
+	value = _mm_add_epi16(value, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+GRAPHTE_TARGET("sse2") void gtBlendRowSSE2(uint32_t* destination, size_t count, uint32_t source, blendMode mode)
+{
+	uint32_t add = source & 0xFFFFFF, factor = (source >> 24) * 0x010101;
+	if(mode == BLEND_ADD)
+		factor = 0xFFFFFF;
+	else if(mode == BLEND_MULTIPLY)
+	{
+		//! A premultiplied component never exceeds the alpha, so no byte of the sum carries into the next.
+		factor += add;
+		add = 0;
+	}
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i wideAdd = _mm_unpacklo_epi8(_mm_set1_epi32((int)add), zero), wideFactor = _mm_unpacklo_epi8(_mm_set1_epi32((int)factor), zero);
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((const __m128i*)(destination + i));
+		__m128i low = _mm_add_epi16(gtDiv255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), wideFactor)), wideAdd);
+		__m128i high = _mm_add_epi16(gtDiv255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), wideFactor)), wideAdd);
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_packus_epi16(low, high));
+	}
+	gtBlendRowScalar(destination + i, count - i, source, mode);
+}
+GRAPHTE_TARGET("sse2") void gtBlendCopyRowSSE2(uint32_t* destination, const uint32_t* source, size_t count, uint16 opacity, blendMode mode)
+{
+	__m128i zero = _mm_setzero_si128(), full = _mm_set1_epi16(255), wideOpacity = _mm_set1_epi16((short)opacity);
+	__m128i transparencyBits = _mm_set1_epi32((int)0xFF000000), colorBits = _mm_set1_epi32(0xFFFFFF);
+	size_t i = 0;
+
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((const __m128i*)(source + i));
+		if(opacity < 255)
+		{
+			//! The transparency is turned into an alpha, faded with the color components, and turned back.
+			__m128i alpha = _mm_xor_si128(pixels, transparencyBits);
+			__m128i low = gtDiv255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(alpha, zero), wideOpacity));
+			__m128i high = gtDiv255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(alpha, zero), wideOpacity));
+			pixels = _mm_xor_si128(_mm_packus_epi16(low, high), transparencyBits);
+		}
+
+		__m128i canvas = _mm_loadu_si128((const __m128i*)(destination + i)), result[2];
+		for(int half = 0; half < 2; half++)
+		{
+			__m128i add = half ? _mm_unpackhi_epi8(pixels, zero) : _mm_unpacklo_epi8(pixels, zero);
+			__m128i factor = _mm_shufflehi_epi16(_mm_shufflelo_epi16(add, 0xFF), 0xFF);
+			if(mode == BLEND_ADD)
+				factor = full;
+			else if(mode == BLEND_MULTIPLY)
+			{
+				factor = _mm_add_epi16(factor, add);
+				add = zero;
+			}
+
+			__m128i under = half ? _mm_unpackhi_epi8(canvas, zero) : _mm_unpacklo_epi8(canvas, zero);
+			result[half] = _mm_add_epi16(gtDiv255SSE2(_mm_mullo_epi16(under, factor)), add);
+		}
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_and_si128(_mm_packus_epi16(result[0], result[1]), colorBits));
+	}
+	gtBlendCopyRowScalar(destination + i, source + i, count - i, opacity, mode);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The SSE2 kernel converting two rows to 4:2:0 YUV, 16 pixels per iteration.
+ * 
+ * \details The color components of 8 pixels are split into three vectors of 16-bit values. The products and sums wrap around like the
+ *          unsigned arithmetic of gtYuvRowsScalar(), so the shift by 8 gives the same results. The 2x2 blocks are summed by adding the rows,
+ *          then by a multiply-add by 1 of the adjacent lanes.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("sse2") void gtChannelsSSE2(const uint32_t* pixels, __m128i* red, __m128i* green, __m128i* blue)
+{
+	__m128i low = _mm_loadu_si128((const __m128i*)pixels), high = _mm_loadu_si128((const __m128i*)(pixels + 4)), byte = _mm_set1_epi32(0xFF);
+
+	*red = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 16), byte), _mm_and_si128(_mm_srli_epi32(high, 16), byte));
+	*green = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 8), byte), _mm_and_si128(_mm_srli_epi32(high, 8), byte));
+	*blue = _mm_packs_epi32(_mm_and_si128(low, byte), _mm_and_si128(high, byte));
+}
+GRAPHTE_TARGET("sse2") __m128i gtWeighSSE2(__m128i red, __m128i green, __m128i blue, int redWeight, int greenWeight, int blueWeight, int offset)
+{
+	__m128i sum = _mm_add_epi16(_mm_mullo_epi16(red, _mm_set1_epi16((short)redWeight)), _mm_mullo_epi16(green, _mm_set1_epi16((short)greenWeight)));
+	sum = _mm_add_epi16(sum, _mm_mullo_epi16(blue, _mm_set1_epi16((short)blueWeight)));
+	return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16((short)offset)), 8);
+}
+GRAPHTE_TARGET("sse2") void gtYuvRowsSSE2(const uint32_t* top, const uint32_t* bottom, size_t count, unsigned char* lumaTop, unsigned char* lumaBottom, unsigned char* u, unsigned char* v)
+{
+	__m128i zero = _mm_setzero_si128(), ones = _mm_set1_epi16(1), two = _mm_set1_epi16(2);
+	size_t i = 0;
+
+	for(; i + 16 <= count; i += 16)
+	{
+		__m128i luma[2][2], red[2], green[2], blue[2];
+		for(int half = 0; half < 2; half++)
+		{
+			__m128i topRed, topGreen, topBlue, bottomRed, bottomGreen, bottomBlue;
+			gtChannelsSSE2(top + i + half * 8, &topRed, &topGreen, &topBlue);
+			gtChannelsSSE2(bottom + i + half * 8, &bottomRed, &bottomGreen, &bottomBlue);
+			luma[0][half] = gtWeighSSE2(topRed, topGreen, topBlue, 77, 150, 29, 128);
+			luma[1][half] = gtWeighSSE2(bottomRed, bottomGreen, bottomBlue, 77, 150, 29, 128);
+
+			red[half] = _mm_madd_epi16(_mm_add_epi16(topRed, bottomRed), ones);
+			green[half] = _mm_madd_epi16(_mm_add_epi16(topGreen, bottomGreen), ones);
+			blue[half] = _mm_madd_epi16(_mm_add_epi16(topBlue, bottomBlue), ones);
+		}
+		_mm_storeu_si128((__m128i*)(lumaTop + i), _mm_packus_epi16(luma[0][0], luma[0][1]));
+		_mm_storeu_si128((__m128i*)(lumaBottom + i), _mm_packus_epi16(luma[1][0], luma[1][1]));
+
+		__m128i averageRed = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(red[0], red[1]), two), 2);
+		__m128i averageGreen = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(green[0], green[1]), two), 2);
+		__m128i averageBlue = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(blue[0], blue[1]), two), 2);
+		_mm_storel_epi64((__m128i*)(u + i / 2), _mm_packus_epi16(gtWeighSSE2(averageRed, averageGreen, averageBlue, -43, -85, 128, 32895), zero));
+		_mm_storel_epi64((__m128i*)(v + i / 2), _mm_packus_epi16(gtWeighSSE2(averageRed, averageGreen, averageBlue, 128, -107, -21, 32895), zero));
+	}
+	gtYuvRowsScalar(top + i, bottom + i, count - i, lumaTop + i, lumaBottom + i, u + i / 2, v + i / 2);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The SSE2 kernel converting 24-bit BGR pixels, 4 pixels per iteration.
+ * 
+ * \details SSE2 has no byte shuffle, the 16 bytes holding 4 pixels are shifted by 0, 3, 6 and 9 bytes and the low 32 bits of every shift
+ *          are interleaved. A load reads 4 bytes past the pixels it converts, the last pixels of the row are left to the scalar kernel.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("sse2") void gtBgrRowSSE2(uint32_t* destination, const unsigned char* source, size_t count)
+{
+	__m128i colorBits = _mm_set1_epi32(0xFFFFFF);
+	size_t i = 0;
+
+	for(; i + 6 <= count; i += 4)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(source + i * 3));
+		__m128i low = _mm_unpacklo_epi32(bytes, _mm_srli_si128(bytes, 3));
+		__m128i high = _mm_unpacklo_epi32(_mm_srli_si128(bytes, 6), _mm_srli_si128(bytes, 9));
+		_mm_storeu_si128((__m128i*)(destination + i), _mm_and_si128(_mm_unpacklo_epi64(low, high), colorBits));
+	}
+	gtBgrRowScalar(destination + i, source + i * 3, count - i);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The AVX2 pixel row kernels, 8 pixels per instruction.
+ * 
+ * \details The keyed copy uses a masked store, so the transparent pixels of the destination are not even read.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("avx2") void gtFillRowAVX2(uint32_t* destination, size_t count, uint32_t value)
+{
+	__m256i wide = _mm256_set1_epi32((int)value);
+	size_t i = 0;
+
+	for(; i < count && ((uintptr_t)(destination + i) & 31); i++)
+		destination[i] = value;
+	for(; i + 8 <= count; i += 8)
+		_mm256_store_si256((__m256i*)(destination + i), wide);
+	for(; i < count; i++)
+		destination[i] = value;
+}
+GRAPHTE_TARGET("avx2") void gtCopyRowAVX2(uint32_t* destination, const uint32_t* source, size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+		_mm256_storeu_si256((__m256i*)(destination + i), _mm256_loadu_si256((const __m256i*)(source + i)));
+	for(; i < count; i++)
+		destination[i] = source[i];
+}
+GRAPHTE_TARGET("avx2") void gtKeyRowAVX2(uint32_t* destination, const uint32_t* source, size_t count, uint32_t key)
+{
+	__m256i wideKey = _mm256_set1_epi32((int)key), colorBits = _mm256_set1_epi32(0xFFFFFF), ones = _mm256_set1_epi32(-1);
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		__m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i));
+		__m256i write = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_and_si256(pixels, colorBits), wideKey), ones);
+		_mm256_maskstore_epi32((int*)(destination + i), write, pixels);
+	}
+	gtKeyRowScalar(destination + i, source + i, count - i, key);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The AVX2 blending row kernels, 8 pixels per iteration.
+ * 
+ * \details The unpack, shuffle and pack instructions work within each 128-bit half, which keeps the pixels in order. The AVX-512 level uses
+ *          these as well.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("avx2") __m256i gtDiv255AVX2(__m256i value)
+{
+	value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+}
+GRAPHTE_TARGET("avx2") void gtBlendRowAVX2(uint32_t* destination, size_t count, uint32_t source, blendMode mode)
+{
+	uint32_t add = source & 0xFFFFFF, factor = (source >> 24) * 0x010101;
+	if(mode == BLEND_ADD)
+		factor = 0xFFFFFF;
+	else if(mode == BLEND_MULTIPLY)
+	{
+		//! A premultiplied component never exceeds the alpha, so no byte of the sum carries into the next.
+		factor += add;
+		add = 0;
+	}
+
+	__m256i zero = _mm256_setzero_si256();
+	__m256i wideAdd = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)add), zero), wideFactor = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)factor), zero);
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		__m256i pixels = _mm256_loadu_si256((const __m256i*)(destination + i));
+		__m256i low = _mm256_add_epi16(gtDiv255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(pixels, zero), wideFactor)), wideAdd);
+		__m256i high = _mm256_add_epi16(gtDiv255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(pixels, zero), wideFactor)), wideAdd);
+		_mm256_storeu_si256((__m256i*)(destination + i), _mm256_packus_epi16(low, high));
+	}
+	gtBlendRowScalar(destination + i, count - i, source, mode);
+}
+GRAPHTE_TARGET("avx2") void gtBlendCopyRowAVX2(uint32_t* destination, const uint32_t* source, size_t count, uint16 opacity, blendMode mode)
+{
+	__m256i zero = _mm256_setzero_si256(), full = _mm256_set1_epi16(255), wideOpacity = _mm256_set1_epi16((short)opacity);
+	__m256i transparencyBits = _mm256_set1_epi32((int)0xFF000000), colorBits = _mm256_set1_epi32(0xFFFFFF);
+	size_t i = 0;
+
+	for(; i + 8 <= count; i += 8)
+	{
+		__m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i));
+		if(opacity < 255)
+		{
+			//! The transparency is turned into an alpha, faded with the color components, and turned back.
+			__m256i alpha = _mm256_xor_si256(pixels, transparencyBits);
+			__m256i low = gtDiv255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(alpha, zero), wideOpacity));
+			__m256i high = gtDiv255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(alpha, zero), wideOpacity));
+			pixels = _mm256_xor_si256(_mm256_packus_epi16(low, high), transparencyBits);
+		}
+
+		__m256i canvas = _mm256_loadu_si256((const __m256i*)(destination + i)), result[2];
+		for(int half = 0; half < 2; half++)
+		{
+			__m256i add = half ? _mm256_unpackhi_epi8(pixels, zero) : _mm256_unpacklo_epi8(pixels, zero);
+			__m256i factor = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(add, 0xFF), 0xFF);
+			if(mode == BLEND_ADD)
+				factor = full;
+			else if(mode == BLEND_MULTIPLY)
+			{
+				factor = _mm256_add_epi16(factor, add);
+				add = zero;
+			}
+
+			__m256i under = half ? _mm256_unpackhi_epi8(canvas, zero) : _mm256_unpacklo_epi8(canvas, zero);
+			result[half] = _mm256_add_epi16(gtDiv255AVX2(_mm256_mullo_epi16(under, factor)), add);
+		}
+		_mm256_storeu_si256((__m256i*)(destination + i), _mm256_and_si256(_mm256_packus_epi16(result[0], result[1]), colorBits));
+	}
+	gtBlendCopyRowScalar(destination + i, source + i, count - i, opacity, mode);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The AVX2 kernel converting two rows to 4:2:0 YUV, 32 pixels per iteration.
+ * 
+ * \details The same arithmetic as gtYuvRowsSSE2(). The packing instructions work inside each 128-bit lane, a permutation of the 64-bit
+ *          quarters puts the values back in order after each of them.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("avx2") void gtChannelsAVX2(const uint32_t* pixels, __m256i* red, __m256i* green, __m256i* blue)
+{
+	__m256i low = _mm256_loadu_si256((const __m256i*)pixels), high = _mm256_loadu_si256((const __m256i*)(pixels + 8)), byte = _mm256_set1_epi32(0xFF);
+
+	*red = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(low, 16), byte), _mm256_and_si256(_mm256_srli_epi32(high, 16), byte)), 0xD8);
+	*green = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(low, 8), byte), _mm256_and_si256(_mm256_srli_epi32(high, 8), byte)), 0xD8);
+	*blue = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(low, byte), _mm256_and_si256(high, byte)), 0xD8);
+}
+GRAPHTE_TARGET("avx2") __m256i gtWeighAVX2(__m256i red, __m256i green, __m256i blue, int redWeight, int greenWeight, int blueWeight, int offset)
+{
+	__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(red, _mm256_set1_epi16((short)redWeight)), _mm256_mullo_epi16(green, _mm256_set1_epi16((short)greenWeight)));
+	sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(blue, _mm256_set1_epi16((short)blueWeight)));
+	return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16((short)offset)), 8);
+}
+GRAPHTE_TARGET("avx2") void gtYuvRowsAVX2(const uint32_t* top, const uint32_t* bottom, size_t count, unsigned char* lumaTop, unsigned char* lumaBottom, unsigned char* u, unsigned char* v)
+{
+	__m256i zero = _mm256_setzero_si256(), ones = _mm256_set1_epi16(1), two = _mm256_set1_epi16(2);
+	size_t i = 0;
+
+	for(; i + 32 <= count; i += 32)
+	{
+		__m256i luma[2][2], red[2], green[2], blue[2];
+		for(int half = 0; half < 2; half++)
+		{
+			__m256i topRed, topGreen, topBlue, bottomRed, bottomGreen, bottomBlue;
+			gtChannelsAVX2(top + i + half * 16, &topRed, &topGreen, &topBlue);
+			gtChannelsAVX2(bottom + i + half * 16, &bottomRed, &bottomGreen, &bottomBlue);
+			luma[0][half] = gtWeighAVX2(topRed, topGreen, topBlue, 77, 150, 29, 128);
+			luma[1][half] = gtWeighAVX2(bottomRed, bottomGreen, bottomBlue, 77, 150, 29, 128);
+
+			red[half] = _mm256_madd_epi16(_mm256_add_epi16(topRed, bottomRed), ones);
+			green[half] = _mm256_madd_epi16(_mm256_add_epi16(topGreen, bottomGreen), ones);
+			blue[half] = _mm256_madd_epi16(_mm256_add_epi16(topBlue, bottomBlue), ones);
+		}
+		_mm256_storeu_si256((__m256i*)(lumaTop + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(luma[0][0], luma[0][1]), 0xD8));
+		_mm256_storeu_si256((__m256i*)(lumaBottom + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(luma[1][0], luma[1][1]), 0xD8));
+
+		__m256i averageRed = _mm256_srli_epi16(_mm256_add_epi16(_mm256_permute4x64_epi64(_mm256_packs_epi32(red[0], red[1]), 0xD8), two), 2);
+		__m256i averageGreen = _mm256_srli_epi16(_mm256_add_epi16(_mm256_permute4x64_epi64(_mm256_packs_epi32(green[0], green[1]), 0xD8), two), 2);
+		__m256i averageBlue = _mm256_srli_epi16(_mm256_add_epi16(_mm256_permute4x64_epi64(_mm256_packs_epi32(blue[0], blue[1]), 0xD8), two), 2);
+		__m256i chromaU = _mm256_permute4x64_epi64(_mm256_packus_epi16(gtWeighAVX2(averageRed, averageGreen, averageBlue, -43, -85, 128, 32895), zero), 0xD8);
+		__m256i chromaV = _mm256_permute4x64_epi64(_mm256_packus_epi16(gtWeighAVX2(averageRed, averageGreen, averageBlue, 128, -107, -21, 32895), zero), 0xD8);
+		_mm_storeu_si128((__m128i*)(u + i / 2), _mm256_castsi256_si128(chromaU));
+		_mm_storeu_si128((__m128i*)(v + i / 2), _mm256_castsi256_si128(chromaV));
+	}
+	gtYuvRowsScalar(top + i, bottom + i, count - i, lumaTop + i, lumaBottom + i, u + i / 2, v + i / 2);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The AVX2 kernel converting 24-bit BGR pixels, 8 pixels per iteration.
+ * 
+ * \details Each 128-bit lane is loaded with 4 pixels in its low 12 bytes, then a byte shuffle spreads them to 32 bits and clears the fourth byte.
+ *          The upper load reads 4 bytes past the pixels it converts, the last pixels of the row are left to the scalar kernel.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("avx2") void gtBgrRowAVX2(uint32_t* destination, const unsigned char* source, size_t count)
+{
+	__m256i order = _mm256_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128, 0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+	size_t i = 0;
+
+	for(; i + 10 <= count; i += 8)
+	{
+		__m128i low = _mm_loadu_si128((const __m128i*)(source + i * 3)), high = _mm_loadu_si128((const __m128i*)(source + i * 3 + 12));
+		__m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+		_mm256_storeu_si256((__m256i*)(destination + i), _mm256_shuffle_epi8(bytes, order));
+	}
+	gtBgrRowScalar(destination + i, source + i * 3, count - i);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   The AVX-512 pixel row kernels, 16 pixels per instruction.
+ * 
+ * \details The last pixels of a row are handled with a masked load and store instead of a scalar loop.
+ */
+////////////////////////////////////////////////////////////
+GRAPHTE_TARGET("avx512f") void gtFillRowAVX512(uint32_t* destination, size_t count, uint32_t value)
+{
+	__m512i wide = _mm512_set1_epi32((int)value);
+	size_t i = 0;
+
+	for(; i + 16 <= count; i += 16)
+		_mm512_storeu_si512((void*)(destination + i), wide);
+	if(i < count)
+		_mm512_mask_storeu_epi32(destination + i, (__mmask16)((1u << (count - i)) - 1), wide);
+}
+GRAPHTE_TARGET("avx512f") void gtCopyRowAVX512(uint32_t* destination, const uint32_t* source, size_t count)
+{
+	size_t i = 0;
+
+	for(; i + 16 <= count; i += 16)
+		_mm512_storeu_si512((void*)(destination + i), _mm512_loadu_si512((const void*)(source + i)));
+	if(i < count)
+	{
+		__mmask16 tail = (__mmask16)((1u << (count - i)) - 1);
+		_mm512_mask_storeu_epi32(destination + i, tail, _mm512_maskz_loadu_epi32(tail, source + i));
+	}
+}
+GRAPHTE_TARGET("avx512f") void gtKeyRowAVX512(uint32_t* destination, const uint32_t* source, size_t count, uint32_t key)
+{
+	__m512i wideKey = _mm512_set1_epi32((int)key), colorBits = _mm512_set1_epi32(0xFFFFFF);
+
+	for(size_t i = 0; i < count; i += 16)
+	{
+		__mmask16 lanes = count - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (count - i)) - 1);
+		__m512i pixels = _mm512_maskz_loadu_epi32(lanes, source + i);
+		_mm512_mask_storeu_epi32(destination + i, _mm512_mask_cmpneq_epi32_mask(lanes, _mm512_and_si512(pixels, colorBits), wideKey), pixels);
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the instruction sets supported by the processor and the operating system.
+ * 
+ * \details The CPUID feature bits tell what the processor supports, and XGETBV tells whether the operating system saves the wide registers
+ *          on a context switch, which AVX and AVX-512 need as well.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return       Returns the widest supported kernel level.
+ */
+////////////////////////////////////////////////////////////
+kernelLevel gtDetectKernels()
+{
+	unsigned int registers[4] = {0, 0, 0, 0}, features[4] = {0, 0, 0, 0}, extended[4] = {0, 0, 0, 0};
+
+#ifdef _MSC_VER
+	__cpuid((int*)registers, 0);
+	if(registers[0] >= 1)
+		__cpuid((int*)features, 1);
+	if(registers[0] >= 7)
+		__cpuidex((int*)extended, 7, 0);
+#else
+	__cpuid(0, registers[0], registers[1], registers[2], registers[3]);
+	if(registers[0] >= 1)
+		__cpuid(1, features[0], features[1], features[2], features[3]);
+	if(registers[0] >= 7)
+		__cpuid_count(7, 0, extended[0], extended[1], extended[2], extended[3]);
+#endif
+
+	if(!(features[3] & 1u << 26))
+		return KERNELS_SCALAR;
+
+	//! OSXSAVE and AVX, then the register state enabled by the operating system.
+	uint64_t state = 0;
+	if((features[2] & 1u << 27) && (features[2] & 1u << 28))
+	{
+#ifdef _MSC_VER
+		state = _xgetbv(0);
+#else
+		unsigned int low, high;
+		__asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		state = (uint64_t)high << 32 | low;
+#endif
+	}
+
+	if((state & 0xE6) == 0xE6 && (extended[1] & 1u << 16))
+		return KERNELS_AVX512;
+	if((state & 0x6) == 0x6 && (extended[1] & 1u << 5))
+		return KERNELS_AVX2;
+	return KERNELS_SSE2;
+}
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that selects the pixel row kernels.
+ * 
+ * \details The kernels are chosen once by initHost(), the widest instruction set the machine supports is used. A lower level can be forced,
+ *          for example to compare the kernels with each other.
+ * 
+ * \param[in]    level  The instruction set to be used, it is lowered to the widest one supported.
+ * 
+ * \return       Returns the level actually selected.
+ */
+////////////////////////////////////////////////////////////
+kernelLevel gtUseKernels(kernelLevel level)
+{
+#ifdef GRAPHTE_SIMD
+	static kernelLevel supported = (kernelLevel)-1;
+	if(supported == (kernelLevel)-1)
+		supported = gtDetectKernels();
+	if(level > supported)
+		level = supported;
+#else
+	level = KERNELS_SCALAR;
+#endif
+
+	gtKernels.level = level;
+	gtKernels.fillRow = gtFillRowScalar;
+	gtKernels.copyRow = gtCopyRowScalar;
+	gtKernels.keyRow = gtKeyRowScalar;
+	gtKernels.blendRow = gtBlendRowScalar;
+	gtKernels.blendCopyRow = gtBlendCopyRowScalar;
+	gtKernels.yuvRows = gtYuvRowsScalar;
+	gtKernels.bgrRow = gtBgrRowScalar;
+
+#ifdef GRAPHTE_SIMD
+	if(level == KERNELS_SSE2)
+	{
+		gtKernels.fillRow = gtFillRowSSE2;
+		gtKernels.copyRow = gtCopyRowSSE2;
+		gtKernels.keyRow = gtKeyRowSSE2;
+		gtKernels.blendRow = gtBlendRowSSE2;
+		gtKernels.blendCopyRow = gtBlendCopyRowSSE2;
+		gtKernels.yuvRows = gtYuvRowsSSE2;
+		gtKernels.bgrRow = gtBgrRowSSE2;
+	}
+	else if(level == KERNELS_AVX2)
+	{
+		gtKernels.fillRow = gtFillRowAVX2;
+		gtKernels.copyRow = gtCopyRowAVX2;
+		gtKernels.keyRow = gtKeyRowAVX2;
+		gtKernels.blendRow = gtBlendRowAVX2;
+		gtKernels.blendCopyRow = gtBlendCopyRowAVX2;
+		gtKernels.yuvRows = gtYuvRowsAVX2;
+		gtKernels.bgrRow = gtBgrRowAVX2;
+	}
+	else if(level == KERNELS_AVX512)
+	{
+		gtKernels.fillRow = gtFillRowAVX512;
+		gtKernels.copyRow = gtCopyRowAVX512;
+		gtKernels.keyRow = gtKeyRowAVX512;
+		gtKernels.blendRow = gtBlendRowAVX2;
+		gtKernels.blendCopyRow = gtBlendCopyRowAVX2;
+		gtKernels.yuvRows = gtYuvRowsAVX2;
+		gtKernels.bgrRow = gtBgrRowAVX2;
+	}
+#endif
+
+	return level;
+}
+
+//! The tile of the back buffer a thread is restricted to while it draws a part of a command buffer, see drawCommands().
+GRAPHTE_THREAD_LOCAL struct
+{
+	BOOL active; //! FALSE when the thread draws on the whole buffer.
+	int left, top, right, bottom;
+}
+gtTile;
+
+//! The part of the back buffer the drawing functions of the calling thread can write: the whole buffer, or the thread's tile.
+gtRect gtDrawArea()
+{
+	gtRect area = {0, 0, host.width, host.height};
+
+	if(gtTile.active)
+	{
+		if(gtTile.left > area.left) area.left = gtTile.left;
+		if(gtTile.top > area.top) area.top = gtTile.top;
+		if(gtTile.right < area.right) area.right = gtTile.right;
+		if(gtTile.bottom < area.bottom) area.bottom = gtTile.bottom;
+	}
+	return area;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a premultiplied value over a rectangle of the back buffer.
+ * 
+ * \details This function clips the rectangle [left, right) x [top, bottom) to the buffer, or to the tile of the calling thread. Opaque values drawn with BLEND_ALPHA are written as they are,
+ *          anything else is blended with the current blend mode. It works on every backend, GDI included, since the canvas bits are always addressable.
+ * 
+ * \param[in]    left    The x-coordinate of the first column.
+ * \param[in]    top     The y-coordinate of the first row.
+ * \param[in]    right   The x-coordinate one past the last column.
+ * \param[in]    bottom  The y-coordinate one past the last row.
+ * \param[in]    paint   The premultiplied value, see gtPaint().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtPaintRect(int left, int top, int right, int bottom, uint32_t paint)
+{
+	gtRect area = gtDrawArea();
+
+	if(left < area.left) left = area.left;
+	if(top < area.top) top = area.top;
+	if(right > area.right) right = area.right;
+	if(bottom > area.bottom) bottom = area.bottom;
+	//! A fully transparent value leaves the canvas unchanged in every blend mode.
+	if(left >= right || top >= bottom || paint == 0xFF000000)
+		return;
+
+	BOOL opaque = gtOpaque(paint);
+	size_t width = right - left;
+	int rows = bottom - top;
+
+	//! Rows spanning the whole stride are contiguous, they are drawn in a single run.
+	if(width == host.stride)
+	{
+		width *= rows;
+		rows = 1;
+	}
+
+	for(int y = 0; y < rows; y++)
+	{
+		uint32_t* row = host.pixels + (size_t)(top + y) * host.stride + left;
+		if(opaque)
+			gtKernels.fillRow(row, width, paint);
+		else
+			gtKernels.blendRow(row, width, paint, gtBlend.mode);
+	}
+}
+
+////////////////////////////////////////////////////////////
+// Line rasterization
+////////////////////////////////////////////////////////////
+
+//! A segment of a stroked path, prepared once so the scanlines only evaluate distances.
+typedef struct
+{
+	float x, y; //! The start point.
+	float dx, dy; //! The vector from the start point to the end point.
+	float length; //! The length, 0 for a segment reduced to a point.
+	float inverseLength; //! 1 over the squared length, 0 for a segment reduced to a point.
+	float top, bottom; //! The rows the segment reaches, stroke radius included.
+	int next; //! The next segment starting on the same row, -1 for none.
+}
+gtSegment;
+
+//! The stroke state shared by line() and polyline(): the antialiasing switch and the scratch buffers of the scanline rasterizer.
+//! Every thread has its own, see gtTile.
+GRAPHTE_THREAD_LOCAL struct
+{
+	BOOL antialias; //! Set by setAntialiasing().
+	gtSegment* segments; //! The segments of the path being drawn.
+	size_t segmentCapacity;
+	gtSegment** active; //! The segments reaching the current row.
+	size_t activeCapacity;
+	int* spans; //! The first and last column covered by every active segment on the current row.
+	size_t spanCapacity;
+	int* rowHeads; //! The first segment starting on every row, the others follow through gtSegment.next.
+	size_t rowCapacity;
+	uint8_t* coverage; //! The coverage of one row, 0 to 255 per pixel, left cleared after every row.
+	size_t coverageCapacity;
+}
+gtStroke;
+
+//! Makes a scratch buffer hold count elements of the given size. The content is not kept.
+BOOL gtReserve(void** buffer, size_t* capacity, size_t count, size_t size)
+{
+	if(count <= *capacity)
+		return TRUE;
+
+	free(*buffer);
+	*buffer = malloc(count * size);
+	*capacity = *buffer ? count : 0;
+	return *buffer != NULL;
+}
+
+//! Frees the scratch buffers of the stroke state of the calling thread.
+void gtReleaseStroke()
+{
+	free(gtStroke.segments);
+	free(gtStroke.active);
+	free(gtStroke.spans);
+	free(gtStroke.rowHeads);
+	free(gtStroke.coverage);
+	gtStroke.segments = NULL;
+	gtStroke.active = NULL;
+	gtStroke.spans = NULL;
+	gtStroke.rowHeads = NULL;
+	gtStroke.coverage = NULL;
+	gtStroke.segmentCapacity = gtStroke.activeCapacity = gtStroke.spanCapacity = gtStroke.rowCapacity = gtStroke.coverageCapacity = 0;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a one pixel wide line without antialiasing.
+ * 
+ * \details The Bresenham walk goes from the first point up to, but not including the second one. Consecutive pixels of a row
+ *          (of a column for steep lines) are drawn as a single span, so the kernels see runs instead of single pixels.
+ * 
+ * \param[in]    x1     The x-coordinate of the start point.
+ * \param[in]    y1     The y-coordinate of the start point.
+ * \param[in]    x2     The x-coordinate of the end point.
+ * \param[in]    y2     The y-coordinate of the end point.
+ * \param[in]    paint  The premultiplied value, see gtPaint().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtStrokeThin(int x1, int y1, int x2, int y2, uint32_t paint)
+{
+	int dx = abs(x2 - x1), dy = abs(y2 - y1);
+	int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+	int error = dx - dy;
+	int x = x1, y = y1, runX = x1, runY = y1;
+
+	while(x != x2 || y != y2)
+	{
+		int lastX = x, lastY = y, error2 = 2 * error;
+		if(error2 > -dy) { error -= dy; x += sx; }
+		if(error2 < dx) { error += dx; y += sy; }
+
+		//! The span ends when the walk leaves its row (or column), or at the end point.
+		if((x == x2 && y == y2) || (dx >= dy ? y != runY : x != runX))
+		{
+			gtPaintRect(runX < lastX ? runX : lastX, runY < lastY ? runY : lastY, (runX > lastX ? runX : lastX) + 1, (runY > lastY ? runY : lastY) + 1, paint);
+			runX = x;
+			runY = y;
+		}
+	}
+}
+
+//! Narrows the span [*from, *to] to the x where minimum <= a * x + b <= maximum.
+void gtClipSpan(double a, double b, double minimum, double maximum, double* from, double* to)
+{
+	if(a == 0)
+	{
+		if(b < minimum || b > maximum)
+		{
+			*from = INFINITY;
+			*to = -INFINITY;
+		}
+		return;
+	}
+
+	double first = (minimum - b) / a, second = (maximum - b) / a;
+	if(first > second) { double swap = first; first = second; second = swap; }
+	if(first > *from) *from = first;
+	if(second < *to) *to = second;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds the part of a row within a distance of a segment.
+ * 
+ * \details The points within the distance form a capsule. Its intersection with the row is the union of the intersections with the circles
+ *          around both ends and with the band along the segment, and is a single span since the capsule is convex.
+ * 
+ * \param[in]    segment   The segment.
+ * \param[in]    row       The row.
+ * \param[in]    distance  The distance from the segment.
+ * \param[out]   from      The x-coordinate where the span starts.
+ * \param[out]   to        The x-coordinate where the span ends.
+ * 
+ * \return       Returns TRUE if the row crosses the capsule.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtCapsuleSpan(const gtSegment* segment, int row, float distance, float* from, float* to)
+{
+	float y = row - segment->y, left = INFINITY, right = -INFINITY;
+
+	for(int end = 0; end < 2; end++)
+	{
+		float centerX = end ? segment->dx : 0, centerY = end ? segment->dy : 0;
+		float chord = distance * distance - (y - centerY) * (y - centerY);
+		if(chord >= 0)
+		{
+			chord = sqrtf(chord);
+			if(centerX - chord < left) left = centerX - chord;
+			if(centerX + chord > right) right = centerX + chord;
+		}
+	}
+
+	//! The band holds the points whose distance to the line is at most the distance and whose projection falls on the segment.
+	if(segment->length > 0)
+	{
+		double bandLeft = -INFINITY, bandRight = INFINITY;
+		gtClipSpan(segment->dy, -y * segment->dx, -distance * segment->length, distance * segment->length, &bandLeft, &bandRight);
+		gtClipSpan(segment->dx, y * segment->dy, 0, segment->length * segment->length, &bandLeft, &bandRight);
+		if(bandLeft <= bandRight)
+		{
+			if(bandLeft < left) left = bandLeft;
+			if(bandRight > right) right = bandRight;
+		}
+	}
+
+	*from = segment->x + left;
+	*to = segment->x + right;
+	return left <= right;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that measures how much of a pixel an antialiased stroke covers.
+ * 
+ * \param[in]    segment  The segment.
+ * \param[in]    x        The column of the pixel.
+ * \param[in]    row      The row of the pixel.
+ * \param[in]    reach    The stroke radius plus half a pixel, the distance where the coverage falls to 0.
+ * \param[in]    fade     The opacity of a fully covered pixel, below 1 for strokes thinner than a pixel.
+ * 
+ * \return       Returns the coverage, from 0 to 255.
+ */
+////////////////////////////////////////////////////////////
+uint8_t gtStrokeCoverage(const gtSegment* segment, int x, int row, float reach, float fade)
+{
+	float px = x - segment->x, py = row - segment->y;
+	float t = (px * segment->dx + py * segment->dy) * segment->inverseLength;
+	if(t < 0) t = 0;
+	if(t > 1) t = 1;
+	float ex = px - t * segment->dx, ey = py - t * segment->dy;
+	float cover = reach - sqrtf(ex * ex + ey * ey);
+
+	return cover <= 0 ? 0 : (uint8_t)((cover > 1 ? 1 : cover) * fade * 255 + 0.5f);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws the coverage of a span of a row collected by gtStrokePath() and clears it.
+ * 
+ * \details Fully covered runs go through the row kernels, partially covered pixels are faded by their coverage and blended one by one.
+ * 
+ * \param[in]    row    The row of the back buffer.
+ * \param[in]    left   The first column of the span.
+ * \param[in]    right  The last column of the span.
+ * \param[in]    paint  The premultiplied value, see gtPaint().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtStrokeRow(int row, int left, int right, uint32_t paint)
+{
+	uint8_t* coverage = gtStroke.coverage;
+	uint32_t* destination = host.pixels + (size_t)row * host.stride;
+
+	for(int x = left; x <= right; )
+	{
+		if(coverage[x] == 255)
+		{
+			int start = x;
+			while(x <= right && coverage[x] == 255)
+				coverage[x++] = 0;
+			gtPaintRect(start, row, x, row + 1, paint);
+		}
+		else
+		{
+			if(coverage[x])
+				destination[x] = gtBlendPixel(destination[x], gtFadePixel(paint, coverage[x]), gtBlend.mode);
+			coverage[x++] = 0;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that strokes a path of connected segments into the back buffer.
+ * 
+ * \details Hard one pixel wide paths go through gtStrokeThin(). Wider and antialiased paths are rasterized row by row: every pixel takes
+ *          the largest coverage over the segments, then the row is drawn once. The span of the row within the stroke around a segment is solved
+ *          directly, only the antialiased pixels along its edges measure their distance to the segment.
+ *          The segments are bucketed by their first row, so every row only visits the segments that reach it,
+ *          and only the spans they cover are drawn, merged where they overlap.
+ *          The stroke around a segment is a capsule, so the ends are round and the joins between segments need no extra geometry,
+ *          and a translucent path is blended once where its segments overlap.
+ * 
+ * \param[in]    points  The points of the path.
+ * \param[in]    count   The number of points, a single point draws a dot.
+ * \param[in]    width   The width of the stroke. Without antialiasing, it is rounded to whole pixels.
+ * \param[in]    paint   The premultiplied value, see gtPaint().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtStrokePath(const vector2f* points, size_t count, float width, uint32_t paint)
+{
+	float radius, reach, bias = 0, fade = 1, top = INFINITY, bottom = -INFINITY;
+	size_t segmentCount = count > 1 ? count - 1 : 1;
+
+	if(!count || paint == 0xFF000000 || !(width > 0))
+		return;
+
+	if(gtStroke.antialias)
+	{
+		//! Strokes thinner than a pixel keep a one pixel footprint and fade instead, which keeps them from breaking up.
+		if(width < 1)
+		{
+			fade = width;
+			width = 1;
+		}
+		radius = width / 2;
+		reach = radius + 0.5f;
+	}
+	else
+	{
+		int thickness = width < 1.5f ? 1 : width > host.width + host.height ? host.width + host.height : (int)(width + 0.5f);
+		BOOL near = TRUE;
+		for(size_t i = 0; i < count && near; i++)
+			near = fabsf(points[i].x) < 32768 && fabsf(points[i].y) < 32768;
+
+		//! The Bresenham walk visits every pixel of the line, far away points take the scanline path, which only visits the window.
+		if(thickness == 1 && near)
+		{
+			for(size_t i = 0; i + 1 < count; i++)
+				gtStrokeThin((int)floorf(points[i].x + 0.5f), (int)floorf(points[i].y + 0.5f), (int)floorf(points[i + 1].x + 0.5f), (int)floorf(points[i + 1].y + 0.5f), paint);
+			if(count == 1)
+				gtPaintRect((int)floorf(points[0].x + 0.5f), (int)floorf(points[0].y + 0.5f), (int)floorf(points[0].x + 0.5f) + 1, (int)floorf(points[0].y + 0.5f) + 1, paint);
+			return;
+		}
+		//! An even width has no center pixel, the pixels are sampled half a pixel off so that it covers exactly width pixels.
+		radius = reach = thickness / 2.0f;
+		bias = thickness % 2 ? 0 : 0.5f;
+	}
+
+	if(host.width > gtStroke.coverageCapacity)
+	{
+		if(!gtReserve((void**)&gtStroke.coverage, &gtStroke.coverageCapacity, host.width, 1))
+			return;
+		memset(gtStroke.coverage, 0, host.width);
+	}
+	if(!gtReserve((void**)&gtStroke.segments, &gtStroke.segmentCapacity, segmentCount, sizeof(gtSegment)) ||
+	   !gtReserve((void**)&gtStroke.active, &gtStroke.activeCapacity, segmentCount, sizeof(gtSegment*)) ||
+	   !gtReserve((void**)&gtStroke.spans, &gtStroke.spanCapacity, 2 * segmentCount, sizeof(int)) ||
+	   !gtReserve((void**)&gtStroke.rowHeads, &gtStroke.rowCapacity, host.height, sizeof(int)))
+		return;
+
+	for(size_t i = 0; i < segmentCount; i++)
+	{
+		gtSegment* segment = gtStroke.segments + i;
+		vector2f start = points[i], end = points[count > 1 ? i + 1 : i];
+		double from = 0, to = 1, margin = reach + 1;
+
+		//! The segment is clipped to the window and the stroke around it, so that points far away keep the distances precise.
+		gtClipSpan((double)end.x - start.x, start.x, -margin, host.width + margin, &from, &to);
+		gtClipSpan((double)end.y - start.y, start.y, -margin, host.height + margin, &from, &to);
+		if(!(from <= to))
+		{
+			segment->top = INFINITY;
+			segment->bottom = -INFINITY;
+			continue;
+		}
+		start = (vector2f){points[i].x + (float)(from * ((double)end.x - points[i].x)), points[i].y + (float)(from * ((double)end.y - points[i].y))};
+		end = (vector2f){points[i].x + (float)(to * ((double)end.x - points[i].x)), points[i].y + (float)(to * ((double)end.y - points[i].y))};
+		float length = (end.x - start.x) * (end.x - start.x) + (end.y - start.y) * (end.y - start.y);
+
+		segment->x = start.x - bias;
+		segment->y = start.y - bias;
+		segment->dx = end.x - start.x;
+		segment->dy = end.y - start.y;
+		segment->length = sqrtf(length);
+		segment->inverseLength = length > 0 ? 1 / length : 0;
+		segment->top = (start.y < end.y ? start.y : end.y) - bias - reach;
+		segment->bottom = (start.y > end.y ? start.y : end.y) - bias + reach;
+
+		if(segment->top < top) top = segment->top;
+		if(segment->bottom > bottom) bottom = segment->bottom;
+	}
+
+	//! The geometry is always clipped to the window, only the drawn rows and columns depend on the tile, so a tile gets the same pixels as the whole buffer.
+	gtRect area = gtDrawArea();
+	if(!(top <= area.bottom - 1) || !(bottom >= area.top))
+		return;
+
+	int firstRow = top < area.top ? area.top : (int)ceilf(top);
+	int lastRow = bottom >= area.bottom ? area.bottom - 1 : (int)floorf(bottom);
+	size_t activeCount = 0;
+
+	for(int row = firstRow; row <= lastRow; row++)
+		gtStroke.rowHeads[row] = -1;
+	for(size_t i = 0; i < segmentCount; i++)
+	{
+		gtSegment* segment = gtStroke.segments + i;
+		if(segment->bottom < firstRow || segment->top > lastRow)
+			continue;
+
+		int row = segment->top < firstRow ? firstRow : (int)ceilf(segment->top);
+		segment->next = gtStroke.rowHeads[row];
+		gtStroke.rowHeads[row] = (int)i;
+	}
+
+	for(int row = firstRow; row <= lastRow; row++)
+	{
+		size_t spanCount = 0;
+
+		//! The segments starting on this row join the active list, the ones that ended leave it.
+		for(int i = gtStroke.rowHeads[row]; i >= 0; i = gtStroke.segments[i].next)
+			gtStroke.active[activeCount++] = gtStroke.segments + i;
+
+		size_t kept = 0;
+		for(size_t i = 0; i < activeCount; i++)
+		{
+			gtSegment* segment = gtStroke.active[i];
+			if(row > segment->bottom)
+				continue;
+			gtStroke.active[kept++] = segment;
+
+			float from, to;
+			if(!gtCapsuleSpan(segment, row, reach, &from, &to) || !(to >= area.left) || !(from <= area.right - 1))
+				continue;
+			int first = from < area.left ? area.left : (int)ceilf(from), last = to >= area.right ? area.right - 1 : (int)floorf(to);
+			if(first > last)
+				continue;
+
+			//! Hard strokes cover their whole span. Antialiased ones fully cover the pixels within radius - 0.5 of the segment, the edges around them are measured.
+			int innerFirst = first, innerLast = last;
+			if(gtStroke.antialias)
+			{
+				innerFirst = last + 1;
+				if(radius > 0.5f && gtCapsuleSpan(segment, row, radius - 0.5f, &from, &to))
+				{
+					innerFirst = from < first ? first : from > last ? last + 1 : (int)ceilf(from);
+					innerLast = to > last ? last : to < first ? first - 1 : (int)floorf(to);
+					if(innerFirst > innerLast)
+						innerFirst = last + 1;
+				}
+				if(innerFirst > last)
+					innerLast = last;
+			}
+
+			uint8_t full = (uint8_t)(fade * 255 + 0.5f);
+			uint8_t* coverage = gtStroke.coverage;
+			for(int x = first; x < innerFirst; x++)
+			{
+				uint8_t value = gtStrokeCoverage(segment, x, row, reach, fade);
+				if(value > coverage[x])
+					coverage[x] = value;
+			}
+			for(int x = innerFirst; x <= innerLast; x++)
+				if(full > coverage[x])
+					coverage[x] = full;
+			for(int x = innerLast + 1; x <= last; x++)
+			{
+				uint8_t value = gtStrokeCoverage(segment, x, row, reach, fade);
+				if(value > coverage[x])
+					coverage[x] = value;
+			}
+
+			//! The spans are kept sorted by their first column, a row only has a few of them.
+			size_t at = spanCount++;
+			for(; at && gtStroke.spans[2 * at - 2] > first; at--)
+			{
+				gtStroke.spans[2 * at] = gtStroke.spans[2 * at - 2];
+				gtStroke.spans[2 * at + 1] = gtStroke.spans[2 * at - 1];
+			}
+			gtStroke.spans[2 * at] = first;
+			gtStroke.spans[2 * at + 1] = last;
+		}
+		activeCount = kept;
+
+		for(size_t i = 0; i < spanCount; )
+		{
+			int left = gtStroke.spans[2 * i], right = gtStroke.spans[2 * i + 1];
+			for(i++; i < spanCount && gtStroke.spans[2 * i] <= right + 1; i++)
+				if(gtStroke.spans[2 * i + 1] > right)
+					right = gtStroke.spans[2 * i + 1];
+
+			gtStrokeRow(row, left, right, paint);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+// Triangle rasterization
+////////////////////////////////////////////////////////////
+
+//! The side of the square blocks the triangles are traversed in. Blocks entirely inside a triangle skip the edge tests.
+#ifndef GRAPHTE_TRIANGLE_BLOCK
+	#define GRAPHTE_TRIANGLE_BLOCK 8
+#endif
+
+//! The bits of the triangle vertex coordinates below the pixel. The edges are evaluated exactly in this fixed point.
+#define GRAPHTE_SUBPIXEL_BITS 4
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the formats of the depth buffer.
+ * 
+ * \details DEPTH_16 keeps 65536 depth levels per pixel, which is enough for a single object or a shallow scene, DEPTH_32 keeps a float per pixel.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	DEPTH_NONE = 0,
+	DEPTH_16 = 1,
+	DEPTH_32 = 2
+}
+depthFormat;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing a corner of a shaded triangle.
+ * 
+ * \details The position uses the same coordinates as vector2f, the depth goes from 0 (nearest) to 1 (farthest) and the color is interpolated
+ *          between the corners of the triangle.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	float x, y, z;
+	color fillColor;
+}
+vertex;
+
+//! The depth buffer attached to the back buffer, see setDepthBuffer().
+struct
+{
+	depthFormat format;
+	void* values; //! One value per pixel, width values per row: uint16_t for DEPTH_16, float for DEPTH_32.
+	uint16 width, height; //! The size of the values. It follows the back buffer when a triangle is drawn after a resize.
+}
+gtDepth;
+
+//! A value interpolated linearly across a triangle, base + x * stepX + y * stepY at the pixel (x, y).
+typedef struct
+{
+	float base, stepX, stepY;
+}
+gtPlane;
+
+//! A triangle prepared for gtShadeSpan().
+typedef struct
+{
+	BOOL flat; //! TRUE when the three corners have the same color, which is then drawn as it is.
+	BOOL depth; //! TRUE when the depth buffer is tested and written.
+	uint32_t paint; //! The premultiplied color of a flat triangle, see gtPaint().
+	gtPlane z;
+	gtPlane channels[4]; //! The transparency and the premultiplied red, green and blue of a smooth triangle, in the order of a pixel.
+}
+gtTriangle;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that sets every value of the depth buffer to the farthest depth.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtClearDepth()
+{
+	size_t count = (size_t)gtDepth.width * gtDepth.height;
+
+	if(gtDepth.format == DEPTH_16)
+		memset(gtDepth.values, 0xFF, count * sizeof(uint16_t));
+	else if(gtDepth.format == DEPTH_32)
+		for(size_t i = 0; i < count; i++)
+			((float*)gtDepth.values)[i] = 1;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that brings the depth buffer to the size of the back buffer.
+ * 
+ * \details A new depth buffer starts cleared. A failed allocation turns the depth test off.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  Returns TRUE if a depth buffer is in use.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtPrepareDepth()
+{
+	if(gtDepth.format == DEPTH_NONE)
+		return FALSE;
+
+	if(gtDepth.values && gtDepth.width == host.width && gtDepth.height == host.height)
+		return TRUE;
+
+	free(gtDepth.values);
+	gtDepth.values = malloc((size_t)host.width * host.height * (gtDepth.format == DEPTH_16 ? sizeof(uint16_t) : sizeof(float)));
+	if(!gtDepth.values)
+	{
+		gtDepth.format = DEPTH_NONE;
+		gtDepth.width = gtDepth.height = 0;
+		return FALSE;
+	}
+
+	gtDepth.width = host.width;
+	gtDepth.height = host.height;
+	gtClearDepth();
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds the plane through the values at the corners of a triangle.
+ * 
+ * \param[out]   plane        The plane.
+ * \param[in]    corners      The corners of the triangle.
+ * \param[in]    values       The value at every corner.
+ * \param[in]    inverseArea  1 over twice the signed area of the triangle.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtSetupPlane(gtPlane* plane, const vertex* corners, const float* values, float inverseArea)
+{
+	float dx1 = corners[1].x - corners[0].x, dy1 = corners[1].y - corners[0].y;
+	float dx2 = corners[2].x - corners[0].x, dy2 = corners[2].y - corners[0].y;
+	float dv1 = values[1] - values[0], dv2 = values[2] - values[0];
+
+	plane->stepX = (dv1 * dy2 - dv2 * dy1) * inverseArea;
+	plane->stepY = (dv2 * dx1 - dv1 * dx2) * inverseArea;
+	plane->base = values[0] - corners[0].x * plane->stepX - corners[0].y * plane->stepY;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws the pixels of a row inside a triangle.
+ * 
+ * \details Flat triangles without depth go through the row kernels. The others interpolate their depth and colors along the row,
+ *          test and write the depth buffer, and blend every pixel that is not opaque.
+ * 
+ * \param[in]    triangle  The prepared triangle.
+ * \param[in]    y         The row.
+ * \param[in]    left      The first column inside the triangle.
+ * \param[in]    right     The last column inside the triangle.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtShadeSpan(const gtTriangle* triangle, int y, int left, int right)
+{
+	uint32_t* destination = host.pixels + (size_t)y * host.stride;
+	BOOL opaque = gtOpaque(triangle->paint);
+
+	if(triangle->flat && !triangle->depth)
+	{
+		if(opaque)
+			gtKernels.fillRow(destination + left, right - left + 1, triangle->paint);
+		else
+			gtKernels.blendRow(destination + left, right - left + 1, triangle->paint, gtBlend.mode);
+		return;
+	}
+
+	float z = triangle->z.base + left * triangle->z.stepX + y * triangle->z.stepY, channels[4];
+	for(int i = 0; i < 4; i++)
+		channels[i] = triangle->channels[i].base + left * triangle->channels[i].stepX + y * triangle->channels[i].stepY;
+
+	for(int x = left; x <= right; x++)
+	{
+		BOOL visible = TRUE;
+
+		if(triangle->depth)
+		{
+			size_t index = (size_t)y * gtDepth.width + x;
+			if(gtDepth.format == DEPTH_16)
+			{
+				uint16_t depth = z <= 0 ? 0 : z >= 1 ? 65535 : (uint16_t)(z * 65535 + 0.5f);
+				visible = depth < ((uint16_t*)gtDepth.values)[index];
+				if(visible)
+					((uint16_t*)gtDepth.values)[index] = depth;
+			}
+			else
+			{
+				visible = z < ((float*)gtDepth.values)[index];
+				if(visible)
+					((float*)gtDepth.values)[index] = z;
+			}
+		}
+
+		if(visible && triangle->flat)
+			destination[x] = opaque ? triangle->paint : gtBlendPixel(destination[x], triangle->paint, gtBlend.mode);
+		else if(visible)
+		{
+			uint32_t value = 0;
+			for(int i = 0; i < 4; i++)
+				value = value << 8 | (channels[i] <= 0 ? 0 : channels[i] >= 255 ? 255 : (uint32_t)(channels[i] + 0.5f));
+			destination[x] = gtOpaque(value) ? value : gtBlendPixel(destination[x], value, gtBlend.mode);
+		}
+
+		z += triangle->z.stepX;
+		for(int i = 0; i < 4; i++)
+			channels[i] += triangle->channels[i].stepX;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that rasterizes a triangle into the back buffer.
+ * 
+ * \details The corners are snapped to GRAPHTE_SUBPIXEL_BITS of precision, and a pixel is drawn when its center is inside all three edges,
+ *          evaluated exactly in integers. Pixels on an edge belong to one side only, so triangles sharing an edge neither overlap nor leave gaps.
+ *          The bounding box is traversed in GRAPHTE_TRIANGLE_BLOCK square blocks, which keeps the depth buffer and canvas accesses close together.
+ *          The edges are evaluated at the corners of every block: blocks outside of an edge are skipped, blocks inside all of them are drawn
+ *          without testing a pixel, and only the blocks crossed by an edge find the span of every row.
+ * 
+ * \param[in]    corners  The corners of the triangle, in any winding order.
+ * \param[in]    useDepth TRUE to test and write the depth buffer.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtRasterTriangle(vertex* corners, BOOL useDepth)
+{
+	const int64_t one = 1 << GRAPHTE_SUBPIXEL_BITS;
+	int64_t x[3], y[3];
+	gtTriangle triangle;
+
+	//! Far corners would overflow the fixed point edges, such triangles are dropped.
+	for(int i = 0; i < 3; i++)
+	{
+		if(!(fabsf(corners[i].x) < 1 << 22) || !(fabsf(corners[i].y) < 1 << 22))
+			return;
+		x[i] = llroundf(corners[i].x * one);
+		y[i] = llroundf(corners[i].y * one);
+	}
+
+	int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if(!area)
+		return;
+
+	//! The corners are put in the winding where the inside of every edge is positive.
+	if(area < 0)
+	{
+		vertex corner = corners[1]; corners[1] = corners[2]; corners[2] = corner;
+		int64_t swap = x[1]; x[1] = x[2]; x[2] = swap;
+		swap = y[1]; y[1] = y[2]; y[2] = swap;
+		area = -area;
+	}
+
+	int64_t minX = x[0] < x[1] ? (x[0] < x[2] ? x[0] : x[2]) : (x[1] < x[2] ? x[1] : x[2]);
+	int64_t minY = y[0] < y[1] ? (y[0] < y[2] ? y[0] : y[2]) : (y[1] < y[2] ? y[1] : y[2]);
+	int64_t maxX = x[0] > x[1] ? (x[0] > x[2] ? x[0] : x[2]) : (x[1] > x[2] ? x[1] : x[2]);
+	int64_t maxY = y[0] > y[1] ? (y[0] > y[2] ? y[0] : y[2]) : (y[1] > y[2] ? y[1] : y[2]);
+	gtRect bounds = gtDrawArea();
+	int left = minX <= (int64_t)bounds.left << GRAPHTE_SUBPIXEL_BITS ? bounds.left : (int)((minX + one - 1) >> GRAPHTE_SUBPIXEL_BITS);
+	int top = minY <= (int64_t)bounds.top << GRAPHTE_SUBPIXEL_BITS ? bounds.top : (int)((minY + one - 1) >> GRAPHTE_SUBPIXEL_BITS);
+	int right = maxX < (int64_t)bounds.left << GRAPHTE_SUBPIXEL_BITS ? bounds.left - 1 : maxX >= (int64_t)bounds.right << GRAPHTE_SUBPIXEL_BITS ? bounds.right - 1 : (int)(maxX >> GRAPHTE_SUBPIXEL_BITS);
+	int bottom = maxY < (int64_t)bounds.top << GRAPHTE_SUBPIXEL_BITS ? bounds.top - 1 : maxY >= (int64_t)bounds.bottom << GRAPHTE_SUBPIXEL_BITS ? bounds.bottom - 1 : (int)(maxY >> GRAPHTE_SUBPIXEL_BITS);
+	if(left > right || top > bottom)
+		return;
+
+	//! The tiles of drawCommands() are damaged before the threads draw them.
+	if(!gtTile.active)
+		gtAddDamage(left, top, right + 1, bottom + 1);
+#ifdef GRAPHTE_BACKEND_GDI
+	//! The canvas bits are written directly, pending GDI drawing has to land first.
+	if(!host.pixelsLocked)
+		GdiFlush();
+#endif
+
+	triangle.depth = useDepth && gtPrepareDepth();
+	triangle.paint = gtPaint(corners[0].fillColor);
+	triangle.flat = triangle.paint == gtPaint(corners[1].fillColor) && triangle.paint == gtPaint(corners[2].fillColor);
+	memset(&triangle.z, 0, sizeof(triangle.z));
+	memset(triangle.channels, 0, sizeof(triangle.channels));
+
+	//! The planes use the snapped corners, so that the values match the pixels the edges select.
+	vertex snapped[3];
+	for(int i = 0; i < 3; i++)
+	{
+		snapped[i].x = (float)x[i] / one;
+		snapped[i].y = (float)y[i] / one;
+	}
+	float inverseArea = (float)(one * one) / area;
+	if(triangle.depth)
+	{
+		float depths[3] = {corners[0].z, corners[1].z, corners[2].z};
+		gtSetupPlane(&triangle.z, snapped, depths, inverseArea);
+	}
+	if(!triangle.flat)
+	{
+		uint32_t paints[3] = {triangle.paint, gtPaint(corners[1].fillColor), gtPaint(corners[2].fillColor)};
+		for(int i = 0; i < 4; i++)
+		{
+			int shift = 24 - 8 * i;
+			float channel[3] = {(float)(paints[0] >> shift & 0xFF), (float)(paints[1] >> shift & 0xFF), (float)(paints[2] >> shift & 0xFF)};
+			gtSetupPlane(triangle.channels + i, snapped, channel, inverseArea);
+		}
+	}
+
+	//! Every edge is a linear function of the pixel, positive inside. Edges that are not top or left edges exclude their own pixels.
+	int64_t edgeX[3], edgeY[3], edgeBase[3];
+	for(int i = 0; i < 3; i++)
+	{
+		int from = (i + 1) % 3, to = (i + 2) % 3;
+		int64_t dx = x[to] - x[from], dy = y[to] - y[from];
+		edgeX[i] = -dy * one;
+		edgeY[i] = dx * one;
+		edgeBase[i] = dy * x[from] - dx * y[from] - (dy > 0 || (dy == 0 && dx < 0) ? 0 : 1);
+	}
+
+	for(int blockY = top - top % GRAPHTE_TRIANGLE_BLOCK; blockY <= bottom; blockY += GRAPHTE_TRIANGLE_BLOCK)
+	{
+		int rowFirst = blockY < top ? top : blockY;
+		int rowLast = blockY + GRAPHTE_TRIANGLE_BLOCK - 1 > bottom ? bottom : blockY + GRAPHTE_TRIANGLE_BLOCK - 1;
+
+		for(int blockX = left - left % GRAPHTE_TRIANGLE_BLOCK; blockX <= right; blockX += GRAPHTE_TRIANGLE_BLOCK)
+		{
+			int columnFirst = blockX < left ? left : blockX;
+			int columnLast = blockX + GRAPHTE_TRIANGLE_BLOCK - 1 > right ? right : blockX + GRAPHTE_TRIANGLE_BLOCK - 1;
+			BOOL outside = FALSE, inside = TRUE;
+			int64_t start[3];
+
+			//! A linear function over a rectangle has its extremes at the corners.
+			for(int i = 0; i < 3 && !outside; i++)
+			{
+				int64_t corner = edgeBase[i] + edgeX[i] * columnFirst + edgeY[i] * rowFirst;
+				int64_t acrossX = edgeX[i] * (columnLast - columnFirst), acrossY = edgeY[i] * (rowLast - rowFirst);
+				int64_t lowest = corner + (acrossX < 0 ? acrossX : 0) + (acrossY < 0 ? acrossY : 0);
+				int64_t highest = corner + (acrossX > 0 ? acrossX : 0) + (acrossY > 0 ? acrossY : 0);
+
+				outside = highest < 0;
+				inside = inside && lowest >= 0;
+				start[i] = corner;
+			}
+			if(outside)
+				continue;
+
+			for(int row = rowFirst; row <= rowLast; row++)
+			{
+				int first = columnFirst, last = columnLast;
+
+				if(!inside)
+				{
+					int64_t edge[3] = {start[0], start[1], start[2]};
+					first = columnLast + 1;
+					last = columnFirst - 1;
+					for(int column = columnFirst; column <= columnLast; column++)
+					{
+						if(edge[0] >= 0 && edge[1] >= 0 && edge[2] >= 0)
+						{
+							if(first > columnLast)
+								first = column;
+							last = column;
+						}
+						for(int i = 0; i < 3; i++)
+							edge[i] += edgeX[i];
+					}
+					for(int i = 0; i < 3; i++)
+						start[i] += edgeY[i];
+				}
+
+				//! The inside of a triangle is convex, the pixels of a row inside it are a single span.
+				if(first <= last)
+					gtShadeSpan(&triangle, row, first, last);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+// Command recording
+////////////////////////////////////////////////////////////
+
+//! The number of command buffers that can exist at the same time.
+#ifndef GRAPHTE_COMMAND_BUFFERS
+	#define GRAPHTE_COMMAND_BUFFERS 16
+#endif
+
+//! The drawing functions a command buffer records.
+typedef enum
+{
+	COMMAND_RECT,
+	COMMAND_LINE,
+	COMMAND_POLYLINE,
+	COMMAND_ELLIPSE,
+	COMMAND_TRIANGLE,
+	COMMAND_SHADED_TRIANGLE,
+	COMMAND_TEXTURE,
+	COMMAND_IMAGE,
+	COMMAND_SPRITES,
+	COMMAND_TEXT
+}
+gtCommandType;
+
+//! The header of a recorded command, its arguments follow it in the stream.
+typedef struct
+{
+	uint8_t type; //! The gtCommandType.
+	uint8_t mode; //! The blend mode, opacity and antialiasing in effect when the command was recorded.
+	uint8_t opacity;
+	uint8_t antialias;
+	uint32_t size; //! The size of the command, header and arguments, a multiple of 8 bytes.
+	uint64_t key; //! The state the command draws with: its type, the blend state, then its color or image. sortCommands() groups equal keys.
+	int left, top, right, bottom; //! The rectangle the command can draw in, right and bottom excluded.
+}
+gtCommand;
+
+//! The arguments of the recorded commands. Text, paths and sprites are stored after their fixed part.
+typedef struct
+{
+	int16 x, y;
+	uint16 width, height;
+	color fillColor;
+}
+gtRectCommand;
+
+typedef struct
+{
+	int16 x1, y1, x2, y2;
+	uint16 width;
+	color fillColor;
+}
+gtLineCommand;
+
+typedef struct
+{
+	uint16 count;
+	float width;
+	color fillColor;
+}
+gtPolylineCommand;
+
+typedef struct
+{
+	vertex corners[3];
+}
+gtTriangleCommand;
+
+typedef struct
+{
+	int16 x, y;
+	int16 handle;
+	BOOL transparent;
+	color transparentColor;
+}
+gtTextureCommand;
+
+typedef struct
+{
+	int16 x, y;
+	uint16 width, height;
+	BOOL transparent;
+	color transparentColor;
+}
+gtImageCommand;
+
+typedef struct
+{
+	int16 atlas;
+	uint16 count;
+}
+gtSpritesCommand;
+
+typedef struct
+{
+	int16 x, y;
+	uint16 width, height;
+	BOOL clip;
+	uint16 size;
+	color fillColor;
+}
+gtTextCommand;
+
+//! A command buffer: a stream of commands in a single growing block of memory, kept between recordings.
+typedef struct
+{
+	char* bytes;
+	size_t size, capacity;
+	uint32_t count;
+	BOOL used; //! FALSE for a free slot.
+}
+gtCommandBuffer;
+
+//! The command buffers and the one being recorded.
+struct
+{
+	gtCommandBuffer entries[GRAPHTE_COMMAND_BUFFERS];
+	gtCommandBuffer* recording; //! NULL when the drawing functions draw right away.
+}
+gtCommands;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that appends a command to the buffer being recorded.
+ * 
+ * \details The header gets the current blend state, which the command is replayed with. The caller fills in the arguments.
+ * 
+ * \param[in]    type    The command type.
+ * \param[in]    left    The left edge of the rectangle the command can draw in.
+ * \param[in]    top     The top edge of that rectangle.
+ * \param[in]    right   The right edge of that rectangle, excluded.
+ * \param[in]    bottom  The bottom edge of that rectangle, excluded.
+ * \param[in]    value   The color or image the command draws with, the low part of its sort key.
+ * \param[in]    size    The size of the arguments.
+ * 
+ * \return       Returns the arguments to fill in, or NULL if the buffer could not grow.
+ */
+////////////////////////////////////////////////////////////
+void* gtRecord(gtCommandType type, int left, int top, int right, int bottom, uint32_t value, size_t size)
+{
+	gtCommandBuffer* buffer = gtCommands.recording;
+	size_t total = (sizeof(gtCommand) + size + 7) & ~(size_t)7;
+
+	if(buffer->size + total > buffer->capacity)
+	{
+		size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+		while(capacity < buffer->size + total)
+			capacity *= 2;
+
+		char* bytes = (char*)realloc(buffer->bytes, capacity);
+		if(!bytes)
+			return NULL;
+		buffer->bytes = bytes;
+		buffer->capacity = capacity;
+	}
+
+	gtCommand* command = (gtCommand*)(buffer->bytes + buffer->size);
+	command->type = type;
+	command->mode = gtBlend.mode;
+	command->opacity = gtBlend.opacity;
+	command->antialias = gtStroke.antialias ? 1 : 0;
+	command->size = total;
+	command->key = (uint64_t)type << 56 | (uint64_t)command->mode << 48 | (uint64_t)command->opacity << 40 | (uint64_t)command->antialias << 32 | value;
+	command->left = left;
+	command->top = top;
+	command->right = right;
+	command->bottom = bottom;
+
+	buffer->size += total;
+	buffer->count++;
+	return command + 1;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that records a triangle() or shadedTriangle() call.
+ * 
+ * \param[in]    type     COMMAND_TRIANGLE or COMMAND_SHADED_TRIANGLE.
+ * \param[in]    corners  The corners of the triangle.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtRecordTriangle(gtCommandType type, const vertex* corners)
+{
+	float bounds[4] = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+
+	for(int i = 0; i < 3; i++)
+	{
+		if(corners[i].x < bounds[0]) bounds[0] = corners[i].x;
+		if(corners[i].y < bounds[1]) bounds[1] = corners[i].y;
+		if(corners[i].x > bounds[2]) bounds[2] = corners[i].x;
+		if(corners[i].y > bounds[3]) bounds[3] = corners[i].y;
+	}
+
+	gtTriangleCommand* command = (gtTriangleCommand*)gtRecord(type, (int)fmaxf(floorf(bounds[0]), -65536), (int)fmaxf(floorf(bounds[1]), -65536),
+		(int)fminf(ceilf(bounds[2]) + 1, 65536), (int)fminf(ceilf(bounds[3]) + 1, 65536), gtPaint(corners[0].fillColor), sizeof(gtTriangleCommand));
+	if(command)
+		memcpy(command->corners, corners, sizeof(command->corners));
+}
+
+////////////////////////////////////////////////////////////
+// File mapping
+////////////////////////////////////////////////////////////
+
+//! A file mapped read-only into memory, see gtMapFile().
+typedef struct
+{
+	const unsigned char* data; //! The content of the file, NULL when nothing is mapped.
+	size_t size;
+}
+gtMappedFile;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that maps a file read-only into memory.
+ * 
+ * \details The pages are read from the file on first access, so nothing is copied until the content is used. The file handles are closed
+ *          right away, the mapping stays valid until gtUnmapFile().
+ * 
+ * \param[in]    filename  The path of the file.
+ * \param[out]   file      Receives the mapping.
+ * 
+ * \return       Returns TRUE if the file was mapped and FALSE if it could not be opened or is empty.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtMapFile(const char* filename, gtMappedFile* file)
+{
+	file->data = NULL;
+	file->size = 0;
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(handle == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	LARGE_INTEGER size;
+	if(GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping)
+		{
+			file->data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			file->size = (size_t)size.QuadPart;
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(handle);
+#else
+	int descriptor = open(filename, O_RDONLY);
+	if(descriptor < 0)
+		return FALSE;
+
+	struct stat info;
+	if(fstat(descriptor, &info) == 0 && info.st_size > 0)
+	{
+		void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if(data != MAP_FAILED)
+		{
+			file->data = (const unsigned char*)data;
+			file->size = (size_t)info.st_size;
+		}
+	}
+	close(descriptor);
+#endif
+
+	return file->data != NULL;
+}
+
+//! Releases a mapping made by gtMapFile(), nothing happens when nothing is mapped.
+void gtUnmapFile(gtMappedFile* file)
+{
+	if(!file->data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(file->data);
+#else
+	munmap((void*)file->data, file->size);
+#endif
+	file->data = NULL;
+	file->size = 0;
+}
+
+#ifdef GRAPHTE_SOFTWARE
+////////////////////////////////////////////////////////////
+// Software rasterization
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that fills an ellipse into the back buffer.
+ * 
+ * \details Every row is a single span whose half-width follows the ellipse equation at the row center. Only the rows of the drawing area are visited.
+ * 
+ * \param[in]    x       The x-coordinate of the bounding rectangle's upper-left corner.
+ * \param[in]    y       The y-coordinate of the bounding rectangle's upper-left corner.
+ * \param[in]    width   The width of the bounding rectangle.
+ * \param[in]    height  The height of the bounding rectangle.
+ * \param[in]    paint   The premultiplied value, see gtPaint().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtRasterEllipse(int x, int y, int width, int height, uint32_t paint)
+{
+	gtRect area = gtDrawArea();
+	double radiusX = width / 2.0, radiusY = height / 2.0;
+	double centerX = x + radiusX, centerY = y + radiusY;
+
+	if(width <= 0 || height <= 0)
+		return;
+
+	for(int row = y > area.top ? y : area.top; row < y + height && row < area.bottom; row++)
+	{
+		double dy = (row + 0.5 - centerY) / radiusY;
+		double halfWidth = radiusX * sqrt(1.0 - dy * dy);
+		gtPaintRect((int)floor(centerX - halfWidth + 0.5), row, (int)floor(centerX + halfWidth + 0.5), row + 1, paint);
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that copies a pixel array into the back buffer.
+ * 
+ * \details This function clips the destination rectangle to the buffer and copies the matching source pixels. When keyed is set,
+ *          every source pixel equal to keyValue is skipped, the same way TransparentBlt() treats its transparent color.
+ *          The rows go through the copy kernels selected for the processor. Translucent sources, an opacity below 255 and the additive and
+ *          multiply modes go through the blending kernels instead, see setBlendMode().
+ * 
+ * \param[in]    x            The x-coordinate of the destination's upper-left corner.
+ * \param[in]    y            The y-coordinate of the destination's upper-left corner.
+ * \param[in]    width        The width of the copied area.
+ * \param[in]    height       The height of the copied area.
+ * \param[in]    source       The first pixel of the source array, premultiplied (see gtPaint()).
+ * \param[in]    srcStride    The distance, in pixels, between two source rows.
+ * \param[in]    translucent  TRUE if some source pixels are not opaque.
+ * \param[in]    keyed        TRUE if pixels matching keyValue must be skipped.
+ * \param[in]    keyValue   The packed transparent color.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtBlit(int x, int y, int width, int height, const uint32_t* source, int srcStride, BOOL translucent, BOOL keyed, uint32_t keyValue)
+{
+	int srcX = 0, srcY = 0;
+
+	if(x < 0) { srcX = -x; width += x; x = 0; }
+	if(y < 0) { srcY = -y; height += y; y = 0; }
+	if(x + width > host.width) width = host.width - x;
+	if(y + height > host.height) height = host.height - y;
+	if(width <= 0 || height <= 0)
+		return;
+
+	BOOL blended = translucent || gtBlend.opacity < 255 || gtBlend.mode != BLEND_ALPHA;
+
+	for(int row = 0; row < height; row++)
+	{
+		const uint32_t* src = source + (size_t)(srcY + row) * srcStride + srcX;
+		uint32_t* dst = host.pixels + (size_t)(y + row) * host.stride + x;
+
+		if(blended && keyed)
+		{
+			//! The keyed pixels are made fully transparent in a copy of the row, which is blended a piece at a time.
+			uint32_t piece[256];
+			for(int start = 0; start < width; start += 256)
+			{
+				int count = width - start < 256 ? width - start : 256;
+				for(int i = 0; i < count; i++)
+					piece[i] = (src[start + i] & 0xFFFFFF) == keyValue ? 0xFF000000 : src[start + i];
+				gtKernels.blendCopyRow(dst + start, piece, count, gtBlend.opacity, gtBlend.mode);
+			}
+		}
+		else if(blended)
+			gtKernels.blendCopyRow(dst, src, width, gtBlend.opacity, gtBlend.mode);
+		else if(keyed)
+			gtKernels.keyRow(dst, src, width, keyValue);
+		else
+			gtKernels.copyRow(dst, src, width);
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads a bitmap file into a pixel array.
+ * 
+ * \details This function decodes an uncompressed 8, 24 or 32-bit BMP file (bottom-up or top-down) and resamples it, using the nearest pixel,
+ *          to the requested size. A width or height of 0 keeps the size stored in the file, like LoadImageA() does.
+ *          The fourth byte of a 32-bit pixel is its alpha, unless it is 0 for the whole file, the way images without alpha are usually saved.
+ *          Translucent pixels are premultiplied, see gtPaint().
+ *          The file is mapped instead of read. Rows kept at their width are converted by the bgrRow kernel (24-bit) or copied (32-bit without alpha),
+ *          and a row sampled again when the image is stretched vertically is copied from the row above.
+ *          A top-down 32-bit file without alpha, kept at its size, already holds the pixels in memory order: when its pixel data is aligned
+ *          to 4 bytes, the returned array points into the mapping, which is handed to the caller instead of being released.
+ * 
+ * \note    The returned array must be released with free(), or with gtUnmapFile() when the mapping has been handed over.
+ * 
+ * \param[in]    filename  The path of the bitmap file.
+ * \param[in]    width     The width of the resulting pixel array.
+ * \param[in]    height    The height of the resulting pixel array.
+ * \param[out]   outWidth  Receives the width of the resulting pixel array.
+ * \param[out]   outHeight Receives the height of the resulting pixel array.
+ * \param[out]   outTranslucent Receives TRUE if some pixels are not opaque.
+ * \param[out]   outMapping Receives the mapping the pixel array points into, or an empty mapping when the array was allocated.
+ * 
+ * \return       Returns the packed pixels or NULL if the file could not be decoded.
+ */
+////////////////////////////////////////////////////////////
+uint32_t* gtLoadBitmap(const char* filename, uint16 width, uint16 height, uint16* outWidth, uint16* outHeight, BOOL* outTranslucent, gtMappedFile* outMapping)
+{
+	gtMappedFile file;
+	outMapping->data = NULL;
+	outMapping->size = 0;
+	if(!gtMapFile(filename, &file))
+		return NULL;
+
+	const unsigned char* header = file.data;
+	if(file.size < 54 || header[0] != 'B' || header[1] != 'M')
+	{
+		gtUnmapFile(&file);
+		return NULL;
+	}
+
+	uint32_t dataOffset = header[10] | header[11] << 8 | header[12] << 16 | (uint32_t)header[13] << 24;
+	uint32_t infoSize = header[14] | header[15] << 8 | header[16] << 16 | (uint32_t)header[17] << 24;
+	int32_t fileWidth = (int32_t)(header[18] | header[19] << 8 | header[20] << 16 | (uint32_t)header[21] << 24);
+	int32_t fileHeight = (int32_t)(header[22] | header[23] << 8 | header[24] << 16 | (uint32_t)header[25] << 24);
+	uint16 bitCount = header[28] | header[29] << 8;
+	uint32_t compression = header[30] | header[31] << 8 | header[32] << 16 | (uint32_t)header[33] << 24;
+	uint32_t paletteSize = header[46] | header[47] << 8 | header[48] << 16 | (uint32_t)header[49] << 24;
+
+	BOOL topDown = fileHeight < 0;
+	if(topDown)
+		fileHeight = -fileHeight;
+
+	//! Only uncompressed (or 32-bit bitfield) layouts are supported, and every row has to be inside the file.
+	size_t rowSize = ((size_t)fileWidth * bitCount / 8 + 3) & ~(size_t)3;
+	if(fileWidth <= 0 || fileHeight <= 0 || (bitCount != 8 && bitCount != 24 && bitCount != 32) || (compression != 0 && !(compression == 3 && bitCount == 32))
+		|| dataOffset > file.size || rowSize * fileHeight > file.size - dataOffset)
+	{
+		gtUnmapFile(&file);
+		return NULL;
+	}
+
+	uint32_t palette[256] = {0};
+	if(bitCount == 8)
+	{
+		if(!paletteSize || paletteSize > 256)
+			paletteSize = 256;
+
+		size_t paletteOffset = (size_t)14 + infoSize;
+		size_t count = paletteOffset < file.size ? (file.size - paletteOffset) / 4 : 0;
+		if(count > paletteSize)
+			count = paletteSize;
+		const unsigned char* entries = file.data + paletteOffset;
+		for(size_t i = 0; i < count; i++)
+			palette[i] = (uint32_t)entries[i * 4 + 2] << 16 | entries[i * 4 + 1] << 8 | entries[i * 4];
+	}
+
+	const unsigned char* data = file.data + dataOffset;
+
+	if(!width)
+		width = fileWidth;
+	if(!height)
+		height = fileHeight;
+
+	BOOL hasAlpha = FALSE, translucent = FALSE;
+	if(bitCount == 32)
+		for(size_t i = 3; i < rowSize * fileHeight && !hasAlpha; i += 4)
+			hasAlpha = data[i] != 0;
+
+	*outWidth = width;
+	*outHeight = height;
+	*outTranslucent = FALSE;
+	if(bitCount == 32 && !hasAlpha && topDown && width == fileWidth && height == fileHeight && !((uintptr_t)data % sizeof(uint32_t)))
+	{
+		*outMapping = file;
+		return (uint32_t*)data;
+	}
+
+	uint32_t* pixels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+	if(pixels)
+	{
+		int previousY = -1;
+		for(int y = 0; y < height; y++)
+		{
+			int fileY = (int)((int64_t)y * fileHeight / height);
+			const unsigned char* row = data + rowSize * (topDown ? fileY : fileHeight - 1 - fileY);
+			uint32_t* destination = pixels + (size_t)y * width;
+
+			if(fileY == previousY)
+			{
+				memcpy(destination, destination - width, width * sizeof(uint32_t));
+				continue;
+			}
+			previousY = fileY;
+
+			if(width == fileWidth && bitCount == 24)
+			{
+				gtKernels.bgrRow(destination, row, width);
+				continue;
+			}
+			if(width == fileWidth && bitCount == 32 && !hasAlpha)
+			{
+				memcpy(destination, row, width * sizeof(uint32_t));
+				continue;
+			}
+
+			for(int x = 0; x < width; x++)
+			{
+				int fileX = (int)((int64_t)x * fileWidth / width);
+				const unsigned char* source = row + (size_t)fileX * bitCount / 8;
+
+				if(bitCount == 8)
+					destination[x] = palette[source[0]];
+				else if(hasAlpha && source[3] < 255)
+				{
+					uint32_t alpha = source[3];
+					destination[x] = (255 - alpha) << 24 | gtDiv255(source[2] * alpha) << 16 | gtDiv255(source[1] * alpha) << 8 | gtDiv255(source[0] * alpha);
+					translucent = TRUE;
+				}
+				else
+					destination[x] = (uint32_t)source[2] << 16 | source[1] << 8 | source[0];
+			}
+		}
+
+		*outTranslucent = translucent;
+	}
+
+	gtUnmapFile(&file);
+	return pixels;
+}
+
+#endif
+
+#ifdef GRAPHTE_BACKEND_TERMINAL
+////////////////////////////////////////////////////////////
+// Terminal output
+////////////////////////////////////////////////////////////
+
+//! Set by the SIGWINCH handler when the terminal has been resized.
+volatile sig_atomic_t gtTerminalResized = 0;
+
+//! A pipe releaseHost() writes to in order to end the input reader thread.
+int gtTerminalWake[2] = {-1, -1};
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that writes a whole buffer to the terminal.
+ * 
+ * \details This function retries partial and interrupted writes until every byte has been handed to the tty.
+ * 
+ * \param[in]    data  The bytes to be written.
+ * \param[in]    size  The number of bytes to be written.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalWrite(const char* data, size_t size)
+{
+	while(size)
+	{
+		ssize_t written = write(STDOUT_FILENO, data, size);
+		if(written < 0)
+		{
+			if(errno == EINTR || errno == EAGAIN)
+				continue;
+			return;
+		}
+
+		data += written;
+		size -= written;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that puts the terminal back into the state it had before initHost().
+ * 
+ * \details This function leaves the alternate screen, shows the cursor, resets the colors and restores the saved line discipline.
+ *          Only async-signal-safe calls are used, so it is also run from the termination signal handlers.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalRestore()
+{
+	static const char sequence[] = "\x1b[0m\x1b[?1003l\x1b[?1006l\x1b[?25h\x1b[?1049l";
+
+	if(!host.terminalActive)
+		return;
+
+	host.terminalActive = FALSE;
+	gtTerminalWrite(sequence, sizeof(sequence) - 1);
+	tcsetattr(STDIN_FILENO, TCSAFLUSH, &host.savedMode);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that handles the signals the terminal backend subscribes to.
+ * 
+ * \details SIGWINCH only flags the resize for the next display() call, which waits for the size to settle. Termination signals restore the terminal before the program exits.
+ * 
+ * \param[in]    signalNumber  The number of the received signal.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalSignal(int signalNumber)
+{
+	if(signalNumber == SIGWINCH)
+	{
+		gtTerminalResized = 1;
+		return;
+	}
+
+	gtTerminalRestore();
+	_exit(128 + signalNumber);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that maps the pixel buffer onto the terminal cells.
+ * 
+ * \details This function reads the terminal size and computes, for every cell column and every half cell row, the buffer column and row it samples.
+ *          The buffer is scaled uniformly to fit the terminal (two pixels per cell, one above the other) and centered, the remaining cells stay black.
+ *          Every cell is invalidated so the next display() redraws the whole screen.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalLayout()
+{
+	struct winsize size;
+	static const char clear[] = "\x1b[0m\x1b[2J";
+
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) || !size.ws_col || !size.ws_row)
+	{
+		size.ws_col = 80;
+		size.ws_row = 24;
+	}
+
+	host.columns = size.ws_col;
+	host.rows = size.ws_row;
+
+	free(host.cells);
+	free(host.sampleX);
+	free(host.sampleY);
+	host.cells = (uint64_t*)malloc((size_t)host.columns * host.rows * sizeof(uint64_t));
+	host.sampleX = (int*)malloc(host.columns * sizeof(int));
+	host.sampleY = (int*)malloc(host.rows * 2 * sizeof(int));
+
+	//! An impossible color pair forces every cell to be written again.
+	for(size_t i = 0; i < (size_t)host.columns * host.rows; i++)
+		host.cells[i] = UINT64_MAX;
+
+	double scale = fmin((double)host.columns / host.width, (double)host.rows * 2 / host.height);
+	int usedColumns = (int)(host.width * scale), usedRows = (int)(host.height * scale);
+	int left = (host.columns - usedColumns) / 2, top = (host.rows * 2 - usedRows) / 2;
+
+	for(int column = 0; column < host.columns; column++)
+		host.sampleX[column] = column >= left && column < left + usedColumns ? (int)((int64_t)(column - left) * host.width / usedColumns) : -1;
+	for(int row = 0; row < host.rows * 2; row++)
+		host.sampleY[row] = row >= top && row < top + usedRows ? (int)((int64_t)(row - top) * host.height / usedRows) : -1;
+
+	host.layoutWidth = host.width;
+	host.layoutHeight = host.height;
+	gtTerminalResized = 0;
+
+	gtTerminalWrite(clear, sizeof(clear) - 1);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that appends an SGR truecolor parameter to the output buffer.
+ * 
+ * \details This function writes "38;2;R;G;B" (foreground) or "48;2;R;G;B" (background) without going through printf.
+ * 
+ * \param[in]    out    The position in the output buffer.
+ * \param[in]    layer  38 for the foreground, 48 for the background.
+ * \param[in]    value  The packed 0x00RRGGBB color.
+ * 
+ * \return       Returns the position after the appended text.
+ */
+////////////////////////////////////////////////////////////
+char* gtTerminalColor(char* out, int layer, uint32_t value)
+{
+	unsigned int components[3] = {value >> 16 & 0xFF, value >> 8 & 0xFF, value & 0xFF};
+
+	*out++ = '0' + layer / 10;
+	*out++ = '8';
+	*out++ = ';';
+	*out++ = '2';
+	for(int i = 0; i < 3; i++)
+	{
+		*out++ = ';';
+		if(components[i] >= 100)
+			*out++ = '0' + components[i] / 100;
+		if(components[i] >= 10)
+			*out++ = '0' + components[i] / 10 % 10;
+		*out++ = '0' + components[i] % 10;
+	}
+
+	return out;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that keeps the cell layout in step with the terminal and the canvas before a frame is presented.
+ * 
+ * \details This function runs on the drawing thread, since the layout is also read by the input handling. While the terminal is being resized the frame
+ *          is held, nothing is written. The layout is computed once the size has settled for GRAPHTE_RESIZE_DEBOUNCE milliseconds, or when the canvas
+ *          size changed, and the frame is then presented in full. The present thread is left to finish its frame before the layout changes.
+ * 
+ * \param[in,out] frame  The frame about to be presented.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalFollowSize(gtFrame* frame)
+{
+	if(gtTerminalResized)
+	{
+		gtTerminalResized = 0;
+		host.resizePending = TRUE;
+		host.resizeTime = gtMilliseconds();
+	}
+	if(host.resizePending)
+	{
+		if(gtMilliseconds() - host.resizeTime < GRAPHTE_RESIZE_DEBOUNCE)
+		{
+			frame->hold = TRUE;
+			return;
+		}
+
+		host.resizePending = FALSE;
+		gtWaitPresenter();
+		gtTerminalLayout();
+		if(host.resizeCallback)
+			host.resizeCallback(host.columns, host.rows * 2);
+		frame->full = TRUE;
+	}
+	else if(host.layoutWidth != frame->width || host.layoutHeight != frame->height)
+	{
+		gtWaitPresenter();
+		gtTerminalLayout();
+		frame->full = TRUE;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a frame on the terminal.
+ * 
+ * \details This function samples two pixels for every cell covered by the damage of the frame and compares them with the colors the cell already shows.
+ *          Only changed cells are written, as an upper half block with the top pixel as the foreground and the bottom pixel as the background color.
+ *          Cursor moves and color changes are only emitted when needed and the whole frame goes out in a single write, so both the work and the output
+ *          grow with the changed area, not with the window size.
+ *          It only reads the layout computed by gtTerminalFollowSize(), so it can run on the present thread.
+ * 
+ * \param[in]    frame  The frame to be presented.
+ * \param[in]    full   TRUE to compare every cell instead of only the damaged ones.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalPresent(const gtFrame* frame, BOOL full)
+{
+	if(frame->hold)
+	{
+		host.frameBytes = 0;
+		return;
+	}
+
+	//! Worst case per cell: a cursor move, both colors and the 3-byte glyph.
+	size_t capacity = (size_t)host.columns * host.rows * 64 + 16;
+	if(host.outputCapacity < capacity)
+	{
+		free(host.output);
+		host.output = (char*)malloc(capacity);
+		host.outputCapacity = capacity;
+	}
+
+	//! The cell ranges to compare: the whole screen, or the cells sampling each damaged rectangle.
+	gtRect regions[GRAPHTE_DAMAGE_RECTS];
+	int regionCount = 0;
+
+	if(full || frame->full)
+		regions[regionCount++] = (gtRect){0, 0, host.columns, host.rows};
+	else
+	{
+		for(int i = 0; i < frame->damageCount; i++)
+		{
+			const gtRect* area = &frame->damage[i];
+			gtRect cells = {host.columns, host.rows, 0, 0};
+
+			for(int column = 0; column < host.columns; column++)
+			{
+				if(host.sampleX[column] >= area->left && host.sampleX[column] < area->right)
+				{
+					if(column < cells.left) cells.left = column;
+					cells.right = column + 1;
+				}
+			}
+			for(int row = 0; row < host.rows * 2; row++)
+			{
+				if(host.sampleY[row] >= area->top && host.sampleY[row] < area->bottom)
+				{
+					if(row / 2 < cells.top) cells.top = row / 2;
+					cells.bottom = row / 2 + 1;
+				}
+			}
+
+			if(cells.left < cells.right && cells.top < cells.bottom)
+				regions[regionCount++] = cells;
+		}
+	}
+
+	char* out = host.output;
+	int cursorColumn = -1, cursorRow = -1;
+	uint32_t foreground = UINT32_MAX, background = UINT32_MAX;
+
+	for(int region = 0; region < regionCount; region++)
+	{
+		for(int row = regions[region].top; row < regions[region].bottom; row++)
+		{
+			int topY = host.sampleY[row * 2], bottomY = host.sampleY[row * 2 + 1];
+			const uint32_t* topRow = topY >= 0 ? frame->pixels + (size_t)topY * frame->stride : NULL;
+			const uint32_t* bottomRow = bottomY >= 0 ? frame->pixels + (size_t)bottomY * frame->stride : NULL;
+			uint64_t* cells = host.cells + (size_t)row * host.columns;
+
+			for(int column = regions[region].left; column < regions[region].right; column++)
+			{
+				int x = host.sampleX[column];
+				uint32_t top = x >= 0 && topRow ? topRow[x] & 0xFFFFFF : 0;
+				uint32_t bottom = x >= 0 && bottomRow ? bottomRow[x] & 0xFFFFFF : 0;
+				uint64_t cell = (uint64_t)top << 32 | bottom;
+
+				if(cells[column] == cell)
+					continue;
+				cells[column] = cell;
+
+				if(cursorRow != row || cursorColumn != column)
+					out += sprintf(out, "\x1b[%d;%dH", row + 1, column + 1);
+
+				//! A cell with two equal pixels is a space on the background color, leaving the foreground untouched.
+				BOOL solid = top == bottom;
+				if((!solid && foreground != top) || background != bottom)
+				{
+					*out++ = '\x1b';
+					*out++ = '[';
+					if(!solid && foreground != top)
+					{
+						out = gtTerminalColor(out, 38, top);
+						foreground = top;
+						if(background != bottom)
+							*out++ = ';';
+					}
+					if(background != bottom)
+					{
+						out = gtTerminalColor(out, 48, bottom);
+						background = bottom;
+					}
+					*out++ = 'm';
+				}
+
+				if(solid)
+					*out++ = ' ';
+				else
+				{
+					*out++ = '\xE2';
+					*out++ = '\x96';
+					*out++ = '\x80';
+				}
+
+				cursorRow = row;
+				cursorColumn = column + 1;
+			}
+		}
+	}
+
+	host.frameBytes = out - host.output;
+	gtTerminalWrite(host.output, host.frameBytes);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that queues a key press received from the terminal.
+ * 
+ * \param[in]    keyCode    The virtual key code of the key, 0 for characters without one.
+ * \param[in]    character  The character typed, 0 for keys without one.
+ * \param[in]    now        The time the input was read, in milliseconds.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalKey(WORD keyCode, char character, double now)
+{
+	event item;
+	memset(&item, 0, sizeof(item));
+	item.type = EVENT_KEY_DOWN;
+	item.time = now;
+	item.key = keyCode;
+	item.character = character;
+	gtQueueEvent(item);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that queues the event of an escape sequence received from the terminal.
+ * 
+ * \details Cursor and editing keys arrive as "ESC [ letter", "ESC O letter" or "ESC [ number ~". Mouse reports use the xterm SGR encoding,
+ *          "ESC [ < button ; column ; row M" for presses and motion and the same ending with 'm' for releases, where the button has 32 added for motion
+ *          and 64 for the wheel. Mouse positions are queued in cells, gtAcceptEvent() converts them to pixels.
+ * 
+ * \param[in]    parameters  The bytes between the introducer and the final byte.
+ * \param[in]    length      The number of parameter bytes.
+ * \param[in]    final       The final byte of the sequence.
+ * \param[in]    now         The time the input was read, in milliseconds.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalSequence(const unsigned char* parameters, size_t length, unsigned char final, double now)
+{
+	if(length && parameters[0] == '<')
+	{
+		int values[3] = {0, 0, 0}, count = 0;
+
+		for(size_t i = 1; i < length && count < 3; i++)
+		{
+			if(parameters[i] == ';')
+				count++;
+			else if(parameters[i] >= '0' && parameters[i] <= '9')
+				values[count] = values[count] * 10 + parameters[i] - '0';
+		}
+		if(count != 2 || (final != 'M' && final != 'm'))
+			return;
+
+		static const WORD buttons[3] = {VK_LBUTTON, VK_MBUTTON, VK_RBUTTON};
+		event item;
+		memset(&item, 0, sizeof(item));
+		item.time = now;
+		item.x = values[1] - 1;
+		item.y = values[2] - 1;
+
+		if(values[0] & 64)
+		{
+			item.type = EVENT_MOUSE_WHEEL;
+			item.wheel = values[0] & 1 ? -1 : 1;
+		}
+		else if(values[0] & 32)
+			item.type = EVENT_MOUSE_MOVE;
+		else if((values[0] & 3) < 3)
+		{
+			item.type = final == 'M' ? EVENT_MOUSE_DOWN : EVENT_MOUSE_UP;
+			item.key = buttons[values[0] & 3];
+		}
+		else
+			return;
+
+		gtQueueEvent(item);
+		return;
+	}
+
+	//! Sequences of the form "ESC [ n ~" carry their key in the number.
+	if(final == '~' && length)
+		final = parameters[0] == '1' || parameters[0] == '7' ? 'H' : parameters[0] == '4' || parameters[0] == '8' ? 'F' : 0;
+
+	switch(final)
+	{
+		case 'A': gtTerminalKey(VK_UP, 0, now); break;
+		case 'B': gtTerminalKey(VK_DOWN, 0, now); break;
+		case 'C': gtTerminalKey(VK_RIGHT, 0, now); break;
+		case 'D': gtTerminalKey(VK_LEFT, 0, now); break;
+		case 'H': gtTerminalKey(VK_HOME, 0, now); break;
+		case 'F': gtTerminalKey(VK_END, 0, now); break;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that decodes the bytes received from the terminal.
+ * 
+ * \details This function queues an event for every key and mouse report. An escape sequence cut by the end of the data is left undecoded
+ *          so it can be completed by the next read, unless the data is final, in which case a lone ESC is the escape key.
+ * 
+ * \param[in]    data   The received bytes.
+ * \param[in]    size   The number of received bytes.
+ * \param[in]    final  TRUE if no more bytes are expected to complete a sequence.
+ * \param[in]    now    The time the bytes were read, in milliseconds.
+ * 
+ * \return       Returns the number of bytes decoded, the rest has to be passed again with the next bytes.
+ */
+////////////////////////////////////////////////////////////
+size_t gtTerminalDecode(const unsigned char* data, size_t size, BOOL final, double now)
+{
+	size_t i = 0;
+
+	while(i < size)
+	{
+		unsigned char key = data[i];
+
+		if(key == 0x1B && (i + 1 < size || !final))
+		{
+			if(i + 1 == size)
+				return i;
+
+			if(data[i + 1] == '[' || data[i + 1] == 'O')
+			{
+				//! The parameters are followed by a final byte in the 0x40-0x7E range.
+				size_t end = i + 2;
+				while(end < size && (data[end] < 0x40 || data[end] > 0x7E))
+					end++;
+
+				if(end == size)
+				{
+					if(!final)
+						return i;
+					break;
+				}
+
+				gtTerminalSequence(data + i + 2, end - i - 2, data[end], now);
+				i = end + 1;
+				continue;
+			}
+		}
+
+		if(key == '\r' || key == '\n')
+			gtTerminalKey(VK_RETURN, key, now);
+		else if(key == 0x7F || key == 0x08)
+			gtTerminalKey(VK_BACK, key, now);
+		else if(key == '\t' || key == ' ' || key == 0x1B)
+			gtTerminalKey(key, key, now);
+		else if(key >= 'a' && key <= 'z')
+			gtTerminalKey(key - 'a' + 'A', key, now);
+		else if((key >= 'A' && key <= 'Z') || (key >= '0' && key <= '9'))
+			gtTerminalKey(key, key, now);
+		else
+			gtTerminalKey(0, key, now);
+
+		i++;
+	}
+
+	return size;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads the terminal input on the input reader thread.
+ * 
+ * \details This function waits on the terminal and on the wake pipe. Terminal bytes are decoded into events as soon as they arrive, so no key press
+ *          is lost between two frames. releaseHost() writes to the pipe to end the thread.
+ * 
+ * \param[in]    argument  Not used.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtTerminalReader(void* argument)
+{
+	unsigned char data[512];
+	size_t kept = 0;
+	(void)argument;
+
+	while(1)
+	{
+		struct pollfd sources[2] = {{STDIN_FILENO, POLLIN, 0}, {gtTerminalWake[0], POLLIN, 0}};
+
+		//! An escape sequence cut in two is given a few milliseconds to be completed.
+		int ready = poll(sources, 2, kept ? 10 : -1);
+		if(ready < 0 && errno != EINTR)
+			return;
+
+		if(!ready && kept)
+		{
+			gtTerminalDecode(data, kept, TRUE, gtMilliseconds());
+			kept = 0;
+		}
+
+		if(sources[1].revents & POLLIN)
+			return;
+
+		if(sources[0].revents & POLLIN)
+		{
+			ssize_t size = read(STDIN_FILENO, data + kept, sizeof(data) - kept);
+			if(size > 0)
+			{
+				size_t total = kept + size;
+				size_t used = gtTerminalDecode(data, total, total == sizeof(data), gtMilliseconds());
+				kept = total - used;
+				memmove(data, data + used, kept);
+			}
+			else if(!size)
+				return;
+		}
+		else if(sources[0].revents & (POLLHUP | POLLERR))
+			return;
+	}
+}
+#endif
+
+#ifdef GRAPHTE_SOFTWARE
+////////////////////////////////////////////////////////////
+// Present thread
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that exchanges the buffer in the present slot.
+ * 
+ * \details The slot is changed without a lock: only display() sets GRAPHTE_PRESENT_FRESH and only the present thread takes it away,
+ *          so a thread finding it in the returned value owns a frame that has not been presented.
+ * 
+ * \param[in]    value  The new content of the slot, a buffer index with GRAPHTE_PRESENT_FRESH for a frame to be presented.
+ * 
+ * \return       Returns the previous content of the slot.
+ */
+////////////////////////////////////////////////////////////
+long long gtExchangeSlot(long long value)
+{
+	long long previous;
+	do
+		previous = gtAtomicLoad64(&gtPresent.slot);
+	while(!gtAtomicSwap64(&gtPresent.slot, previous, value));
+
+	return previous;
+}
+
+//! Wakes the threads waiting for the slot or for the present thread to be idle.
+void gtWakePresent()
+{
+	gtMonitorEnter(&gtPresent.monitor);
+	gtMonitorWakeAll(&gtPresent.monitor);
+	gtMonitorLeave(&gtPresent.monitor);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that runs the present thread.
+ * 
+ * \details The thread sleeps until display() puts a frame into the slot, takes it in exchange for the buffer it presented last and presents it.
+ *          The buffer it holds is the only one display() never draws into or copies to, so the frame can be written while the next one is drawn.
+ * 
+ * \param[in]    argument  Not used.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtPresentWorker(void* argument)
+{
+	(void)argument;
+
+	for(;;)
+	{
+		gtMonitorEnter(&gtPresent.monitor);
+		while(!(gtAtomicLoad64(&gtPresent.slot) & GRAPHTE_PRESENT_FRESH) && !gtPresent.quit)
+			gtMonitorWait(&gtPresent.monitor);
+		if(gtPresent.quit)
+		{
+			gtMonitorLeave(&gtPresent.monitor);
+			return;
+		}
+		gtPresent.busy = TRUE;
+		gtMonitorLeave(&gtPresent.monitor);
+
+		int taken = (int)(gtExchangeSlot(gtPresent.shown) & 3);
+		gtWakePresent();
+
+		gtFrame* frame = &gtPresent.frames[taken];
+#ifdef GRAPHTE_BACKEND_TERMINAL
+		//! The cells show the frame presented last, after a dropped frame the damage of this one is not enough and every cell is compared.
+		gtTerminalPresent(frame, frame->number != gtPresent.shownNumber + 1);
+#endif
+		gtPresent.shown = taken;
+		gtPresent.shownNumber = frame->hold ? 0 : frame->number;
+		gtAtomicAdd(&gtPresent.presented, 1);
+
+		gtMonitorEnter(&gtPresent.monitor);
+		gtPresent.busy = FALSE;
+		gtMonitorWakeAll(&gtPresent.monitor);
+		gtMonitorLeave(&gtPresent.monitor);
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that hands a frame over to the present thread and continues drawing in another buffer.
+ * 
+ * \details The frame goes into the slot and the buffer that was in it becomes the back buffer: the buffer presented last, or with PRESENT_DROP
+ *          a frame that was replaced before being presented. That buffer is one or two frames old, so the damage of the last frame, and of the one
+ *          before when needed, is left to be copied into it from the front buffer by gtSyncBackBuffer(). An older buffer is copied in full.
+ * 
+ * \param[in]    frame  The frame drawn in host.pixels.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtHandOver(const gtFrame* frame)
+{
+	int draw = gtPresent.draw;
+	gtPresent.frames[draw] = *frame;
+
+	//! Every frame is presented in the queue mode, the previous one has to be taken by the present thread first.
+	if(gtPresent.mode == PRESENT_QUEUE)
+	{
+		gtMonitorEnter(&gtPresent.monitor);
+		while(gtAtomicLoad64(&gtPresent.slot) & GRAPHTE_PRESENT_FRESH)
+			gtMonitorWait(&gtPresent.monitor);
+		gtMonitorLeave(&gtPresent.monitor);
+	}
+
+	long long previous = gtExchangeSlot(draw | GRAPHTE_PRESENT_FRESH);
+	gtWakePresent();
+	if(previous & GRAPHTE_PRESENT_FRESH)
+		gtPresent.dropped++;
+
+	int returned = (int)(previous & 3);
+	unsigned long age = gtPresent.frames[returned].number ? frame->number - gtPresent.frames[returned].number : 0;
+
+	gtDamageList.pendingFull = frame->full || !(age == 1 || (age == 2 && !gtPresent.historyFull));
+	gtDamageList.pendingCount = 0;
+	if(!gtDamageList.pendingFull)
+	{
+		memcpy(gtDamageList.pending, frame->damage, frame->damageCount * sizeof(gtRect));
+		gtDamageList.pendingCount = frame->damageCount;
+		if(age == 2)
+		{
+			memcpy(gtDamageList.pending + gtDamageList.pendingCount, gtPresent.history, gtPresent.historyCount * sizeof(gtRect));
+			gtDamageList.pendingCount += gtPresent.historyCount;
+		}
+	}
+
+	memcpy(gtPresent.history, frame->damage, frame->damageCount * sizeof(gtRect));
+	gtPresent.historyCount = frame->damageCount;
+	gtPresent.historyFull = frame->full;
+
+	gtPresent.latest = draw;
+	gtPresent.draw = returned;
+	host.frontPixels = gtPresent.frames[draw].pixels;
+	host.pixels = gtPresent.frames[returned].pixels;
+	host.sparePixels = gtPresent.frames[3 - draw - returned].pixels;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that stops the present thread.
+ * 
+ * \details The last frame is presented first. The third buffer is released, display() then presents on the calling thread again.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtStopPresenter()
+{
+	if(!gtPresent.running)
+		return;
+
+	gtWaitPresenter();
+
+	gtMonitorEnter(&gtPresent.monitor);
+	gtPresent.quit = TRUE;
+	gtMonitorWakeAll(&gtPresent.monitor);
+	gtMonitorLeave(&gtPresent.monitor);
+
+	gtJoinThread(gtPresent.thread);
+	gtPresent.running = FALSE;
+
+	free(host.sparePixels);
+	host.sparePixels = NULL;
+}
+#endif
+
+#ifdef GRAPHTE_SOFTWARE
+////////////////////////////////////////////////////////////
+// Frame capture
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that closes the file of a capture.
+ * 
+ * \param[in]    file  The file, or the pipe to a command.
+ * \param[in]    pipe  TRUE if the file is a pipe.
+ * 
+ * \return       Returns TRUE if the file was closed and, for a pipe, the command succeeded.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtCloseCapture(FILE* file, BOOL pipe)
+{
+	if(!pipe)
+		return fclose(file) == 0;
+#ifdef _WIN32
+	return _pclose(file) == 0;
+#else
+	return pclose(file) == 0;
+#endif
+}
+
+//! Appends bytes to the capture stream, nothing more is written once a write has failed.
+void gtCaptureWrite(const void* data, size_t size)
+{
+	if(!gtCapture.failed && size && fwrite(data, 1, size, gtCapture.file) != size)
+		gtCapture.failed = TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that writes the frame handed over to the capture thread.
+ * 
+ * \details The rows are read straight from the front buffer. A Y4M frame is converted into the planes by the YUV kernel two rows at a time,
+ *          then written with a single call. The parts of the stream the frame does not cover are black: Y = 0 and U = V = 128.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtWriteCapturedFrame()
+{
+	int width = gtCapture.width, height = gtCapture.height;
+	int covered = gtCapture.frameWidth < width ? gtCapture.frameWidth : width;
+
+	if(gtCapture.format == CAPTURE_RAW)
+	{
+		for(int y = 0; y < height; y++)
+		{
+			if(y < gtCapture.frameHeight)
+			{
+				gtCaptureWrite(gtCapture.pixels + (size_t)y * gtCapture.frameStride, covered * sizeof(uint32_t));
+				gtCaptureWrite(gtCapture.blackRow, (width - covered) * sizeof(uint32_t));
+			}
+			else
+				gtCaptureWrite(gtCapture.blackRow, width * sizeof(uint32_t));
+		}
+		return;
+	}
+
+	size_t chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2, coveredChroma = (covered + 1) / 2;
+	unsigned char* luma = gtCapture.planes;
+	unsigned char* u = luma + (size_t)width * height;
+	unsigned char* v = u + chromaWidth * chromaHeight;
+
+	for(int y = 0; y < height; y += 2)
+	{
+		//! The last row of an odd height forms the blocks with itself.
+		int next = y + 1 < height ? y + 1 : y;
+		const uint32_t* top = y < gtCapture.frameHeight ? gtCapture.pixels + (size_t)y * gtCapture.frameStride : gtCapture.blackRow;
+		const uint32_t* bottom = next < gtCapture.frameHeight ? gtCapture.pixels + (size_t)next * gtCapture.frameStride : gtCapture.blackRow;
+		unsigned char* lumaTop = luma + (size_t)y * width;
+		unsigned char* lumaBottom = luma + (size_t)next * width;
+		unsigned char* rowU = u + (size_t)(y / 2) * chromaWidth;
+		unsigned char* rowV = v + (size_t)(y / 2) * chromaWidth;
+
+		gtKernels.yuvRows(top, bottom, covered, lumaTop, lumaBottom, rowU, rowV);
+		memset(lumaTop + covered, 0, width - covered);
+		memset(lumaBottom + covered, 0, width - covered);
+		memset(rowU + coveredChroma, 128, chromaWidth - coveredChroma);
+		memset(rowV + coveredChroma, 128, chromaWidth - coveredChroma);
+	}
+
+	gtCaptureWrite("FRAME\n", 6);
+	gtCaptureWrite(gtCapture.planes, (size_t)width * height + 2 * chromaWidth * chromaHeight);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that runs the capture thread.
+ * 
+ * \details The thread sleeps until display() hands a frame over, writes it, then lets display() swap the buffers again.
+ *          When the capture is stopped, the frame still waiting is written first.
+ * 
+ * \param[in]    argument  Not used.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtCaptureWorker(void* argument)
+{
+	(void)argument;
+
+	for(;;)
+	{
+		gtMonitorEnter(&gtCapture.monitor);
+		while(!gtCapture.fresh && !gtCapture.quit)
+			gtMonitorWait(&gtCapture.monitor);
+		if(!gtCapture.fresh)
+		{
+			gtMonitorLeave(&gtCapture.monitor);
+			return;
+		}
+		gtMonitorLeave(&gtCapture.monitor);
+
+		gtWriteCapturedFrame();
+		gtCapture.frames++;
+
+		gtMonitorEnter(&gtCapture.monitor);
+		gtCapture.fresh = FALSE;
+		gtMonitorWakeAll(&gtCapture.monitor);
+		gtMonitorLeave(&gtCapture.monitor);
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that hands a displayed frame over to the capture thread.
+ * 
+ * \details Nothing is copied: the frame stays in the front buffer, which is only read until the next display() call, and that call
+ *          waits for the capture thread with gtWaitCapture() before the buffers change hands.
+ * 
+ * \param[in]    frame  The frame just handed to the front buffer.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtCaptureFrame(const gtFrame* frame)
+{
+	gtCapture.pixels = frame->pixels;
+	gtCapture.frameWidth = frame->width;
+	gtCapture.frameHeight = frame->height;
+	gtCapture.frameStride = frame->stride;
+
+	gtMonitorEnter(&gtCapture.monitor);
+	gtCapture.fresh = TRUE;
+	gtMonitorWakeAll(&gtCapture.monitor);
+	gtMonitorLeave(&gtCapture.monitor);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that stops the capture thread and closes the stream.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return       Returns TRUE if every frame was written and the stream closed, FALSE otherwise or if no capture was running.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtStopCapture()
+{
+	if(!gtCapture.running)
+		return FALSE;
+
+	gtMonitorEnter(&gtCapture.monitor);
+	gtCapture.quit = TRUE;
+	gtMonitorWakeAll(&gtCapture.monitor);
+	gtMonitorLeave(&gtCapture.monitor);
+
+	gtJoinThread(gtCapture.thread);
+	gtCapture.running = FALSE;
+
+	BOOL written = !gtCapture.failed;
+	written &= gtCloseCapture(gtCapture.file, gtCapture.pipe);
+	gtCapture.file = NULL;
+	free(gtCapture.planes);
+	free(gtCapture.blackRow);
+	gtCapture.planes = NULL;
+	gtCapture.blackRow = NULL;
+
+	return written;
+}
+#endif
+
+#ifdef GRAPHTE_BACKEND_GDI
+////////////////////////////////////////////////////////////
+// Console input
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads the console input on the input reader thread.
+ * 
+ * \details This function turns the key and mouse records of the console into events as soon as they arrive, so no key press is lost between two frames.
+ *          Mouse positions are read from the cursor, in pixels relative to the window. The wait is bounded so releaseHost() can end the thread.
+ * 
+ * \param[in]    argument  Not used.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtConsoleReader(void* argument)
+{
+	static const DWORD buttonMasks[3] = {FROM_LEFT_1ST_BUTTON_PRESSED, RIGHTMOST_BUTTON_PRESSED, FROM_LEFT_2ND_BUTTON_PRESSED};
+	static const WORD buttons[3] = {VK_LBUTTON, VK_RBUTTON, VK_MBUTTON};
+	DWORD buttonState = 0;
+	(void)argument;
+
+	while(gtAtomicLoad(&host.readerRunning))
+	{
+		INPUT_RECORD records[64];
+		DWORD count = 0;
+
+		if(WaitForSingleObject(host.inputHandle, 50) != WAIT_OBJECT_0)
+			continue;
+		if(!ReadConsoleInputA(host.inputHandle, records, 64, &count))
+			return;
+
+		for(DWORD i = 0; i < count; i++)
+		{
+			event item;
+			memset(&item, 0, sizeof(item));
+			item.time = gtMilliseconds();
+
+			if(records[i].EventType == KEY_EVENT)
+			{
+				KEY_EVENT_RECORD* key = &records[i].Event.KeyEvent;
+				item.type = key->bKeyDown ? EVENT_KEY_DOWN : EVENT_KEY_UP;
+				item.key = key->wVirtualKeyCode;
+				item.character = key->uChar.AsciiChar;
+
+				//! A held key reports its repeats in one record.
+				for(WORD repeat = 0; repeat < (key->bKeyDown && key->wRepeatCount ? key->wRepeatCount : 1); repeat++)
+					gtQueueEvent(item);
+			}
+			else if(records[i].EventType == MOUSE_EVENT)
+			{
+				MOUSE_EVENT_RECORD* mouse = &records[i].Event.MouseEvent;
+				POINT position;
+				GetCursorPos(&position);
+				ScreenToClient(host.hwnd, &position);
+				item.x = position.x;
+				item.y = position.y;
+
+				if(mouse->dwEventFlags & MOUSE_WHEELED)
+				{
+					item.type = EVENT_MOUSE_WHEEL;
+					item.wheel = (short)HIWORD(mouse->dwButtonState) / WHEEL_DELTA;
+					gtQueueEvent(item);
+					continue;
+				}
+
+				BOOL changed = FALSE;
+				for(int button = 0; button < 3; button++)
+				{
+					if((mouse->dwButtonState ^ buttonState) & buttonMasks[button])
+					{
+						item.type = mouse->dwButtonState & buttonMasks[button] ? EVENT_MOUSE_DOWN : EVENT_MOUSE_UP;
+						item.key = buttons[button];
+						gtQueueEvent(item);
+						changed = TRUE;
+					}
+				}
+				buttonState = mouse->dwButtonState;
+
+				if(!changed)
+				{
+					item.type = EVENT_MOUSE_MOVE;
+					gtQueueEvent(item);
+				}
+			}
+		}
+	}
+}
+#endif
+
+#ifdef GRAPHTE_BACKEND_GDI
+////////////////////////////////////////////////////////////
+// GDI object pool
+////////////////////////////////////////////////////////////
+
+//! The number of pens and the number of brushes kept alive between draw calls.
+#ifndef GRAPHTE_GDI_POOL_SIZE
+	#define GRAPHTE_GDI_POOL_SIZE 32
+#endif
+
+//! A pooled GDI pen or brush. Brushes leave width and style at 0.
+typedef struct
+{
+	HGDIOBJ object; //! The pen or brush, NULL for an empty slot.
+	COLORREF color;
+	uint16 width;
+	int style;
+	unsigned long lastUse; //! The value of the use counter the last time the object was requested.
+}
+gtGdiObject;
+
+//! The pen and brush pools, along with the objects currently selected into the buffer device context.
+struct
+{
+	gtGdiObject pens[GRAPHTE_GDI_POOL_SIZE];
+	gtGdiObject brushes[GRAPHTE_GDI_POOL_SIZE];
+	unsigned long uses; //! Incremented on every request to order the objects from least to most recently used.
+	HGDIOBJ selectedPen, selectedBrush; //! The pooled objects selected into bufferDC, NULL when a stock object is selected.
+	cacheStats penStats, brushStats;
+}
+gtGdiPool;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds or creates a pooled pen or brush.
+ * 
+ * \details This function looks (color, width, style) up in the given pool. On a miss the object is created in an empty slot or in place of the least
+ *          recently used object. An evicted object that is still selected into the buffer device context is replaced by the stock object first.
+ * 
+ * \param[in,out]  pool    The pen or brush pool.
+ * \param[in,out]  stats   The counters of the pool.
+ * \param[in]      isPen   TRUE for the pen pool, FALSE for the brush pool.
+ * \param[in]      value   The color of the object.
+ * \param[in]      width   The width of the pen.
+ * \param[in]      style   The style of the pen.
+ * 
+ * \return         Returns the pooled object.
+ */
+////////////////////////////////////////////////////////////
+HGDIOBJ gtPoolObject(gtGdiObject* pool, cacheStats* stats, BOOL isPen, COLORREF value, uint16 width, int style)
+{
+	int victim = 0;
+
+	for(int i = 0; i < GRAPHTE_GDI_POOL_SIZE; i++)
+	{
+		if(pool[i].object && pool[i].color == value && pool[i].width == width && pool[i].style == style)
+		{
+			stats->hits++;
+			pool[i].lastUse = ++gtGdiPool.uses;
+			return pool[i].object;
+		}
+
+		if(pool[victim].object && (!pool[i].object || pool[i].lastUse < pool[victim].lastUse))
+			victim = i;
+	}
+
+	stats->misses++;
+	gtGdiObject* entry = &pool[victim];
+	if(entry->object)
+	{
+		if(entry->object == gtGdiPool.selectedPen)
+		{
+			SelectObject(host.bufferDC, GetStockObject(DC_PEN));
+			gtGdiPool.selectedPen = NULL;
+		}
+		if(entry->object == gtGdiPool.selectedBrush)
+		{
+			SelectObject(host.bufferDC, GetStockObject(DC_BRUSH));
+			gtGdiPool.selectedBrush = NULL;
+		}
+		DeleteObject(entry->object);
+	}
+
+	entry->object = isPen ? (HGDIOBJ)CreatePen(style, width, value) : (HGDIOBJ)CreateSolidBrush(value);
+	entry->color = value;
+	entry->width = width;
+	entry->style = style;
+	entry->lastUse = ++gtGdiPool.uses;
+	return entry->object;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that selects a pooled pen into the buffer device context.
+ * 
+ * \details This function only calls SelectObject() when the requested pen is not the one already selected.
+ * 
+ * \param[in]    value  The color of the pen.
+ * \param[in]    width  The width of the pen.
+ * \param[in]    style  The style of the pen (PS_SOLID, PS_DASH, ...).
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtSelectPen(COLORREF value, uint16 width, int style)
+{
+	HGDIOBJ pen = gtPoolObject(gtGdiPool.pens, &gtGdiPool.penStats, TRUE, value, width, style);
+	if(pen != gtGdiPool.selectedPen)
+	{
+		SelectObject(host.bufferDC, pen);
+		gtGdiPool.selectedPen = pen;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that selects a pooled solid brush into the buffer device context.
+ * 
+ * \details This function only calls SelectObject() when the requested brush is not the one already selected.
+ * 
+ * \param[in]    value  The color of the brush.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtSelectBrush(COLORREF value)
+{
+	HGDIOBJ brush = gtPoolObject(gtGdiPool.brushes, &gtGdiPool.brushStats, FALSE, value, 0, 0);
+	if(brush != gtGdiPool.selectedBrush)
+	{
+		SelectObject(host.bufferDC, brush);
+		gtGdiPool.selectedBrush = brush;
+	}
+}
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that updates the rectangle of the window host.
+ * 
+ * \details This function retrieves a new rectangle with the position and size of the host.
+ * 
+ * \note    The instance width and height are the size of the canvas, they follow the rectangle through update(), setWindowSize() and display().
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void updateWindowBounds()
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	GetWindowRect(host.hwnd, &host.rect);
+#endif
+	//! The software backends have no window, their bounds are the size of the pixel buffers.
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that disables the flashing console cursor.
+ * 
+ * \details This function resizes the console cursor and negates its visibility, which makes it stop flickering on frame rendering most of the time.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void disableConsoleCursor()
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	CONSOLE_CURSOR_INFO cInfo;
+	cInfo.dwSize = 100;
+    cInfo.bVisible = FALSE;
+	SetConsoleCursorInfo(host.outputHandle, &cInfo);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that updates the memory bitmap canvas to the new window size.
+ * 
+ * \details This function retrieves the new window bounds and resizes the canvas to them right away. The canvas keeps its content, and its
+ *          buffer is only re-allocated when the new size does not fit into the current allocation (see gtResizeBuffers()).
+ *          On GDI the canvas is a DIB section, so its pixels stay reachable through lockPixels().
+ * 
+ * \note    Calling update() is no longer required: setWindowSize() resizes the canvas itself, and display() follows a window resized by the user.
+ *          The software backends have no window to follow, update() does nothing there.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void update()
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	updateWindowBounds();
+	host.resizePending = FALSE;
+
+	//! A console cursor disable is required after the window bounds changed.
+	if(gtResizeBuffers(host.rect.right - host.rect.left, host.rect.bottom - host.rect.top))
+		disableConsoleCursor();
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that intializes the window instance handles.
+ * 
+ * \details This function retrieves the window instance handles and stores then in the host variable, enabling the use of graphTe functions in the target program.
+ * 
+ * \note   This function must be executed before the use of any library functions that involve graphics.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void initHost()
+{
+	//! The widest pixel row kernels the processor supports.
+	gtUseKernels(KERNELS_AVX512);
+
+#ifdef GRAPHTE_SOFTWARE
+	#ifdef _WIN32
+	host.outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+	#endif
+	host.x = host.y = 0;
+	#ifdef GRAPHTE_BACKEND_TERMINAL
+	static const char enter[] = "\x1b[?1049h\x1b[?25l\x1b[?1003h\x1b[?1006h";
+	static BOOL restoreRegistered = FALSE;
+	struct sigaction action;
+	struct winsize size;
+
+	//! Raw, non-blocking input without echo. Signals stay enabled so Ctrl+C still ends the program.
+	if(!tcgetattr(STDIN_FILENO, &host.savedMode))
+	{
+		struct termios mode = host.savedMode;
+		mode.c_lflag &= ~(ICANON | ECHO);
+		mode.c_iflag &= ~(IXON | ICRNL);
+		mode.c_cc[VMIN] = 0;
+		mode.c_cc[VTIME] = 0;
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &mode);
+	}
+	host.terminalActive = TRUE;
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = gtTerminalSignal;
+	sigaction(SIGWINCH, &action, NULL);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	sigaction(SIGHUP, &action, NULL);
+	if(!restoreRegistered)
+		restoreRegistered = !atexit(gtTerminalRestore);
+
+	gtTerminalWrite(enter, sizeof(enter) - 1);
+
+	//! The default buffer maps one pixel to every half cell of the terminal.
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) || !size.ws_col || !size.ws_row)
+	{
+		size.ws_col = 80;
+		size.ws_row = 24;
+	}
+	gtResizeBuffers(size.ws_col, size.ws_row * 2);
+
+	//! Key presses, mouse reports (any-motion tracking, SGR encoding) and resizes are read as they arrive, see pollEvent().
+	if(gtTerminalWake[0] < 0 && !pipe(gtTerminalWake))
+	{
+		fcntl(gtTerminalWake[0], F_SETFL, O_NONBLOCK);
+		fcntl(gtTerminalWake[1], F_SETFL, O_NONBLOCK);
+	}
+	if(!host.readerStarted && gtTerminalWake[0] >= 0)
+		host.readerStarted = gtStartThread(&host.reader, gtTerminalReader, NULL);
+	#else
+	gtResizeBuffers(GRAPHTE_DEFAULT_WIDTH, GRAPHTE_DEFAULT_HEIGHT);
+	#endif
+#else
+	//!Sync the following window handles.
+	host.hwnd = GetConsoleWindow();
+	host.hdc = GetDC(host.hwnd);
+	host.bufferDC = CreateCompatibleDC(host.hdc);
+	host.imageDC = CreateCompatibleDC(host.bufferDC);
+	SelectObject(host.bufferDC, GetStockObject(DC_PEN));
+	SelectObject(host.bufferDC, GetStockObject(DC_BRUSH));
+	//! Standard output handle for the text attribute function
+	host.outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+	//! Enabling transparent background mode for the transparentImage function.
+	SetBkMode(host.bufferDC, TRANSPARENT);
+
+	//! Quick edit mode would pause the program on a click, the console is asked for key, mouse and window records instead.
+	host.inputHandle = GetStdHandle(STD_INPUT_HANDLE);
+	GetConsoleMode(host.inputHandle, &host.savedInputMode);
+	SetConsoleMode(host.inputHandle, ENABLE_EXTENDED_FLAGS | ENABLE_WINDOW_INPUT | ENABLE_MOUSE_INPUT);
+	if(!host.readerStarted)
+	{
+		gtAtomicStore(&host.readerRunning, 1);
+		host.readerStarted = gtStartThread(&host.reader, gtConsoleReader, NULL);
+	}
+
+	//! A console cursor disable is required after synchronizing the window handles.
+	disableConsoleCursor();
+
+	update();
+
+	//! A thread stop of at least 100 ms is required after updating the window position and size.
+	Sleep(100);
+#endif
+}	
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that releases the window handles and frees up residual memory.
+ * 
+ * \details This function deletes the host device context and releases teh window handle to be used by other programs.
+ * 
+ * \note   Any use of releaseHost() must be either at the end of the program or followed by a respective initHost().
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void releaseHost()
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	//! The input reader sees the cleared flag within one wait of the console.
+	if(host.readerStarted)
+	{
+		gtAtomicStore(&host.readerRunning, 0);
+		gtJoinThread(host.reader);
+		host.readerStarted = FALSE;
+	}
+	SetConsoleMode(host.inputHandle, host.savedInputMode);
+
+	//! Deletes the residual host buffer linked to the old handle. A bitmap can only be deleted once no device context holds it,
+	//! so the cached texture left in the image context is selected out and the memory canvas is released with its context.
+	if(host.defaultImage)
+		SelectObject(host.imageDC, host.defaultImage);
+	DeleteDC(host.imageDC);
+	host.imageDC = NULL;
+	host.selectedImage = host.defaultImage = NULL;
+	DeleteDC(host.bufferDC);
+	DeleteObject(host.bufferBitmap);
+	host.bufferBitmap = NULL;
+	//! The pooled pens and brushes outlive the device context, they are simply not selected into the next one.
+	gtGdiPool.selectedPen = gtGdiPool.selectedBrush = NULL;
+
+	//! Realeases the main window handle and device context.
+	ReleaseDC(host.hwnd, host.hdc);
+	host.pixels = NULL;
+#else
+	//! The last frame is written before the terminal is restored.
+	gtStopPresenter();
+	gtStopCapture();
+	gtPresent.mode = PRESENT_SYNC;
+
+	#ifdef GRAPHTE_BACKEND_TERMINAL
+	if(host.readerStarted)
+	{
+		if(write(gtTerminalWake[1], "q", 1) == 1)
+			gtJoinThread(host.reader);
+		host.readerStarted = FALSE;
+	}
+	gtTerminalRestore();
+	free(host.cells);
+	free(host.sampleX);
+	free(host.sampleY);
+	free(host.output);
+	host.cells = NULL;
+	host.sampleX = host.sampleY = NULL;
+	host.output = NULL;
+	host.outputCapacity = 0;
+	host.layoutWidth = host.layoutHeight = 0;
+	#endif
+	free(host.pixels);
+	free(host.frontPixels);
+	host.pixels = host.frontPixels = NULL;
+	gtDamageList.pendingCount = gtDamageList.pendingFull = 0;
+#endif
+	host.capacityWidth = host.capacityHeight = 0;
+	gtDamageList.count = gtDamageList.full = 0;
+
+	free(gtDepth.values);
+	gtDepth.values = NULL;
+	gtDepth.width = gtDepth.height = 0;
+	gtReleaseStroke();
+	for(int i = 0; i < GRAPHTE_COMMAND_BUFFERS; i++)
+		free(gtCommands.entries[i].bytes);
+	memset(&gtCommands, 0, sizeof(gtCommands));
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that copies the buffer device context to the host, efectively drawing to screen.
+ * 
+ * \details This function uses a bitmap copy to display the buffer device context(memory canvas) to the screen. Displays on screen what has been rendered to the window so far.
+ *          This function is typically called after all winAPI rendering has been done for the current frame, in order to show it on screen.
+ * 
+ * \note   display() only updates the buffer to the memory canvas size, therefore resizing the image to the initial window size or the last call of update().
+ *          Every drawing function records the region it touched, and only those regions are presented (see setFullPresent()).
+ *          On the framebuffer backend display() swaps the back buffer with the front buffer, then brings the new back buffer up to date by copying
+ *          the damaged regions, so the canvas keeps its content like it does on GDI. That copy is skipped when the next frame starts with fill().
+ *          The terminal backend first writes the damaged cells whose colors changed since the last frame to the terminal, then swaps the buffers the same way.
+ *          With setPresentMode() the frame is handed over to a present thread instead and display() returns right away, drawing goes on in a third buffer.
+ *          While startCapture() records, the frame is also handed over to the capture thread, the next display() call waits until it has been written.
+ *          When the window (or terminal) has been resized by the user, the canvas follows it once the new size has been stable for GRAPHTE_RESIZE_DEBOUNCE
+ *          milliseconds, see setResizeCallback().
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void display()
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_DISPLAY);
+	BOOL full = gtDamageList.full || gtDamageList.forceFull;
+
+#ifdef GRAPHTE_BACKEND_GDI
+	//! A window resized by the user is followed once its size settles, the canvas is then presented in full.
+	if(gtFollowWindowSize())
+	{
+		disableConsoleCursor();
+		full = TRUE;
+	}
+
+	if(full)
+		BitBlt(host.hdc, 0, 0, host.width, host.height, host.bufferDC, 0, 0, SRCCOPY);
+	else
+	{
+		for(int i = 0; i < gtDamageList.count; i++)
+		{
+			gtRect* area = &gtDamageList.rects[i];
+			BitBlt(host.hdc, area->left, area->top, area->right - area->left, area->bottom - area->top, host.bufferDC, area->left, area->top, SRCCOPY);
+		}
+	}
+#else
+	//! The capture thread has to be done with the front buffer before it changes hands.
+	gtWaitCapture();
+	//! A frame without any drawing still has to complete the copy of the previous one.
+	gtSyncBackBuffer();
+
+	gtFrame frame = {host.pixels, host.width, host.height, host.stride};
+	memcpy(frame.damage, gtDamageList.rects, gtDamageList.count * sizeof(gtRect));
+	frame.damageCount = gtDamageList.count;
+	frame.full = full;
+	frame.number = ++gtPresent.number;
+
+	#ifdef GRAPHTE_BACKEND_TERMINAL
+	gtTerminalFollowSize(&frame);
+	#endif
+
+	if(gtPresent.running)
+		gtHandOver(&frame);
+	else
+	{
+	#ifdef GRAPHTE_BACKEND_TERMINAL
+		gtTerminalPresent(&frame, FALSE);
+	#endif
+
+		//! The back buffer becomes the front buffer, the frame's damage is copied into the new back buffer once the next frame starts drawing.
+		host.pixels = host.frontPixels;
+		host.frontPixels = frame.pixels;
+
+		gtDamageList.pendingFull = frame.full;
+		gtDamageList.pendingCount = frame.full ? 0 : frame.damageCount;
+		memcpy(gtDamageList.pending, frame.damage, gtDamageList.pendingCount * sizeof(gtRect));
+	}
+
+	if(gtCapture.running)
+		gtCaptureFrame(&frame);
+#endif
+
+	gtDamageList.full = FALSE;
+	gtDamageList.count = 0;
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that selects how display() hands frames over to the screen.
+ * 
+ * \details With PRESENT_DROP or PRESENT_QUEUE a present thread is started. It owns the buffer being presented, the program draws into a second one
+ *          and the last frame handed over waits in the third, so display() only exchanges buffers and drawing the next frame overlaps with
+ *          writing the previous one. PRESENT_DROP lets display() replace a frame that is still waiting, PRESENT_QUEUE makes display() wait
+ *          until the present thread has taken it. PRESENT_SYNC stops the thread after it has presented the last frame.
+ *          The mode can be changed at any time, the buffers keep the canvas content.
+ * 
+ * \note    The present thread is only available on the software backends, GDI always presents synchronously.
+ *          Text printed to the terminal while the present thread writes a frame can be interleaved with it.
+ * 
+ * \param[in]    mode  The new present mode.
+ * 
+ * \return       Returns TRUE if the mode is in use and FALSE if the backend does not support it or the thread could not be started.
+ */
+////////////////////////////////////////////////////////////
+BOOL setPresentMode(presentMode mode)
+{
+#ifdef GRAPHTE_SOFTWARE
+	if(mode == PRESENT_SYNC || gtPresent.running)
+	{
+		if(mode == PRESENT_SYNC)
+			gtStopPresenter();
+		gtPresent.mode = mode;
+		return TRUE;
+	}
+
+	if(!host.pixels)
+		return FALSE;
+	uint32_t* sparePixels = (uint32_t*)calloc((size_t)host.capacityWidth * host.capacityHeight, sizeof(uint32_t));
+	if(!sparePixels)
+		return FALSE;
+
+	if(!gtPresent.ready)
+	{
+		gtMonitorInit(&gtPresent.monitor);
+		gtPresent.ready = TRUE;
+	}
+
+	//! Both buffers hold the last frame, the content of the third one is unknown until it is drawn into.
+	gtSyncBackBuffer();
+	gtFrame blank = {NULL, host.width, host.height, host.stride};
+	for(int i = 0; i < 3; i++)
+		gtPresent.frames[i] = blank;
+	gtPresent.frames[0].pixels = host.pixels;
+	gtPresent.frames[1].pixels = host.frontPixels;
+	gtPresent.frames[2].pixels = sparePixels;
+	gtPresent.frames[0].number = gtPresent.frames[1].number = gtPresent.number;
+	host.sparePixels = sparePixels;
+
+	gtPresent.draw = 0;
+	gtPresent.latest = gtPresent.shown = 1;
+	gtPresent.slot = 2;
+	gtPresent.shownNumber = gtPresent.number;
+	gtPresent.historyCount = 0;
+	gtPresent.historyFull = TRUE;
+	gtPresent.quit = gtPresent.busy = FALSE;
+	gtPresent.mode = mode;
+
+	if(!gtStartThread(&gtPresent.thread, gtPresentWorker, NULL))
+	{
+		free(sparePixels);
+		host.sparePixels = NULL;
+		gtPresent.mode = PRESENT_SYNC;
+		return FALSE;
+	}
+	gtPresent.running = TRUE;
+	return TRUE;
+#else
+	return mode == PRESENT_SYNC;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the counters of the present thread.
+ * 
+ * \details A frame is dropped when display() replaces it with a newer one before the present thread has taken it, which only happens with PRESENT_DROP.
+ * 
+ * \note    The counters stay at 0 on GDI and while presenting synchronously.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the number of frames presented and dropped by the present thread since the start of the program.
+ */
+////////////////////////////////////////////////////////////
+presentStats getPresentStats()
+{
+#ifdef GRAPHTE_SOFTWARE
+	return (presentStats){(unsigned long)gtAtomicLoad(&gtPresent.presented), gtPresent.dropped};
+#else
+	return (presentStats){0, 0};
+#endif
+}
+
+#ifdef GRAPHTE_SOFTWARE
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the file formats accepted by saveFrame().
+ * 
+ * \details FRAME_PPM writes a binary (P6) portable pixmap, FRAME_RAW writes the buffer exactly as it is stored in memory:
+ *          rows of 32-bit 0x00RRGGBB little-endian values, without any header.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	FRAME_PPM = 0,
+	FRAME_RAW = 1
+}
+frameFormat;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that writes the last displayed frame to a file.
+ * 
+ * \details This function dumps the front buffer, which holds the frame given to the last display() call, in the specified format.
+ * 
+ * \note    This function is only available on the software backends.
+ * 
+ * \param[in]   filenamePTR  A reference to a constant file path that the frame will be written to.
+ * \param[in]   format       The file format of the dump.
+ * 
+ * \return  This function returns TRUE if the whole frame was written and FALSE otherwise.
+ */
+////////////////////////////////////////////////////////////
+BOOL saveFrame(char* filenamePTR, frameFormat format)
+{
+	FILE* file = fopen(filenamePTR, "wb");
+	if(!file)
+		return FALSE;
+
+	BOOL written = TRUE;
+	if(format == FRAME_PPM)
+	{
+		unsigned char* row = (unsigned char*)malloc((size_t)host.width * 3);
+		fprintf(file, "P6\n%d %d\n255\n", host.width, host.height);
+
+		for(int y = 0; y < host.height && row; y++)
+		{
+			const uint32_t* source = host.frontPixels + (size_t)y * host.stride;
+			for(int x = 0; x < host.width; x++)
+			{
+				row[x * 3] = source[x] >> 16;
+				row[x * 3 + 1] = source[x] >> 8;
+				row[x * 3 + 2] = source[x];
+			}
+			written &= fwrite(row, 3, host.width, file) == host.width;
+		}
+
+		written &= row != NULL;
+		free(row);
+	}
+	else
+	{
+		for(int y = 0; y < host.height; y++)
+			written &= fwrite(host.frontPixels + (size_t)y * host.stride, sizeof(uint32_t), host.width, file) == host.width;
+	}
+
+	fclose(file);
+	return written;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that starts recording every displayed frame to a video stream.
+ * 
+ * \details A capture thread writes the frames while the program draws the next one. display() hands it the front buffer without copying it,
+ *          and only waits when the previous frame has not been written yet, so the drawing thread pays for the hand-over alone.
+ *          The Y4M frames are converted to YUV by the pixel row kernels. The size of the stream is the size of the canvas when the capture starts,
+ *          frames of another size are cropped or padded with black.
+ * 
+ * \note    This function is only available on the software backends. A path starting with '|' is a command that receives the stream
+ *          on its standard input, for example "|ffmpeg -i - capture.mp4".
+ * 
+ * \param[in]   filenamePTR      A reference to a constant file path, or a command after '|', that the stream will be written to.
+ * \param[in]   format           The format of the stream.
+ * \param[in]   framesPerSecond  The frame rate written in the Y4M header, 60 if 0. The raw stream has no header.
+ * 
+ * \return  This function returns TRUE if the capture started and FALSE if a capture is already running or the file could not be opened.
+ */
+////////////////////////////////////////////////////////////
+BOOL startCapture(char* filenamePTR, captureFormat format, uint16 framesPerSecond)
+{
+	if(gtCapture.running || !host.pixels)
+		return FALSE;
+
+	BOOL pipe = filenamePTR[0] == '|';
+#ifdef _WIN32
+	FILE* file = pipe ? _popen(filenamePTR + 1, "wb") : fopen(filenamePTR, "wb");
+#else
+	FILE* file = pipe ? popen(filenamePTR + 1, "w") : fopen(filenamePTR, "wb");
+#endif
+	if(!file)
+		return FALSE;
+
+	size_t chroma = (size_t)((host.width + 1) / 2) * ((host.height + 1) / 2);
+	unsigned char* planes = format == CAPTURE_Y4M ? (unsigned char*)malloc((size_t)host.width * host.height + 2 * chroma) : NULL;
+	uint32_t* blackRow = (uint32_t*)calloc(host.width, sizeof(uint32_t));
+	if(!blackRow || (format == CAPTURE_Y4M && !planes))
+	{
+		free(planes);
+		free(blackRow);
+		gtCloseCapture(file, pipe);
+		return FALSE;
+	}
+
+	if(format == CAPTURE_Y4M)
+		fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", host.width, host.height, framesPerSecond ? framesPerSecond : 60);
+
+	if(!gtCapture.ready)
+	{
+		gtMonitorInit(&gtCapture.monitor);
+		gtCapture.ready = TRUE;
+	}
+
+	gtCapture.format = format;
+	gtCapture.file = file;
+	gtCapture.pipe = pipe;
+	gtCapture.width = host.width;
+	gtCapture.height = host.height;
+	gtCapture.planes = planes;
+	gtCapture.blackRow = blackRow;
+	gtCapture.frames = 0;
+	gtCapture.quit = gtCapture.fresh = gtCapture.failed = FALSE;
+
+	if(!gtStartThread(&gtCapture.thread, gtCaptureWorker, NULL))
+	{
+		free(planes);
+		free(blackRow);
+		gtCapture.planes = NULL;
+		gtCapture.blackRow = NULL;
+		gtCloseCapture(file, pipe);
+		return FALSE;
+	}
+	gtCapture.running = TRUE;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that stops recording the displayed frames.
+ * 
+ * \details The last frame handed over is written, then the stream is closed. For a command, this waits for the command to end.
+ * 
+ * \note    This function is only available on the software backends. releaseHost() stops a running capture as well.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns TRUE if every frame was written and FALSE otherwise or if no capture was running.
+ */
+////////////////////////////////////////////////////////////
+BOOL stopCapture()
+{
+	return gtStopCapture();
+}
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that moves the console cursor to another position.
+ * 
+ * \details This function moves the cursor to the specified screen coordinates. If the new coordinates are not within the screen rectangle set by the most recent updateWindowBounds()
+ *          function call, the system automatically adjusts the coordinates so that the console cursor stays within the rectangle.
+ * 
+ * \note   The console cursor's coordinates must be specified in the character grid format.(IE: x:4, y:6 is the 6th line and the 4th column).
+ * 
+ * \param[in]   x   The new x-coordinate of the cursor, in character grid coordinates format.
+ * \param[in]   y   The new y-coordinate of the cursor, in character grid coordinates format.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void moveCursor(uint16 x, uint16 y)
+{
+#ifdef _WIN32
+	COORD position;
+	position.X = x;
+	position.Y = y;
+	SetConsoleCursorPosition(host.outputHandle, position);
+#else
+	printf("\x1b[%d;%dH", y + 1, x + 1);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that changes the color of a pixel on screen.
+ * 
+ * \details This function sets the pixel at the specified coordinates to the specified color.
+ * 
+ * \note   Multiple calls of this function can be used to create custom vertex shape drawing.
+ *         For large per-pixel workloads, writing through lockPixels() avoids the function call for every pixel.
+ * 
+ * \param[in]   x          The x-coordinate, in logical units, of the points to be set.
+ * \param[in]   y          The y-coordinate, in logical units, of the points to be set.
+ * \param[in]   fillColor  The color to be used to paint the pixel. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void pixel(int16 x, int16 y, color fillColor)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_PIXEL);
+	gtAddDamage(x, y, x + 1, y + 1);
+#ifdef GRAPHTE_BACKEND_GDI
+	//! The canvas bits are written directly, pending GDI drawing has to land first.
+	if(!host.pixelsLocked)
+		GdiFlush();
+#endif
+	if(x >= 0 && y >= 0 && x < host.width && y < host.height)
+	{
+		uint32_t paint = gtPaint(fillColor);
+		uint32_t* destination = host.pixels + (size_t)y * host.stride + x;
+		*destination = gtOpaque(paint) ? paint : gtBlendPixel(*destination, paint, gtBlend.mode);
+	}
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Enumeration containing the memory layouts of the pixel buffers.
+ * 
+ * \details PIXEL_XRGB8888 stores every pixel as a 32-bit 0x00RRGGBB value, which is B, G, R, unused in memory on little-endian machines.
+ */
+////////////////////////////////////////////////////////////
+typedef enum
+{
+	PIXEL_XRGB8888 = 0
+}
+pixelFormat;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure describing the back buffer handed out by lockPixels().
+ * 
+ * \details The pixel at (x, y) is pixels[y * stride + x]. The stride is counted in pixels and can be larger than the width.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	uint32_t* pixels; //! The first pixel of the top row.
+	uint16 width, height; //! The size of the buffer, in pixels.
+	uint16 stride; //! The distance, in pixels, between the starts of two consecutive rows.
+	pixelFormat format; //! The layout of every pixel.
+}
+pixelBuffer;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that gives direct access to the pixels of the memory canvas.
+ * 
+ * \details This function returns a raw pointer to the back buffer along with its size, stride and format. Writing through it is the fastest way to
+ *          draw per-pixel content since no function call or GDI round trip is made for each pixel. Use pixelValue() to convert colors.
+ * 
+ * \note    Every lockPixels() call must be matched by an unlockPixels() call before using the other drawing functions or display().
+ *          The pointer is invalidated by update() and by window size changes.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the description of the back buffer.
+ */
+////////////////////////////////////////////////////////////
+pixelBuffer lockPixels()
+{
+	//! Nothing tells which pixels will be written, the whole buffer has to be presented.
+	gtDamageAll();
+#ifdef GRAPHTE_BACKEND_GDI
+	//! GDI batches its drawing calls, they must be completed before the CPU reads or writes the DIB bits.
+	GdiFlush();
+#endif
+	host.pixelsLocked = TRUE;
+
+	return (pixelBuffer){host.pixels, host.width, host.height, host.stride, PIXEL_XRGB8888};
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that ends the direct access started by lockPixels().
+ * 
+ * \details This function hands the back buffer back to the drawing functions. The pointer returned by lockPixels() must not be used afterwards.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void unlockPixels()
+{
+	host.pixelsLocked = FALSE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that sets how colors and images are combined with the canvas.
+ * 
+ * \details With BLEND_ALPHA (the default), a translucent color or image is drawn over the canvas by its opacity and opaque ones replace it.
+ *          BLEND_ADD adds the color to the canvas, weighted by its opacity, for glows and light effects. BLEND_MULTIPLY multiplies the canvas by the
+ *          color, for shadows and tints. The mode stays in effect for every drawing function until it is changed again.
+ * 
+ * \note    The blending loops are vectorized, see the pixel row kernels. On GDI, rectangles, pixels and text are blended in the canvas bits,
+ *          while ellipses and circles are drawn by GDI and stay opaque; images only honor setOpacity().
+ *          shade() and lockPixels() write the canvas directly and are not blended.
+ * 
+ * \param[in]   mode  The blend mode.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setBlendMode(blendMode mode)
+{
+	gtBlend.mode = mode;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that sets the opacity of everything drawn next.
+ * 
+ * \details The opacity multiplies the alpha of every color and image pixel drawn, which fades a whole overlay without changing its colors.
+ * 
+ * \param[in]   opacity  The opacity, from 0 (nothing is drawn) to 255 (the default, colors keep their own alpha).
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setOpacity(uint16 opacity)
+{
+	gtBlend.opacity = opacity > 255 ? 255 : opacity;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function draws a rectangle on the memory canvas.
+ * 
+ * \details This function draws a rectangle of the specified size to the specified coordinates. The rectangle has no outline and is filled with the given graphTe color. 
+ * 
+ * \note   This function is more efficient than multiple pixel() calls as it gives a single GPU job call.
+ *          On GDI the brush comes from a pool that keeps one brush per recently used color alive across frames.
+ *          Translucent colors, setOpacity() and setBlendMode() apply, on every backend.
+ * 
+ * \param[in]   x          The x-coordinate, in logical coordinates, of the upper-left corner of the rectangle.
+ * \param[in]   y          The y-coordinate, in logical coordinates, of the upper-left corner of the rectangle.
+ * \param[in]   width      The width, in logical units, of the rectangle.
+ * \param[in]   height     The height, in logical units, of the rectangle.
+ * \param[in]   fillColor  The color to be used to paint the rectangle. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void rect(int16 x, int16 y, uint16 width, uint16 height, color fillColor)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_RECT);
+	uint32_t paint = gtPaint(fillColor);
+
+	if(gtCommands.recording)
+	{
+		gtRectCommand* command = (gtRectCommand*)gtRecord(COMMAND_RECT, x, y, x + width, y + height, paint, sizeof(gtRectCommand));
+		if(command)
+			*command = (gtRectCommand){x, y, width, height, fillColor};
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+#ifdef GRAPHTE_SOFTWARE
+	//! An opaque rectangle covering the whole buffer overwrites the stale back buffer anyway.
+	if(gtOpaque(paint) && x <= 0 && y <= 0 && x + width >= host.width && y + height >= host.height)
+		gtDamageList.pendingCount = gtDamageList.pendingFull = 0;
+#endif
+	gtAddDamage(x, y, x + width, y + height);
+
+#ifdef GRAPHTE_BACKEND_GDI
+	RECT frame;
+
+	//! GDI has no blending brush, translucent rectangles are drawn into the canvas bits like on the software backends.
+	if(!gtOpaque(paint))
+	{
+		if(!host.pixelsLocked)
+			GdiFlush();
+		gtPaintRect(x, y, x + width, y + height, paint);
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	frame.left = x;
+	frame.top = y;
+	frame.right = x + width;
+	frame.bottom = y + height;
+
+	//! FillRect() takes the brush as a parameter, so the pooled brush does not need to be selected.
+	FillRect(host.bufferDC, &frame, gtPoolObject(gtGdiPool.brushes, &gtGdiPool.brushStats, FALSE, RGB(fillColor.red, fillColor.green, fillColor.blue), 0, 0));
+#else
+	gtPaintRect(x, y, x + width, y + height, paint);
+#endif
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints the entire screen with one color.
+ * 
+ * \details This function paints the screen with a single color. This function is usually called once every frame, to clear the previous contents of the target. 
+ * 
+ * \note   Not updating the canvas size before calling this function will result in unexpected behaviour.
+ *
+ * \param[in]   fillColor  The color to be used to clear the render target. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void fill(color fillColor)
+{
+	rect(0, 0, host.width, host.height, fillColor);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints a line between two given points.
+ * 
+ * \details This function draws a line from the first given position up to, but not including the specified second position.
+ * 
+ * \note   This function works with any line orientation, including negative points values.
+ *         Lines are rasterized by graphTe on every backend, GDI included, so colors are blended like rect() ones.
+ *         Wide lines have round ends. With setAntialiasing(), the edges are smoothed and the end point is drawn as well.
+ *         To draw connected lines, polyline() draws the whole path in one pass and rounds the joins.
+ *
+ * \param[in]   x1         Specifies the x-coordinate, in logical units, of the line's start point.
+ * \param[in]   y1         Specifies the y-coordinate, in logical units, of the line's start point.
+ * \param[in]   x2         Specifies the x-coordinate, in logical units, of the line's end point.
+ * \param[in]   y2         Specifies the y-coordinate, in logical units, of the line's end point.
+ * \param[in]   width      Specifies the width, in logical units, of the line's body.
+ * \param[in]   fillColor  The color that the line will be painted in. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void line(int16 x1, int16 y1, int16 x2, int16 y2, uint16 width, color fillColor)
+{
+	//! The pen extends half of its width (rounded up) around the segment.
+	int reach = width / 2 + 1;
+	vector2f points[2] = {{(float)x1, (float)y1}, {(float)x2, (float)y2}};
+	GRAPHTE_PROFILE_BEGIN(PROFILE_LINE);
+
+	if(gtCommands.recording)
+	{
+		gtLineCommand* command = (gtLineCommand*)gtRecord(COMMAND_LINE, (x1 < x2 ? x1 : x2) - reach, (y1 < y2 ? y1 : y2) - reach, (x1 > x2 ? x1 : x2) + reach + 1, (y1 > y2 ? y1 : y2) + reach + 1, gtPaint(fillColor), sizeof(gtLineCommand));
+		if(command)
+			*command = (gtLineCommand){x1, y1, x2, y2, width, fillColor};
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	gtAddDamage((x1 < x2 ? x1 : x2) - reach, (y1 < y2 ? y1 : y2) - reach, (x1 > x2 ? x1 : x2) + reach + 1, (y1 > y2 ? y1 : y2) + reach + 1);
+
+#ifdef GRAPHTE_BACKEND_GDI
+	//! The canvas bits are written directly, pending GDI drawing has to land first.
+	if(!host.pixelsLocked)
+		GdiFlush();
+#endif
+	gtStrokePath(points, 2, width ? width : 1, gtPaint(fillColor));
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints a path of connected lines.
+ * 
+ * \details This function draws a line from every point of the array to the next one. The whole path is rasterized in a single pass,
+ *          the joins between the lines are round and, with a translucent color, the pixels where the lines meet are blended only once.
+ * 
+ * \note   A closed shape is drawn by repeating the first point at the end of the array.
+ *         Points are not rounded, a path keeps its sub-pixel precision when setAntialiasing() is on.
+ *         Without antialiasing, a path of width 1 is drawn like consecutive line() calls.
+ *
+ * \param[in]   points     The points of the path. Whole coordinates are the centers of the pixels.
+ * \param[in]   count      The number of points in the array.
+ * \param[in]   width      Specifies the width, in logical units, of the path's body.
+ * \param[in]   fillColor  The color that the path will be painted in. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void polyline(const vector2f* points, uint16 count, float width, color fillColor)
+{
+	float left = INFINITY, top = INFINITY, right = -INFINITY, bottom = -INFINITY;
+	float reach = width / 2 + 1;
+
+	if(!count)
+		return;
+	GRAPHTE_PROFILE_BEGIN(PROFILE_POLYLINE);
+
+	for(uint16 i = 0; i < count; i++)
+	{
+		if(points[i].x < left) left = points[i].x;
+		if(points[i].y < top) top = points[i].y;
+		if(points[i].x > right) right = points[i].x;
+		if(points[i].y > bottom) bottom = points[i].y;
+	}
+
+	if(gtCommands.recording)
+	{
+		//! The recorded bounds only need to stay within the range of the integer coordinates.
+		gtPolylineCommand* command = (gtPolylineCommand*)gtRecord(COMMAND_POLYLINE, (int)fmaxf(floorf(left - reach), -65536), (int)fmaxf(floorf(top - reach), -65536),
+			(int)fminf(ceilf(right + reach + 1), 65536), (int)fminf(ceilf(bottom + reach + 1), 65536), gtPaint(fillColor), sizeof(gtPolylineCommand) + count * sizeof(vector2f));
+		if(command)
+		{
+			*command = (gtPolylineCommand){count, width, fillColor};
+			memcpy(command + 1, points, count * sizeof(vector2f));
+		}
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	//! The bounds are clamped around the window before the conversion, points can lie far outside of it.
+	left = fminf(fmaxf(floorf(left - reach), -1), host.width + 1);
+	top = fminf(fmaxf(floorf(top - reach), -1), host.height + 1);
+	right = fminf(fmaxf(ceilf(right + reach + 1), -1), host.width + 1);
+	bottom = fminf(fmaxf(ceilf(bottom + reach + 1), -1), host.height + 1);
+	gtAddDamage((int)left, (int)top, (int)right, (int)bottom);
+
+#ifdef GRAPHTE_BACKEND_GDI
+	if(!host.pixelsLocked)
+		GdiFlush();
+#endif
+	gtStrokePath(points, count, width, gtPaint(fillColor));
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that turns the antialiasing of lines on or off.
+ * 
+ * \details With antialiasing, line() and polyline() measure how much of every pixel the line covers and blend its edges accordingly,
+ *          and lines thinner than a pixel are drawn faded instead of broken. Without it (the default), pixels are either drawn or not.
+ * 
+ * \param[in]   enabled  TRUE to smooth the lines drawn next, FALSE to draw them hard.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setAntialiasing(BOOL enabled)
+{
+	gtStroke.antialias = enabled;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints an ellipse at the specified point.
+ * 
+ * \details This function draws an ellipse. The center of the ellipse is the center of the specified bounding rectangle.
+ *          The ellipse is filled with the specified fillColor and has no outline.
+ * 
+ * \note   This function accepts inverse-scale bounding rectangles.
+ *
+ * \param[in]   x          Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   y          Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   width      The width, in logical units, of the bounding rectangle.
+ * \param[in]   height     The height, in logical units, of the bounding rectangle.
+ * \param[in]   fillColor  The color that the ellipse will be painted in. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void ellipse(int16 x, int16 y, uint16 width, uint16 height, color fillColor)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_ELLIPSE);
+	if(gtCommands.recording)
+	{
+		gtRectCommand* command = (gtRectCommand*)gtRecord(COMMAND_ELLIPSE, x, y, x + width, y + height, gtPaint(fillColor), sizeof(gtRectCommand));
+		if(command)
+			*command = (gtRectCommand){x, y, width, height, fillColor};
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	gtAddDamage(x, y, x + width, y + height);
+
+#ifdef GRAPHTE_BACKEND_GDI
+	gtSelectPen(RGB(fillColor.red, fillColor.green, fillColor.blue), 1, PS_SOLID);
+	gtSelectBrush(RGB(fillColor.red, fillColor.green, fillColor.blue));
+	Ellipse(host.bufferDC, x, y, x + width, y + height);
+#else
+	gtRasterEllipse(x, y, width, height, gtPaint(fillColor));
+#endif
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints a circle at the specified point.
+ * 
+ * \details This function draws a circle. The center of the ellipse is the center of the specified bounding rectangle.
+ * 			The bounding rectangle's width and height are equal to the diameter of the circle.
+ *          The ellipse is filled with the specified fillColor and has no outline.
+ * 
+ * \note   This function accepts inverse-scale bounding rectangles.
+ *          This function serves as a convienience wrapper for the ellipse function.
+ *
+ * \param[in]   x          Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   y          Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   radius     The size, in logical units, of the circle's radius. (The width\height of the bounding rectangle will be twice the amount of this)
+ * \param[in]   fillColor  The color that the circle will be painted in. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void circle(int16 x, int16 y, uint16 radius, color fillColor)
+{
+	ellipse(x, y, 2 * radius, 2 * radius, fillColor);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints a triangle between three points.
+ * 
+ * \details This function draws a triangle filled with the specified fillColor, without outline. A pixel is painted when its center is inside the triangle.
+ * 
+ * \note   Triangles sharing an edge neither overlap nor leave a gap between them, which makes them suitable for meshes of any shape.
+ *         The triangle is rasterized by graphTe on every backend, translucent colors and setBlendMode() apply. It is not tested against the depth buffer.
+ *
+ * \param[in]   a          The first corner. Whole coordinates are the centers of the pixels.
+ * \param[in]   b          The second corner.
+ * \param[in]   c          The third corner.
+ * \param[in]   fillColor  The color that the triangle will be painted in. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void triangle(vector2f a, vector2f b, vector2f c, color fillColor)
+{
+	vertex corners[3] = {{a.x, a.y, 0, fillColor}, {b.x, b.y, 0, fillColor}, {c.x, c.y, 0, fillColor}};
+	GRAPHTE_PROFILE_BEGIN(PROFILE_TRIANGLE);
+
+	if(gtCommands.recording)
+		gtRecordTriangle(COMMAND_TRIANGLE, corners);
+	else
+		gtRasterTriangle(corners, FALSE);
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function paints a triangle with a color and a depth at every corner.
+ * 
+ * \details This function draws a triangle whose color goes smoothly from the color of one corner to the others (Gouraud shading).
+ *          Giving the three corners the same color draws it flat. When a depth buffer is set, every pixel is only painted if it is nearer than
+ *          what was drawn there before, so a 3D scene can be drawn in any order.
+ * 
+ * \note   The colors and the depth are interpolated linearly on the screen, the corners should be projected already.
+ *         Translucent corners are blended, and still write their depth.
+ *
+ * \param[in]   a  The first corner, see vertex.
+ * \param[in]   b  The second corner.
+ * \param[in]   c  The third corner.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void shadedTriangle(vertex a, vertex b, vertex c)
+{
+	vertex corners[3] = {a, b, c};
+	GRAPHTE_PROFILE_BEGIN(PROFILE_SHADED_TRIANGLE);
+
+	if(gtCommands.recording)
+		gtRecordTriangle(COMMAND_SHADED_TRIANGLE, corners);
+	else
+		gtRasterTriangle(corners, TRUE);
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that attaches a depth buffer to the canvas, or removes it.
+ * 
+ * \details The depth buffer keeps the depth of the nearest triangle drawn on every pixel, see shadedTriangle(). It has the size of the canvas
+ *          and follows it when the window is resized. It starts cleared, and is then cleared by clearDepth(), usually once every frame.
+ * 
+ * \param[in]   format  DEPTH_16 or DEPTH_32 for the precision of the depth values, DEPTH_NONE to release the buffer.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setDepthBuffer(depthFormat format)
+{
+	if(format == gtDepth.format)
+		return;
+
+	free(gtDepth.values);
+	gtDepth.values = NULL;
+	gtDepth.width = gtDepth.height = 0;
+	gtDepth.format = format;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that resets the depth buffer to the farthest depth.
+ * 
+ * \details This function forgets the depth of everything drawn so far, the next triangles are drawn wherever they are. It is usually called
+ *          together with fill() at the start of every frame.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void clearDepth()
+{
+	if(gtDepth.values)
+		gtClearDepth();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the counters of the pen pool.
+ * 
+ * \details Every ellipse() call requests a pen of a given color, width and style. A hit reuses a pooled pen, a miss creates one.
+ * 
+ * \note    Only the GDI backend uses pens, the counters stay at 0 on the software backends.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the hit and miss counts since the start of the program.
+ */
+////////////////////////////////////////////////////////////
+cacheStats getPenCacheStats()
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	return gtGdiPool.penStats;
+#else
+	return (cacheStats){0, 0};
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the counters of the brush pool.
+ * 
+ * \details Every rect(), fill() and ellipse() call requests a solid brush of a given color. A hit reuses a pooled brush, a miss creates one.
+ * 
+ * \note    Only the GDI backend uses brushes, the counters stay at 0 on the software backends.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the hit and miss counts since the start of the program.
+ */
+////////////////////////////////////////////////////////////
+cacheStats getBrushCacheStats()
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	return gtGdiPool.brushStats;
+#else
+	return (cacheStats){0, 0};
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// Asset archives
+////////////////////////////////////////////////////////////
+
+//! "GTPK", the first bytes of an archive written by tools/pack.
+#define GRAPHTE_ARCHIVE_MAGIC 0x4B505447u
+#define GRAPHTE_ARCHIVE_VERSION 1
+//! Every payload starts at a multiple of this offset, so the pixels of an image can be drawn straight from the mapping.
+#define GRAPHTE_ARCHIVE_ALIGNMENT 64
+
+//! The flags of an archive entry.
+#define GRAPHTE_ARCHIVE_PIXELS 1 //! The payload is a decoded image: width * height premultiplied pixels (see gtPaint()), not the file itself.
+#define GRAPHTE_ARCHIVE_TRANSLUCENT 2 //! Some pixels of the image are not opaque.
+#define GRAPHTE_ARCHIVE_LZ4 4 //! The payload is an LZ4 block, rawSize bytes once decompressed.
+
+//! The header at the start of an archive. Every offset is counted in bytes from the start of the file, every value is little-endian.
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t bucketCount; //! A power of two larger than entryCount. mountArchive() requires an empty bucket, so a lookup always ends on one.
+	uint32_t bucketOffset; //! The name index: bucketCount entry numbers plus 1, 0 for an empty bucket, probed linearly from the hash of the name.
+	uint32_t entryOffset; //! entryCount gtArchiveEntry structures.
+	uint32_t reserved[2];
+}
+gtArchiveHeader;
+
+//! A file stored in an archive.
+typedef struct
+{
+	uint32_t hash; //! gtHash() of the name.
+	uint32_t nameOffset; //! The name, without a terminating zero.
+	uint32_t nameLength;
+	uint32_t flags; //! GRAPHTE_ARCHIVE_ flags.
+	uint16_t width, height; //! The size of a decoded image.
+	uint32_t offset; //! The payload, aligned to GRAPHTE_ARCHIVE_ALIGNMENT.
+	uint32_t size; //! The size of the payload.
+	uint32_t rawSize; //! The size of the content, equal to size unless the payload is compressed.
+}
+gtArchiveEntry;
+
+//! The archive mounted by mountArchive(), searched before the file system by every function loading a file.
+struct
+{
+	gtMappedFile file; //! NULL data when no archive is mounted.
+	const gtArchiveHeader* header;
+	const uint32_t* buckets;
+	const gtArchiveEntry* entries;
+	unsigned char** unpacked; //! The decompressed content of every compressed entry read by readArchiveFile(), NULL until then.
+}
+gtArchive;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that hashes a string.
+ * 
+ * \details This function computes the 32-bit FNV-1a hash of a zero-terminated string.
+ * 
+ * \param[in]    text  The string to be hashed.
+ * 
+ * \return       Returns the hash of the string.
+ */
+////////////////////////////////////////////////////////////
+uint32_t gtHash(const char* text)
+{
+	uint32_t hash = 2166136261u;
+	while(*text)
+		hash = (hash ^ (unsigned char)*text++) * 16777619u;
+
+	return hash;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that looks a name up in the mounted archive.
+ * 
+ * \details The hash of the name selects a bucket of the index, the buckets are then probed until the name or an empty bucket is found,
+ *          so the lookup does not depend on the number of entries and never touches the file system.
+ * 
+ * \param[in]    name  The name of the file, the path it would be opened with.
+ * 
+ * \return       Returns the entry, or NULL if no archive is mounted or the name is not in it.
+ */
+////////////////////////////////////////////////////////////
+const gtArchiveEntry* gtFindArchiveEntry(const char* name)
+{
+	if(!gtArchive.file.data)
+		return NULL;
+
+	uint32_t hash = gtHash(name), mask = gtArchive.header->bucketCount - 1;
+	size_t length = strlen(name);
+
+	//! mountArchive() checked that some bucket is empty, the probe is also bounded by the number of buckets.
+	for(uint32_t i = hash & mask, probes = 0; gtArchive.buckets[i] && probes <= mask; i = (i + 1) & mask, probes++)
+	{
+		const gtArchiveEntry* entry = &gtArchive.entries[gtArchive.buckets[i] - 1];
+		if(entry->hash == hash && entry->nameLength == length && !memcmp(gtArchive.file.data + entry->nameOffset, name, length))
+			return entry;
+	}
+
+	return NULL;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that decompresses an LZ4 block.
+ * 
+ * \details A block is a list of sequences: a token holding the literal and match lengths (extended by bytes of 255 when they reach 15),
+ *          the literals, then the 16-bit distance of the match, which copies bytes already written. The last sequence has no match.
+ *          Every length and distance is checked, so a corrupt block fails instead of reading or writing out of bounds.
+ * 
+ * \param[in]    source       The block.
+ * \param[in]    size         The size of the block.
+ * \param[out]   destination  Receives the content.
+ * \param[in]    capacity     The exact size of the content.
+ * 
+ * \return       Returns TRUE if the block decompressed to exactly capacity bytes.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtDecompressLZ4(const unsigned char* source, size_t size, unsigned char* destination, size_t capacity)
+{
+	const unsigned char* end = source + size;
+	size_t written = 0;
+
+	while(source < end)
+	{
+		unsigned int token = *source++;
+
+		size_t literals = token >> 4;
+		if(literals == 15)
+		{
+			unsigned char extension;
+			do
+			{
+				if(source == end)
+					return FALSE;
+				extension = *source++;
+				literals += extension;
+			}
+			while(extension == 255);
+		}
+		if(literals > (size_t)(end - source) || literals > capacity - written)
+			return FALSE;
+		memcpy(destination + written, source, literals);
+		source += literals;
+		written += literals;
+
+		if(source == end)
+			break;
+
+		if(end - source < 2)
+			return FALSE;
+		size_t distance = source[0] | source[1] << 8;
+		source += 2;
+		if(!distance || distance > written)
+			return FALSE;
+
+		size_t length = (token & 15) + 4;
+		if((token & 15) == 15)
+		{
+			unsigned char extension;
+			do
+			{
+				if(source == end)
+					return FALSE;
+				extension = *source++;
+				length += extension;
+			}
+			while(extension == 255);
+		}
+		if(length > capacity - written)
+			return FALSE;
+
+		//! A match closer than its length repeats the bytes it writes, so it is copied byte by byte.
+		for(size_t i = 0; i < length; i++, written++)
+			destination[written] = destination[written - distance];
+	}
+
+	return written == capacity;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the content of an archive entry.
+ * 
+ * \details An uncompressed payload is returned where it is mapped, a compressed one is decompressed into a new buffer.
+ * 
+ * \param[in]    entry  The entry, from gtFindArchiveEntry().
+ * \param[out]   owned  Receives TRUE if the content is a new buffer that must be released with free().
+ * 
+ * \return       Returns the content, or NULL if it could not be decompressed.
+ */
+////////////////////////////////////////////////////////////
+const unsigned char* gtArchiveContent(const gtArchiveEntry* entry, BOOL* owned)
+{
+	*owned = FALSE;
+	if(!(entry->flags & GRAPHTE_ARCHIVE_LZ4))
+		return gtArchive.file.data + entry->offset;
+
+	unsigned char* content = (unsigned char*)malloc(entry->rawSize ? entry->rawSize : 1);
+	if(!content || !gtDecompressLZ4(gtArchive.file.data + entry->offset, entry->size, content, entry->rawSize))
+	{
+		free(content);
+		return NULL;
+	}
+
+	*owned = TRUE;
+	return content;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that resizes an image, using the nearest pixel.
+ * 
+ * \details The pixels sampled are the ones gtLoadBitmap() samples from the file, so an image stored decoded in an archive and resized
+ *          is the same as the file decoded at that size.
+ * 
+ * \param[in]    source        The image.
+ * \param[in]    sourceWidth   The width of the image.
+ * \param[in]    sourceHeight  The height of the image.
+ * \param[in]    width         The width of the result.
+ * \param[in]    height        The height of the result.
+ * 
+ * \return       Returns the new image, to be released with free(), or NULL if it could not be allocated.
+ */
+////////////////////////////////////////////////////////////
+uint32_t* gtResamplePixels(const uint32_t* source, uint16 sourceWidth, uint16 sourceHeight, uint16 width, uint16 height)
+{
+	uint32_t* pixels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+	if(!pixels)
+		return NULL;
+
+	for(int y = 0; y < height; y++)
+	{
+		const uint32_t* row = source + (size_t)((int64_t)y * sourceHeight / height) * sourceWidth;
+		for(int x = 0; x < width; x++)
+			pixels[(size_t)y * width + x] = row[(int64_t)x * sourceWidth / width];
+	}
+
+	return pixels;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves an image stored decoded in the mounted archive.
+ * 
+ * \details An uncompressed image requested at its stored size is returned where it is mapped, without any copy.
+ *          Otherwise the image is decompressed and resized into a new array.
+ * 
+ * \param[in]    entry           The entry of the image, with the GRAPHTE_ARCHIVE_PIXELS flag.
+ * \param[in]    width           The width of the resulting pixel array, 0 keeps the stored width.
+ * \param[in]    height          The height of the resulting pixel array, 0 keeps the stored height.
+ * \param[out]   outWidth        Receives the width of the resulting pixel array.
+ * \param[out]   outHeight       Receives the height of the resulting pixel array.
+ * \param[out]   outTranslucent  Receives TRUE if some pixels are not opaque.
+ * \param[out]   outOwned        Receives TRUE if the array must be released with free(), FALSE if it belongs to the archive.
+ * 
+ * \return       Returns the pixels, or NULL if they could not be decompressed or allocated.
+ */
+////////////////////////////////////////////////////////////
+uint32_t* gtLoadPackedImage(const gtArchiveEntry* entry, uint16 width, uint16 height, uint16* outWidth, uint16* outHeight, BOOL* outTranslucent, BOOL* outOwned)
+{
+	if(!width)
+		width = entry->width;
+	if(!height)
+		height = entry->height;
+
+	BOOL owned;
+	uint32_t* pixels = (uint32_t*)gtArchiveContent(entry, &owned);
+	if(pixels && (width != entry->width || height != entry->height))
+	{
+		uint32_t* resized = gtResamplePixels(pixels, entry->width, entry->height, width, height);
+		if(owned)
+			free(pixels);
+		pixels = resized;
+		owned = TRUE;
+	}
+
+	*outWidth = width;
+	*outHeight = height;
+	*outTranslucent = (entry->flags & GRAPHTE_ARCHIVE_TRANSLUCENT) != 0;
+	*outOwned = owned;
+	return pixels;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that reads a whole asset file.
+ * 
+ * \details The mounted archive is searched first, a file found there is not copied unless it is compressed. Otherwise the file is read from disk.
+ * 
+ * \param[in]    path   The path of the file.
+ * \param[out]   size   Receives the size of the content.
+ * \param[out]   owned  Receives TRUE if the content must be released with free().
+ * 
+ * \return       Returns the content, or NULL if the file could not be read.
+ */
+////////////////////////////////////////////////////////////
+const char* gtReadAsset(const char* path, size_t* size, BOOL* owned)
+{
+	const gtArchiveEntry* entry = gtFindArchiveEntry(path);
+	if(entry && !(entry->flags & GRAPHTE_ARCHIVE_PIXELS))
+	{
+		*size = entry->rawSize;
+		return (const char*)gtArchiveContent(entry, owned);
+	}
+
+	FILE* file = fopen(path, "rb");
+	if(!file)
+		return NULL;
+
+	long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+	char* content = length >= 0 ? (char*)malloc((size_t)length + 1) : NULL;
+	if(content)
+	{
+		rewind(file);
+		*size = fread(content, 1, (size_t)length, file);
+		*owned = TRUE;
+	}
+
+	fclose(file);
+	return content;
+}
+
+////////////////////////////////////////////////////////////
+// Textures
+////////////////////////////////////////////////////////////
+
+//! The number of decoded images kept by the texture cache.
+#ifndef GRAPHTE_TEXTURE_CACHE_SIZE
+	#define GRAPHTE_TEXTURE_CACHE_SIZE 64
+#endif
+
+//! A handle to a decoded image, as returned by loadTexture(). Negative values are invalid handles.
+typedef int16 texture;
+
+//! A decoded image kept by the texture cache.
+typedef struct
+{
+	char* path; //! The file the image was decoded from, NULL for an empty slot.
+	uint32_t hash; //! The hash of the path, checked before comparing paths.
+	uint16 requestedWidth, requestedHeight; //! The size the image was requested with (0 keeps the file size).
+	uint16 width, height; //! The size of the decoded image.
+#ifdef GRAPHTE_BACKEND_GDI
+	HBITMAP bitmap; //! The decoded image.
+#else
+	uint32_t* pixels; //! The decoded image, width * height premultiplied pixels (see gtPaint()).
+	BOOL translucent; //! TRUE if some pixels of the image are not opaque.
+	gtMappedFile mapping; //! The file the pixels point into when it already held them in memory order, see gtLoadBitmap().
+	BOOL packed; //! TRUE when the pixels point into the mounted archive, see mountArchive().
+#endif
+	uint16 references; //! The number of loadTexture() calls not yet matched by freeTexture(). Referenced entries are never evicted.
+	unsigned long lastUse; //! The value of the use counter the last time the entry was drawn.
+}
+gtTexture;
+
+//! The texture cache, shared by the handle based and the file name based drawing functions.
+struct
+{
+	gtTexture entries[GRAPHTE_TEXTURE_CACHE_SIZE];
+	unsigned long uses; //! Incremented on every use to order the entries from least to most recently used.
+	cacheStats stats;
+}
+gtTextures;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that decodes the image file of a texture entry.
+ * 
+ * \details This function loads entry->path at the requested size and fills the image and its size in.
+ *          An image stored in the mounted archive is taken from there, the file system is only used for the others.
+ * 
+ * \param[in,out]  entry  The entry to be decoded, with the path and requested size already set.
+ * 
+ * \return         Returns TRUE if the image was decoded and FALSE otherwise.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtDecodeTexture(gtTexture* entry)
+{
+	const gtArchiveEntry* packed = gtFindArchiveEntry(entry->path);
+
+#ifdef GRAPHTE_BACKEND_GDI
+	BITMAP info;
+
+	if(packed && (packed->flags & GRAPHTE_ARCHIVE_PIXELS))
+	{
+		BOOL translucent, owned;
+		uint32_t* pixels = gtLoadPackedImage(packed, entry->requestedWidth, entry->requestedHeight, &entry->width, &entry->height, &translucent, &owned);
+		if(!pixels)
+			return FALSE;
+
+		//! The image is copied into a top-down DIB section, which GDI draws opaque like the bitmaps it loads itself.
+		BITMAPINFO bitmapInfo;
+		memset(&bitmapInfo, 0, sizeof(bitmapInfo));
+		bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		bitmapInfo.bmiHeader.biWidth = entry->width;
+		bitmapInfo.bmiHeader.biHeight = -entry->height;
+		bitmapInfo.bmiHeader.biPlanes = 1;
+		bitmapInfo.bmiHeader.biBitCount = 32;
+		bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+		uint32_t* bits = NULL;
+		entry->bitmap = CreateDIBSection(host.hdc, &bitmapInfo, DIB_RGB_COLORS, (void**)&bits, NULL, 0);
+		if(entry->bitmap)
+			for(size_t i = 0; i < (size_t)entry->width * entry->height; i++)
+				bits[i] = pixels[i] & 0xFFFFFF;
+
+		if(owned)
+			free(pixels);
+		return entry->bitmap != NULL;
+	}
+
+	entry->bitmap = LoadImageA(NULL, entry->path, IMAGE_BITMAP, entry->requestedWidth, entry->requestedHeight, LR_LOADFROMFILE);
+	if(!entry->bitmap)
+		return FALSE;
+
+	GetObject(entry->bitmap, sizeof(info), &info);
+	entry->width = info.bmWidth;
+	entry->height = info.bmHeight;
+	return TRUE;
+#else
+	if(packed && (packed->flags & GRAPHTE_ARCHIVE_PIXELS))
+	{
+		BOOL owned;
+		entry->pixels = gtLoadPackedImage(packed, entry->requestedWidth, entry->requestedHeight, &entry->width, &entry->height, &entry->translucent, &owned);
+		entry->packed = !owned;
+		return entry->pixels != NULL;
+	}
+
+	entry->pixels = gtLoadBitmap(entry->path, entry->requestedWidth, entry->requestedHeight, &entry->width, &entry->height, &entry->translucent, &entry->mapping);
+	return entry->pixels != NULL;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that releases the decoded image of a texture entry.
+ * 
+ * \details This function frees the image and the path of the entry, which becomes an empty slot.
+ * 
+ * \param[in,out]  entry  The entry to be released.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtReleaseTexture(gtTexture* entry)
+{
+#ifdef GRAPHTE_BACKEND_GDI
+	//! A bitmap can't be deleted while it is selected into a device context.
+	if(host.selectedImage == entry->bitmap)
+	{
+		SelectObject(host.imageDC, host.defaultImage);
+		host.selectedImage = NULL;
+	}
+	DeleteObject(entry->bitmap);
+	entry->bitmap = NULL;
+#else
+	if(entry->mapping.data)
+		gtUnmapFile(&entry->mapping);
+	else if(!entry->packed)
+		free(entry->pixels);
+	entry->pixels = NULL;
+	entry->packed = FALSE;
+#endif
+	free(entry->path);
+	entry->path = NULL;
+	entry->references = 0;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds or creates the cache entry of an image.
+ * 
+ * \details This function looks the path and size up in the texture cache. On a miss the image is decoded into an empty slot or, when the cache is full,
+ *          into the least recently used entry that is not referenced by a loadTexture() handle.
+ * 
+ * \param[in]    path    The path of the image file.
+ * \param[in]    width   The requested width of the image.
+ * \param[in]    height  The requested height of the image.
+ * 
+ * \return       Returns the handle of the entry, or -1 if the image could not be decoded or every entry is referenced.
+ */
+////////////////////////////////////////////////////////////
+texture gtFindTexture(const char* path, uint16 width, uint16 height)
+{
+	uint32_t hash = gtHash(path);
+	int victim = -1;
+
+	for(int i = 0; i < GRAPHTE_TEXTURE_CACHE_SIZE; i++)
+	{
+		gtTexture* entry = &gtTextures.entries[i];
+
+		if(entry->path && entry->hash == hash && entry->requestedWidth == width && entry->requestedHeight == height && !strcmp(entry->path, path))
+		{
+			gtTextures.stats.hits++;
+			entry->lastUse = ++gtTextures.uses;
+			return i;
+		}
+
+		if(!entry->path)
+		{
+			if(victim < 0 || gtTextures.entries[victim].path)
+				victim = i;
+		}
+		else if(!entry->references && (victim < 0 || (gtTextures.entries[victim].path && entry->lastUse < gtTextures.entries[victim].lastUse)))
+			victim = i;
+	}
+
+	gtTextures.stats.misses++;
+	if(victim < 0)
+		return -1;
+
+	gtTexture* entry = &gtTextures.entries[victim];
+	if(entry->path)
+		gtReleaseTexture(entry);
+
+	entry->path = (char*)malloc(strlen(path) + 1);
+	strcpy(entry->path, path);
+	entry->hash = hash;
+	entry->requestedWidth = width;
+	entry->requestedHeight = height;
+
+	if(!gtDecodeTexture(entry))
+	{
+		free(entry->path);
+		entry->path = NULL;
+		return -1;
+	}
+
+	entry->lastUse = ++gtTextures.uses;
+	return victim;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that copies a region of a decoded image to the memory canvas.
+ * 
+ * \details This function draws a rectangle of the image of a texture entry at its decoded size, optionally skipping every pixel of the transparent color.
+ *          The software backends blend the image by its alpha channel, the opacity and the blend mode. GDI draws the image opaque and only applies
+ *          the opacity, through AlphaBlend(), to images drawn without a transparent color.
+ * 
+ * \param[in]    x                The x-coordinate of the region's upper-left corner on the canvas.
+ * \param[in]    y                The y-coordinate of the region's upper-left corner on the canvas.
+ * \param[in]    entry            The entry holding the image.
+ * \param[in]    sourceX          The x-coordinate of the region in the image.
+ * \param[in]    sourceY          The y-coordinate of the region in the image.
+ * \param[in]    width            The width of the region, the region must lie inside the image.
+ * \param[in]    height           The height of the region.
+ * \param[in]    transparent      TRUE if the pixels matching transparentColor must be skipped.
+ * \param[in]    transparentColor The color treated as transparent.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtDrawTextureRegion(int16 x, int16 y, gtTexture* entry, uint16 sourceX, uint16 sourceY, uint16 width, uint16 height, BOOL transparent, color transparentColor)
+{
+	gtAddDamage(x, y, x + width, y + height);
+
+#ifdef GRAPHTE_BACKEND_GDI
+	if(host.selectedImage != entry->bitmap)
+	{
+		HGDIOBJ previous = SelectObject(host.imageDC, entry->bitmap);
+		if(!host.defaultImage)
+			host.defaultImage = previous;
+		host.selectedImage = entry->bitmap;
+	}
+
+	if(transparent)
+		TransparentBlt(host.bufferDC, x, y, width, height, host.imageDC, sourceX, sourceY, width, height, RGB(transparentColor.red, transparentColor.green, transparentColor.blue));
+	else if(gtBlend.opacity < 255)
+	{
+		BLENDFUNCTION blend = {AC_SRC_OVER, 0, (BYTE)gtBlend.opacity, 0};
+		AlphaBlend(host.bufferDC, x, y, width, height, host.imageDC, sourceX, sourceY, width, height, blend);
+	}
+	else
+		BitBlt(host.bufferDC, x, y, width, height, host.imageDC, sourceX, sourceY, SRCCOPY);
+#else
+	gtBlit(x, y, width, height, entry->pixels + (size_t)sourceY * entry->width + sourceX, entry->width, entry->translucent, transparent, pixelValue(transparentColor));
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that copies a decoded image to the memory canvas.
+ * 
+ * \details This function draws the image of a texture entry at its decoded size, optionally skipping every pixel of the transparent color.
+ * 
+ * \param[in]    x                The x-coordinate of the image's upper-left corner.
+ * \param[in]    y                The y-coordinate of the image's upper-left corner.
+ * \param[in]    entry            The entry holding the image.
+ * \param[in]    transparent      TRUE if the pixels matching transparentColor must be skipped.
+ * \param[in]    transparentColor The color treated as transparent.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtDrawTexture(int16 x, int16 y, gtTexture* entry, BOOL transparent, color transparentColor)
+{
+	gtDrawTextureRegion(x, y, entry, 0, 0, entry->width, entry->height, transparent, transparentColor);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that loads an image into a reusable texture.
+ * 
+ * \details This function decodes a bitmap file once and returns a handle that can be drawn any number of times with drawTexture() or
+ *          drawTransparentTexture(), without any further disk access or decoding. The image is resampled to the given size.
+ * 
+ * \note    Loading the same file at the same size again returns the same handle. A texture stays in memory until every loadTexture() call
+ *          for it has been matched by a freeTexture() call; it then remains cached until the cache needs its slot.
+ * 
+ * \param[in]   filenamePTR  A reference to a constant file path that will be used to retrieve the bitmap.
+ * \param[in]   width        The width, in logical units, of the texture. 0 keeps the width of the file.
+ * \param[in]   height       The height, in logical units, of the texture. 0 keeps the height of the file.
+ * 
+ * \return  This function returns the texture handle, or -1 if the file could not be loaded or all GRAPHTE_TEXTURE_CACHE_SIZE slots are in use.
+ */
+////////////////////////////////////////////////////////////
+texture loadTexture(char* filenamePTR, uint16 width, uint16 height)
+{
+	texture handle = gtFindTexture(filenamePTR, width, height);
+	if(handle >= 0)
+		gtTextures.entries[handle].references++;
+
+	return handle;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that releases a texture handle.
+ * 
+ * \details This function matches a previous loadTexture() call. Once every handle to the image has been released, the cache is free to evict it.
+ * 
+ * \note    The handle must not be used after this call.
+ * 
+ * \param[in]   handle  The texture handle returned by loadTexture().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void freeTexture(texture handle)
+{
+	if(handle >= 0 && handle < GRAPHTE_TEXTURE_CACHE_SIZE && gtTextures.entries[handle].references)
+		gtTextures.entries[handle].references--;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the size of a texture.
+ * 
+ * \param[in]   handle  The texture handle returned by loadTexture().
+ * 
+ * \return  This function returns a structure containing the width and height of the texture, or 0/0 for an invalid handle.
+ */
+////////////////////////////////////////////////////////////
+vector2u getTextureSize(texture handle)
+{
+	if(handle < 0 || handle >= GRAPHTE_TEXTURE_CACHE_SIZE || !gtTextures.entries[handle].path)
+		return (vector2u){0, 0};
+
+	return (vector2u){gtTextures.entries[handle].width, gtTextures.entries[handle].height};
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a texture at the specified point.
+ * 
+ * \details This function copies a texture loaded with loadTexture() to the memory canvas, at the size it was loaded with.
+ * 
+ * \param[in]   x       Specifies the x-coordinate, in logical units, of the texture's upper-left corner.
+ * \param[in]   y       Specifies the y-coordinate, in logical units, of the texture's upper-left corner.
+ * \param[in]   handle  The texture handle returned by loadTexture().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void drawTexture(int16 x, int16 y, texture handle)
+{
+	if(handle < 0 || handle >= GRAPHTE_TEXTURE_CACHE_SIZE || !gtTextures.entries[handle].path)
+		return;
+	GRAPHTE_PROFILE_BEGIN(PROFILE_TEXTURE);
+
+	if(gtCommands.recording)
+	{
+		gtTexture* entry = &gtTextures.entries[handle];
+		gtTextureCommand* command = (gtTextureCommand*)gtRecord(COMMAND_TEXTURE, x, y, x + entry->width, y + entry->height, handle, sizeof(gtTextureCommand));
+		if(command)
+			*command = (gtTextureCommand){x, y, handle, FALSE, rgb(0, 0, 0)};
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	gtTextures.entries[handle].lastUse = ++gtTextures.uses;
+	gtDrawTexture(x, y, &gtTextures.entries[handle], FALSE, rgb(0, 0, 0));
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a texture with transparency at the specified point.
+ * 
+ * \details This function copies a texture loaded with loadTexture() to the memory canvas, skipping every pixel that matches the transparentColor.
+ * 
+ * \param[in]   x                Specifies the x-coordinate, in logical units, of the texture's upper-left corner.
+ * \param[in]   y                Specifies the y-coordinate, in logical units, of the texture's upper-left corner.
+ * \param[in]   handle           The texture handle returned by loadTexture().
+ * \param[in]   transparentColor The color that will be replaced with transparency at the render step. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void drawTransparentTexture(int16 x, int16 y, texture handle, color transparentColor)
+{
+	if(handle < 0 || handle >= GRAPHTE_TEXTURE_CACHE_SIZE || !gtTextures.entries[handle].path)
+		return;
+	GRAPHTE_PROFILE_BEGIN(PROFILE_TEXTURE);
+
+	if(gtCommands.recording)
+	{
+		gtTexture* entry = &gtTextures.entries[handle];
+		gtTextureCommand* command = (gtTextureCommand*)gtRecord(COMMAND_TEXTURE, x, y, x + entry->width, y + entry->height, handle, sizeof(gtTextureCommand));
+		if(command)
+			*command = (gtTextureCommand){x, y, handle, TRUE, transparentColor};
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	gtTextures.entries[handle].lastUse = ++gtTextures.uses;
+	gtDrawTexture(x, y, &gtTextures.entries[handle], TRUE, transparentColor);
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the counters of the texture cache.
+ * 
+ * \details Every image(), transparentImage() and loadTexture() call is either a hit, served from the cache, or a miss, which decodes the file.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the hit and miss counts since the start of the program.
+ */
+////////////////////////////////////////////////////////////
+cacheStats getTextureCacheStats()
+{
+	return gtTextures.stats;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a bitmap file without keeping it in the texture cache.
+ * 
+ * \details This function is the fallback of image() and transparentImage() for the case where every cache slot is referenced by a texture handle.
+ * 
+ * \param[in]    x                The x-coordinate of the image's upper-left corner.
+ * \param[in]    y                The y-coordinate of the image's upper-left corner.
+ * \param[in]    width            The requested width of the image.
+ * \param[in]    height           The requested height of the image.
+ * \param[in]    filenamePTR      The path of the bitmap file.
+ * \param[in]    transparent      TRUE if the pixels matching transparentColor must be skipped.
+ * \param[in]    transparentColor The color treated as transparent.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtDrawUncached(int16 x, int16 y, uint16 width, uint16 height, char* filenamePTR, BOOL transparent, color transparentColor)
+{
+	gtTexture entry;
+	memset(&entry, 0, sizeof(entry));
+	entry.path = (char*)malloc(strlen(filenamePTR) + 1);
+	strcpy(entry.path, filenamePTR);
+	entry.requestedWidth = width;
+	entry.requestedHeight = height;
+
+	if(gtDecodeTexture(&entry))
+	{
+		gtDrawTexture(x, y, &entry, transparent, transparentColor);
+		gtReleaseTexture(&entry);
+	}
+	else
+		free(entry.path);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function draws an image at the specified point.
+ * 
+ * \details This function renders a external bitmap buffer to the specified screen bounding rectangle. This function can load from a file a
+ * 	        bitmap, icon, cursor or animated cursor. The primary use of this function is to render images on screen.
+ * 
+ * \note   This function accepts inverse-scale bounding rectangles.
+ *         The decoded image is kept in the texture cache (keyed by path and size), so the file is only read the first time it is drawn.
+ *
+ * \param[in]   x            Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   y            Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   width        The width, in logical units, of the bounding rectangle.
+ * \param[in]   height       The height, in logical units, of the bounding rectangle.
+ * \param[in]   filenamePTR  A reference to a constant file path that will be used to retrieve the bitmap.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void image(int16 x, int16 y, uint16 width, uint16 height, char* filenamePTR)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_IMAGE);
+	if(gtCommands.recording)
+	{
+		size_t length = strlen(filenamePTR) + 1;
+		gtImageCommand* command = (gtImageCommand*)gtRecord(COMMAND_IMAGE, x, y, x + width, y + height, gtHash(filenamePTR), sizeof(gtImageCommand) + length);
+		if(command)
+		{
+			*command = (gtImageCommand){x, y, width, height, FALSE, rgb(0, 0, 0)};
+			memcpy(command + 1, filenamePTR, length);
+		}
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	texture handle = gtFindTexture(filenamePTR, width, height);
+
+	if(handle >= 0)
+		gtDrawTexture(x, y, &gtTextures.entries[handle], FALSE, rgb(0, 0, 0));
+	else
+		gtDrawUncached(x, y, width, height, filenamePTR, FALSE, rgb(0, 0, 0));
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function draws an image with transparency at the specified point.
+ * 
+ * \details This function renders a external bitmap buffer to the specified screen bounding rectangle. This function can load from a file a
+ * 	        bitmap, icon, cursor or animated cursor. The primary use of this function is to render images on screen. This function acts different from the 
+ *          image() function by the use of an additional parameter transparentColor. The bitmap image will have every pixel that matches the transparentColor
+ *          skipped, making a similar effect to transparent image formats.
+ * 
+ * \note   This function accepts inverse-scale bounding rectangles.
+ *         The decoded image is kept in the texture cache (keyed by path and size), so the file is only read the first time it is drawn.
+ *
+ * \param[in]   x                Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   y                Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   width            The width, in logical units, of the bounding rectangle.
+ * \param[in]   height           The height, in logical units, of the bounding rectangle.
+ * \param[in]   filenamePTR      A reference to a constant file path that will be used to retrieve the bitmap.
+ * \param[in]   transparentColor The color that will be replaced with transparency at the render step. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void transparentImage(int16 x, int16 y, uint16 width, uint16 height, char* filenamePTR, color transparentColor)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_IMAGE);
+	if(gtCommands.recording)
+	{
+		size_t length = strlen(filenamePTR) + 1;
+		gtImageCommand* command = (gtImageCommand*)gtRecord(COMMAND_IMAGE, x, y, x + width, y + height, gtHash(filenamePTR), sizeof(gtImageCommand) + length);
+		if(command)
+		{
+			*command = (gtImageCommand){x, y, width, height, TRUE, transparentColor};
+			memcpy(command + 1, filenamePTR, length);
+		}
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	texture handle = gtFindTexture(filenamePTR, width, height);
+
+	if(handle >= 0)
+		gtDrawTexture(x, y, &gtTextures.entries[handle], TRUE, transparentColor);
+	else
+		gtDrawUncached(x, y, width, height, filenamePTR, TRUE, transparentColor);
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that unmounts the asset archive.
+ * 
+ * \details The images drawn straight from the archive are copied out of it first, so their texture handles stay valid.
+ *          The pointers returned by readArchiveFile() are no longer valid.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void unmountArchive()
+{
+	if(!gtArchive.file.data)
+		return;
+
+#ifdef GRAPHTE_SOFTWARE
+	for(int i = 0; i < GRAPHTE_TEXTURE_CACHE_SIZE; i++)
+	{
+		gtTexture* entry = &gtTextures.entries[i];
+		if(!entry->path || !entry->packed)
+			continue;
+
+		size_t size = (size_t)entry->width * entry->height * sizeof(uint32_t);
+		uint32_t* pixels = (uint32_t*)malloc(size);
+		if(pixels)
+		{
+			memcpy(pixels, entry->pixels, size);
+			entry->pixels = pixels;
+			entry->packed = FALSE;
+		}
+		else
+			gtReleaseTexture(entry);
+	}
+#endif
+
+	for(uint32_t i = 0; i < gtArchive.header->entryCount; i++)
+		free(gtArchive.unpacked[i]);
+	free(gtArchive.unpacked);
+	gtArchive.unpacked = NULL;
+	gtArchive.header = NULL;
+	gtArchive.buckets = NULL;
+	gtArchive.entries = NULL;
+	gtUnmapFile(&gtArchive.file);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that mounts an asset archive.
+ * 
+ * \details The archive, written by tools/pack, is mapped into memory once and its index checked. Every function loading a file by path,
+ *          like image(), loadTexture() and loadSpriteAtlas(), then looks the path up in the archive before the file system, in constant time.
+ *          Images are stored decoded: drawn at their stored size from an uncompressed archive, their pixels are used where they are mapped.
+ *          Mounting an archive unmounts the previous one.
+ * 
+ * \param[in]   filenamePTR  A reference to a constant file path of the archive.
+ * 
+ * \return  This function returns TRUE if the archive was mounted and FALSE if it could not be mapped or is not a valid archive.
+ */
+////////////////////////////////////////////////////////////
+BOOL mountArchive(char* filenamePTR)
+{
+	unmountArchive();
+
+	gtMappedFile file;
+	if(!gtMapFile(filenamePTR, &file))
+		return FALSE;
+
+	const gtArchiveHeader* header = (const gtArchiveHeader*)file.data;
+	BOOL valid = file.size >= sizeof(gtArchiveHeader) && header->magic == GRAPHTE_ARCHIVE_MAGIC && header->version == GRAPHTE_ARCHIVE_VERSION
+		&& header->bucketCount && !(header->bucketCount & (header->bucketCount - 1)) && header->entryCount < header->bucketCount
+		&& !(header->bucketOffset % sizeof(uint32_t)) && header->bucketOffset <= file.size && (size_t)header->bucketCount * sizeof(uint32_t) <= file.size - header->bucketOffset
+		&& !(header->entryOffset % sizeof(uint32_t)) && header->entryOffset <= file.size && (size_t)header->entryCount * sizeof(gtArchiveEntry) <= file.size - header->entryOffset;
+
+	//! Every bucket and entry is checked once here, the lookups then rely on them.
+	const uint32_t* buckets = (const uint32_t*)(file.data + (valid ? header->bucketOffset : 0));
+	const gtArchiveEntry* entries = (const gtArchiveEntry*)(file.data + (valid ? header->entryOffset : 0));
+	uint32_t emptyBuckets = 0;
+	for(uint32_t i = 0; valid && i < header->bucketCount; i++)
+	{
+		valid = buckets[i] <= header->entryCount;
+		emptyBuckets += !buckets[i];
+	}
+	valid = valid && emptyBuckets;
+	for(uint32_t i = 0; valid && i < header->entryCount; i++)
+	{
+		const gtArchiveEntry* entry = &entries[i];
+		valid = entry->nameOffset <= file.size && entry->nameLength <= file.size - entry->nameOffset
+			&& !(entry->offset % GRAPHTE_ARCHIVE_ALIGNMENT) && entry->offset <= file.size && entry->size <= file.size - entry->offset
+			&& ((entry->flags & GRAPHTE_ARCHIVE_LZ4) || entry->rawSize == entry->size)
+			&& (!(entry->flags & GRAPHTE_ARCHIVE_PIXELS) || (entry->width && entry->height && (size_t)entry->width * entry->height * sizeof(uint32_t) == entry->rawSize));
+	}
+
+	unsigned char** unpacked = valid ? (unsigned char**)calloc((size_t)header->entryCount + 1, sizeof(unsigned char*)) : NULL;
+	if(!unpacked)
+	{
+		gtUnmapFile(&file);
+		return FALSE;
+	}
+
+	gtArchive.file = file;
+	gtArchive.header = header;
+	gtArchive.buckets = buckets;
+	gtArchive.entries = entries;
+	gtArchive.unpacked = unpacked;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves a file stored in the mounted archive.
+ * 
+ * \details The content is returned where it is mapped, a compressed file is decompressed on the first call and kept until the archive is unmounted.
+ * 
+ * \note    The content is not followed by a terminating zero. Images are stored decoded, they are only available through the image functions.
+ * 
+ * \param[in]   namePTR  A reference to a constant name of the file, its path relative to the directory the archive was packed from.
+ * \param[out]  size     Receives the size of the content, in bytes. Can be NULL.
+ * 
+ * \return  This function returns the content, valid until the archive is unmounted, or NULL if the file is not in the mounted archive.
+ */
+////////////////////////////////////////////////////////////
+const char* readArchiveFile(char* namePTR, size_t* size)
+{
+	const gtArchiveEntry* entry = gtFindArchiveEntry(namePTR);
+	if(!entry || (entry->flags & GRAPHTE_ARCHIVE_PIXELS))
+		return NULL;
+
+	size_t index = (size_t)(entry - gtArchive.entries);
+	const unsigned char* content = gtArchive.unpacked[index];
+	if(!content)
+	{
+		BOOL owned;
+		content = gtArchiveContent(entry, &owned);
+		if(owned)
+			gtArchive.unpacked[index] = (unsigned char*)content;
+	}
+
+	if(content && size)
+		*size = entry->rawSize;
+	return (const char*)content;
+}
+
+////////////////////////////////////////////////////////////
+// Sprite atlases
+////////////////////////////////////////////////////////////
+
+//! The number of sprite atlases that can be loaded at the same time.
+#ifndef GRAPHTE_ATLAS_COUNT
+	#define GRAPHTE_ATLAS_COUNT 16
+#endif
+
+//! A handle to a sprite atlas, as returned by loadSpriteAtlas(). Negative values are invalid handles.
+typedef int16 spriteAtlas;
+
+//! The index of a sprite inside its atlas, as returned by findSprite(). Negative values are invalid sprites.
+typedef int16 sprite;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure describing one sprite of a drawSprites() batch.
+ * 
+ * \details The structure contains the sprite to be drawn and the coordinates, in logical units, of its upper-left corner on the canvas.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	sprite id;
+	int16 x, y;
+}
+spriteDraw;
+
+//! A named rectangle of an atlas image.
+typedef struct
+{
+	char* name; //! The name given to the sprite by the index file.
+	uint32_t hash; //! The hash of the name, checked before comparing names.
+	uint16 x, y, width, height; //! The rectangle of the sprite in the atlas image.
+}
+gtSprite;
+
+//! A loaded atlas: one texture holding every sprite and the index of their rectangles.
+typedef struct
+{
+	texture image; //! The texture handle of the atlas image, -1 for an empty slot.
+	gtSprite* sprites;
+	int count;
+	BOOL transparent; //! TRUE if the index file declares a transparent color.
+	color transparentColor;
+}
+gtAtlas;
+
+//! The loaded sprite atlases.
+struct
+{
+	gtAtlas entries[GRAPHTE_ATLAS_COUNT];
+	BOOL ready; //! FALSE until the slots have been marked empty.
+}
+gtAtlases;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves a loaded atlas.
+ * 
+ * \param[in]    handle  The atlas handle returned by loadSpriteAtlas().
+ * 
+ * \return       Returns the atlas, or NULL for an invalid handle.
+ */
+////////////////////////////////////////////////////////////
+gtAtlas* gtGetAtlas(spriteAtlas handle)
+{
+	if(handle < 0 || handle >= GRAPHTE_ATLAS_COUNT || !gtAtlases.ready || gtAtlases.entries[handle].image < 0)
+		return NULL;
+
+	return &gtAtlases.entries[handle];
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that unloads a sprite atlas.
+ * 
+ * \details This function releases the texture of the atlas and frees its index.
+ * 
+ * \note    The handle and the sprites found in the atlas must not be used after this call.
+ * 
+ * \param[in]   handle  The atlas handle returned by loadSpriteAtlas().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void freeSpriteAtlas(spriteAtlas handle)
+{
+	gtAtlas* atlas = gtGetAtlas(handle);
+	if(!atlas)
+		return;
+
+	for(int i = 0; i < atlas->count; i++)
+		free(atlas->sprites[i].name);
+	free(atlas->sprites);
+	freeTexture(atlas->image);
+
+	atlas->sprites = NULL;
+	atlas->count = 0;
+	atlas->image = -1;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that loads a sprite atlas.
+ * 
+ * \details A sprite atlas is a single bitmap holding many sprites, along with a text index file naming the rectangle of every sprite.
+ *          Every line of the index is either a sprite, "name x y width height", or "transparent red green blue" to draw the sprites of the atlas
+ *          with that color skipped. Empty lines and lines starting with '#' are ignored. The bitmap is loaded once as a texture, at the size of the file.
+ * 
+ * \note    Sprites whose rectangle does not lie inside the image are ignored. Both files are taken from the mounted archive when it holds them.
+ * 
+ * \param[in]   imagePTR  A reference to a constant file path of the atlas bitmap.
+ * \param[in]   indexPTR  A reference to a constant file path of the index file.
+ * 
+ * \return  This function returns the atlas handle, or -1 if a file could not be loaded or all GRAPHTE_ATLAS_COUNT slots are in use.
+ */
+////////////////////////////////////////////////////////////
+spriteAtlas loadSpriteAtlas(char* imagePTR, char* indexPTR)
+{
+	if(!gtAtlases.ready)
+	{
+		for(int i = 0; i < GRAPHTE_ATLAS_COUNT; i++)
+			gtAtlases.entries[i].image = -1;
+		gtAtlases.ready = TRUE;
+	}
+
+	spriteAtlas handle = 0;
+	while(handle < GRAPHTE_ATLAS_COUNT && gtAtlases.entries[handle].image >= 0)
+		handle++;
+	if(handle == GRAPHTE_ATLAS_COUNT)
+		return -1;
+
+	size_t indexSize, position = 0;
+	BOOL owned = FALSE;
+	const char* index = gtReadAsset(indexPTR, &indexSize, &owned);
+	if(!index)
+		return -1;
+
+	gtAtlas* atlas = &gtAtlases.entries[handle];
+	atlas->image = loadTexture(imagePTR, 0, 0);
+	if(atlas->image < 0)
+	{
+		if(owned)
+			free((void*)index);
+		return -1;
+	}
+
+	vector2u size = getTextureSize(atlas->image);
+	int capacity = 0;
+	char line[256], name[128];
+	int x, y, width, height, red, green, blue;
+
+	atlas->sprites = NULL;
+	atlas->count = 0;
+	atlas->transparent = FALSE;
+
+	while(position < indexSize)
+	{
+		//! The index is read one line at a time, a line too long for the buffer is cut.
+		size_t length = 0;
+		for(; position < indexSize && index[position] != '\n'; position++)
+			if(length < sizeof(line) - 1)
+				line[length++] = index[position];
+		line[length] = 0;
+		position++;
+
+		if(sscanf(line, "%127s", name) != 1 || name[0] == '#')
+			continue;
+
+		if(!strcmp(name, "transparent"))
+		{
+			if(sscanf(line, "%*s %d %d %d", &red, &green, &blue) == 3)
+			{
+				atlas->transparent = TRUE;
+				atlas->transparentColor = rgb(red, green, blue);
+			}
+			continue;
+		}
+
+		if(sscanf(line, "%*s %d %d %d %d", &x, &y, &width, &height) != 4 || x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > size.x || y + height > size.y)
+			continue;
+
+		if(atlas->count == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 16;
+			gtSprite* sprites = (gtSprite*)realloc(atlas->sprites, capacity * sizeof(gtSprite));
+			if(!sprites)
+				break;
+			atlas->sprites = sprites;
+		}
+
+		gtSprite* entry = &atlas->sprites[atlas->count];
+		entry->name = (char*)malloc(strlen(name) + 1);
+		if(!entry->name)
+			break;
+		strcpy(entry->name, name);
+		entry->hash = gtHash(name);
+		entry->x = x;
+		entry->y = y;
+		entry->width = width;
+		entry->height = height;
+		atlas->count++;
+	}
+
+	if(owned)
+		free((void*)index);
+	return handle;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds a sprite by name.
+ * 
+ * \details This function looks the name up in the index of the atlas. The returned value stays valid as long as the atlas is loaded,
+ *          so the lookup is best done once, outside of the drawing loop.
+ * 
+ * \param[in]   handle   The atlas handle returned by loadSpriteAtlas().
+ * \param[in]   namePTR  A reference to a constant char* containing the name of the sprite.
+ * 
+ * \return  This function returns the sprite, or -1 if the atlas has no sprite with that name.
+ */
+////////////////////////////////////////////////////////////
+sprite findSprite(spriteAtlas handle, char* namePTR)
+{
+	gtAtlas* atlas = gtGetAtlas(handle);
+	if(!atlas)
+		return -1;
+
+	uint32_t hash = gtHash(namePTR);
+	for(int i = 0; i < atlas->count; i++)
+		if(atlas->sprites[i].hash == hash && !strcmp(atlas->sprites[i].name, namePTR))
+			return i;
+
+	return -1;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the size of a sprite.
+ * 
+ * \param[in]   handle  The atlas handle returned by loadSpriteAtlas().
+ * \param[in]   id      The sprite returned by findSprite().
+ * 
+ * \return  This function returns a structure containing the width and height of the sprite, or 0/0 for an invalid sprite.
+ */
+////////////////////////////////////////////////////////////
+vector2u getSpriteSize(spriteAtlas handle, sprite id)
+{
+	gtAtlas* atlas = gtGetAtlas(handle);
+	if(!atlas || id < 0 || id >= atlas->count)
+		return (vector2u){0, 0};
+
+	return (vector2u){atlas->sprites[id].width, atlas->sprites[id].height};
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws many sprites of an atlas.
+ * 
+ * \details This function draws the sprites in the order of the array, later ones over earlier ones. The atlas image is selected once for the
+ *          whole batch, so every sprite costs a single blit from the shared source. Invalid sprites are skipped.
+ * 
+ * \param[in]   handle  The atlas handle returned by loadSpriteAtlas().
+ * \param[in]   draws   The sprites to be drawn and their positions.
+ * \param[in]   count   The number of elements of the draws array.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void drawSprites(spriteAtlas handle, const spriteDraw* draws, uint16 count)
+{
+	gtAtlas* atlas = gtGetAtlas(handle);
+	if(!atlas)
+		return;
+	GRAPHTE_PROFILE_BEGIN(PROFILE_SPRITES);
+
+	if(gtCommands.recording)
+	{
+		int left = 65536, top = 65536, right = -65536, bottom = -65536;
+		for(uint16 i = 0; i < count; i++)
+		{
+			if(draws[i].id < 0 || draws[i].id >= atlas->count)
+				continue;
+			gtSprite* source = &atlas->sprites[draws[i].id];
+			if(draws[i].x < left) left = draws[i].x;
+			if(draws[i].y < top) top = draws[i].y;
+			if(draws[i].x + source->width > right) right = draws[i].x + source->width;
+			if(draws[i].y + source->height > bottom) bottom = draws[i].y + source->height;
+		}
+
+		gtSpritesCommand* command = (gtSpritesCommand*)gtRecord(COMMAND_SPRITES, left, top, right, bottom, handle, sizeof(gtSpritesCommand) + count * sizeof(spriteDraw));
+		if(command)
+		{
+			*command = (gtSpritesCommand){handle, count};
+			memcpy(command + 1, draws, count * sizeof(spriteDraw));
+		}
+		GRAPHTE_PROFILE_END();
+		return;
+	}
+
+	gtTexture* entry = &gtTextures.entries[atlas->image];
+	entry->lastUse = ++gtTextures.uses;
+
+	for(uint16 i = 0; i < count; i++)
+	{
+		if(draws[i].id < 0 || draws[i].id >= atlas->count)
+			continue;
+
+		gtSprite* source = &atlas->sprites[draws[i].id];
+		gtDrawTextureRegion(draws[i].x, draws[i].y, entry, source->x, source->y, source->width, source->height, atlas->transparent, atlas->transparentColor);
+	}
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a sprite at the specified point.
+ * 
+ * \details This function copies the rectangle of the sprite from the atlas image to the memory canvas, at the size it has in the atlas.
+ *          If the index of the atlas declares a transparent color, the pixels of that color are skipped.
+ * 
+ * \param[in]   handle  The atlas handle returned by loadSpriteAtlas().
+ * \param[in]   id      The sprite returned by findSprite().
+ * \param[in]   x       Specifies the x-coordinate, in logical units, of the sprite's upper-left corner.
+ * \param[in]   y       Specifies the y-coordinate, in logical units, of the sprite's upper-left corner.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void drawSprite(spriteAtlas handle, sprite id, int16 x, int16 y)
+{
+	spriteDraw draw = {id, x, y};
+	drawSprites(handle, &draw, 1);
+}
+
+////////////////////////////////////////////////////////////
+// Text
+////////////////////////////////////////////////////////////
+
+//! The number of laid out strings kept by the text cache.
+#ifndef GRAPHTE_TEXT_CACHE_SIZE
+	#define GRAPHTE_TEXT_CACHE_SIZE 64
+#endif
+
+//! The height, in pixels, of a line of text before the first setTextSize() call.
+#ifndef GRAPHTE_TEXT_SIZE
+	#define GRAPHTE_TEXT_SIZE 16
+#endif
+
+//! The number of text sizes whose glyphs are kept rasterized at once.
+#ifndef GRAPHTE_TEXT_SIZES
+	#define GRAPHTE_TEXT_SIZES 4
+#endif
+
+//! The glyph atlas holds the printable ASCII characters, from ' ' to '~'. Other characters are drawn as '?'.
+#define GRAPHTE_FIRST_GLYPH 32
+#define GRAPHTE_GLYPHS 95
+
+#ifdef GRAPHTE_SOFTWARE
+//! The font bundled for the software backends: 5 columns of 7 pixels per character, bit 0 is the top row.
+const unsigned char gtFont5x7[GRAPHTE_GLYPHS][5] =
+{
+	{0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+	{0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00},
+	{0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+	{0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+	{0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+	{0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+	{0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00},
+	{0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06},
+	{0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+	{0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x49, 0x49, 0x7A},
+	{0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+	{0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+	{0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31},
+	{0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+	{0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+	{0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+	{0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20},
+	{0x38, 0x44, 0x44, 0x48, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+	{0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+	{0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+	{0x7C, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+	{0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+	{0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+	{0x00, 0x00, 0x7F, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00}, {0x10, 0x08, 0x08, 0x10, 0x08}
+};
+#endif
+
+//! The glyphs of the current font, rasterized once at one text size.
+typedef struct
+{
+	unsigned char* mask; //! The cells of every glyph side by side, one byte per pixel, non-zero where the glyph covers the pixel. NULL for an empty slot.
+	int cellWidth, cellHeight; //! The size of the cell of a glyph.
+	int stride; //! The distance, in bytes, between two rows of the mask.
+	int advance[GRAPHTE_GLYPHS]; //! The distance, in pixels, from the start of a glyph to the start of the next one.
+	uint16 size; //! The text size the atlas was built for.
+	unsigned long lastUse; //! The value of the use counter the last time text was laid out with the atlas.
+}
+gtGlyphAtlas;
+
+//! The atlases of the last text sizes used, so text drawn at several sizes is not rasterized again on every size change.
+struct
+{
+	gtGlyphAtlas atlases[GRAPHTE_TEXT_SIZES];
+	unsigned long uses; //! Incremented on every use to order the atlases from least to most recently used.
+}
+gtGlyphs;
+
+//! A glyph positioned by the layout of a string, relative to the upper-left corner of the text.
+typedef struct
+{
+	int16 x, y;
+	unsigned char glyph; //! The index of the glyph in the atlas.
+}
+gtPlacedGlyph;
+
+//! A laid out string kept by the text cache.
+typedef struct
+{
+	char* string; //! The laid out string, NULL for an empty slot.
+	uint32_t hash; //! The hash of the string, checked before comparing strings.
+	const gtGlyphAtlas* atlas; //! The atlas the glyphs were placed with. Together with the string, it is the key of the entry.
+	gtPlacedGlyph* glyphs; //! The visible glyphs of the string, blanks are not stored.
+	int count; //! The number of glyphs.
+	uint16 width, height; //! The size of the text block.
+	unsigned long lastUse; //! The value of the use counter the last time the layout was drawn.
+}
+gtTextLayout;
+
+//! The text cache, every entry is a string laid out at one text size.
+struct
+{
+	gtTextLayout entries[GRAPHTE_TEXT_CACHE_SIZE];
+	unsigned long uses; //! Incremented on every use to order the entries from least to most recently used.
+	cacheStats stats;
+	uint16 size; //! The height of a line of text, see setTextSize().
+}
+gtTexts;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that removes the layouts placed with a glyph atlas from the text cache.
+ * 
+ * \param[in]    atlas  The atlas about to be rasterized again.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtDropTextLayouts(const gtGlyphAtlas* atlas)
+{
+	for(int i = 0; i < GRAPHTE_TEXT_CACHE_SIZE; i++)
+	{
+		if(gtTexts.entries[i].atlas != atlas)
+			continue;
+
+		free(gtTexts.entries[i].string);
+		free(gtTexts.entries[i].glyphs);
+		gtTexts.entries[i].string = NULL;
+		gtTexts.entries[i].glyphs = NULL;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that rasterizes a glyph atlas for a text size.
+ * 
+ * \details The font is first rasterized at its own size: the bundled 5x7 font in 6x8 cells on the software backends, the font selected into the
+ *          memory canvas on GDI, drawn once with TextOut() into a DIB section and read back. The atlas is that raster scaled up by the whole factor
+ *          closest to the text size.
+ * 
+ * \param[in,out]  atlas  The atlas to be filled in. Its previous glyphs, and the layouts placed with them, are dropped once the new ones are ready.
+ * \param[in]      size   The text size.
+ * 
+ * \return       Returns TRUE if the atlas is ready and FALSE if it could not be built, in which case it is left unchanged.
+ */
+////////////////////////////////////////////////////////////
+BOOL gtBuildGlyphs(gtGlyphAtlas* atlas, uint16 size)
+{
+	int baseWidth, baseHeight, baseAdvance[GRAPHTE_GLYPHS];
+	unsigned char* base;
+
+#ifdef GRAPHTE_BACKEND_GDI
+	TEXTMETRICA metrics;
+	INT widths[GRAPHTE_GLYPHS];
+	GetTextMetricsA(host.bufferDC, &metrics);
+	GetCharWidth32A(host.bufferDC, GRAPHTE_FIRST_GLYPH, GRAPHTE_FIRST_GLYPH + GRAPHTE_GLYPHS - 1, widths);
+	baseWidth = metrics.tmMaxCharWidth;
+	baseHeight = metrics.tmHeight;
+
+	BITMAPINFO info;
+	memset(&info, 0, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = baseWidth * GRAPHTE_GLYPHS;
+	info.bmiHeader.biHeight = -baseHeight;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	uint32_t* bits = NULL;
+	HDC dc = CreateCompatibleDC(host.hdc);
+	HBITMAP bitmap = CreateDIBSection(host.hdc, &info, DIB_RGB_COLORS, (void**)&bits, NULL, 0);
+	base = (unsigned char*)malloc((size_t)baseWidth * GRAPHTE_GLYPHS * baseHeight);
+	if(!dc || !bitmap || !base)
+	{
+		if(bitmap) DeleteObject(bitmap);
+		if(dc) DeleteDC(dc);
+		free(base);
+		return FALSE;
+	}
+
+	//! White glyphs on black, the mask is any lit pixel of the result.
+	HGDIOBJ oldBitmap = SelectObject(dc, bitmap);
+	HGDIOBJ oldFont = SelectObject(dc, GetCurrentObject(host.bufferDC, OBJ_FONT));
+	SetTextColor(dc, RGB(255, 255, 255));
+	SetBkMode(dc, TRANSPARENT);
+	PatBlt(dc, 0, 0, baseWidth * GRAPHTE_GLYPHS, baseHeight, BLACKNESS);
+	for(int i = 0; i < GRAPHTE_GLYPHS; i++)
+	{
+		char character = (char)(GRAPHTE_FIRST_GLYPH + i);
+		TextOutA(dc, i * baseWidth, 0, &character, 1);
+		baseAdvance[i] = widths[i];
+	}
+	GdiFlush();
+
+	for(size_t i = 0; i < (size_t)baseWidth * GRAPHTE_GLYPHS * baseHeight; i++)
+		base[i] = (bits[i] & 0xFFFFFF) != 0;
+
+	SelectObject(dc, oldFont);
+	SelectObject(dc, oldBitmap);
+	DeleteObject(bitmap);
+	DeleteDC(dc);
+#else
+	baseWidth = 6;
+	baseHeight = 8;
+	base = (unsigned char*)calloc((size_t)baseWidth * GRAPHTE_GLYPHS * baseHeight, 1);
+	if(!base)
+		return FALSE;
+
+	for(int i = 0; i < GRAPHTE_GLYPHS; i++)
+	{
+		for(int column = 0; column < 5; column++)
+			for(int row = 0; row < 7; row++)
+				base[row * baseWidth * GRAPHTE_GLYPHS + i * baseWidth + column] = gtFont5x7[i][column] >> row & 1;
+
+		baseAdvance[i] = baseWidth;
+	}
+#endif
+
+	int scale = (size + baseHeight / 2) / baseHeight;
+	if(scale < 1)
+		scale = 1;
+
+	unsigned char* mask = (unsigned char*)malloc((size_t)baseWidth * scale * GRAPHTE_GLYPHS * baseHeight * scale);
+	if(!mask)
+	{
+		free(base);
+		return FALSE;
+	}
+
+	atlas->cellWidth = baseWidth * scale;
+	atlas->cellHeight = baseHeight * scale;
+	atlas->stride = atlas->cellWidth * GRAPHTE_GLYPHS;
+	for(int y = 0; y < atlas->cellHeight; y++)
+		for(int x = 0; x < atlas->stride; x++)
+			mask[(size_t)y * atlas->stride + x] = base[(size_t)(y / scale) * baseWidth * GRAPHTE_GLYPHS + x / scale];
+	for(int i = 0; i < GRAPHTE_GLYPHS; i++)
+		atlas->advance[i] = baseAdvance[i] * scale;
+
+	free(base);
+	//! The cached layouts were measured with the old glyphs.
+	if(atlas->mask)
+		gtDropTextLayouts(atlas);
+	free(atlas->mask);
+	atlas->mask = mask;
+	atlas->size = size;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds or builds the glyph atlas of the current text size.
+ * 
+ * \details This function looks the text size up in the atlases already rasterized. On a miss the glyphs are rasterized into an empty slot
+ *          or the least recently used one, see gtBuildGlyphs().
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return       Returns the atlas, or NULL if it could not be built.
+ */
+////////////////////////////////////////////////////////////
+gtGlyphAtlas* gtFindGlyphs()
+{
+	uint16 size = gtTexts.size ? gtTexts.size : GRAPHTE_TEXT_SIZE;
+	int victim = 0;
+
+	for(int i = 0; i < GRAPHTE_TEXT_SIZES; i++)
+	{
+		gtGlyphAtlas* atlas = &gtGlyphs.atlases[i];
+
+		if(atlas->mask && atlas->size == size)
+		{
+			atlas->lastUse = ++gtGlyphs.uses;
+			return atlas;
+		}
+
+		if(gtGlyphs.atlases[victim].mask && (!atlas->mask || atlas->lastUse < gtGlyphs.atlases[victim].lastUse))
+			victim = i;
+	}
+
+	gtGlyphAtlas* atlas = &gtGlyphs.atlases[victim];
+	if(!gtBuildGlyphs(atlas, size))
+		return NULL;
+
+	atlas->lastUse = ++gtGlyphs.uses;
+	return atlas;
+}
+
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that lays a string out with a glyph atlas.
+ * 
+ * \details Every character is placed after the advance of the previous one, "\n" starts a new line, "\t" moves to the next multiple of 8 spaces
+ *          and "\r" is ignored.
+ * 
+ * \param[in,out]  layout  The layout to be filled in, its glyphs must hold one entry per character of the string.
+ * \param[in]      atlas   The glyph atlas of the text size, see gtFindGlyphs().
+ * \param[in]      string  The string to be laid out.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtLayoutText(gtTextLayout* layout, const gtGlyphAtlas* atlas, const char* string)
+{
+	layout->atlas = atlas;
+	layout->count = 0;
+
+	int x = 0, y = 0, width = 0, tab = atlas->advance[0] * 8;
+	for(const unsigned char* character = (const unsigned char*)string; *character; character++)
+	{
+		if(*character == '\n')
+		{
+			x = 0;
+			y += atlas->cellHeight;
+			continue;
+		}
+		if(*character == '\r')
+			continue;
+		if(*character == '\t')
+			x = tab ? (x / tab + 1) * tab : x;
+		else
+		{
+			int glyph = *character >= GRAPHTE_FIRST_GLYPH && *character < GRAPHTE_FIRST_GLYPH + GRAPHTE_GLYPHS ? *character - GRAPHTE_FIRST_GLYPH : '?' - GRAPHTE_FIRST_GLYPH;
+			if(glyph)
+				layout->glyphs[layout->count++] = (gtPlacedGlyph){(int16)x, (int16)y, (unsigned char)glyph};
+			x += atlas->advance[glyph];
+		}
+
+		if(x > width)
+			width = x;
+	}
+
+	layout->width = width;
+	layout->height = y + atlas->cellHeight;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that finds or creates the layout of a string.
+ * 
+ * \details This function looks the string up in the text cache, among the layouts at the current text size. On a miss the string is laid out
+ *          by gtLayoutText() into an empty slot or the least recently used one.
+ * 
+ * \param[in]    string  The string to be laid out.
+ * 
+ * \return       Returns the layout of the string, or NULL if it could not be created.
+ */
+////////////////////////////////////////////////////////////
+gtTextLayout* gtFindTextLayout(const char* string)
+{
+	const gtGlyphAtlas* atlas = gtFindGlyphs();
+	if(!atlas)
+		return NULL;
+
+	uint32_t hash = gtHash(string);
+	int victim = 0;
+
+	for(int i = 0; i < GRAPHTE_TEXT_CACHE_SIZE; i++)
+	{
+		gtTextLayout* entry = &gtTexts.entries[i];
+
+		if(entry->string && entry->hash == hash && entry->atlas == atlas && !strcmp(entry->string, string))
+		{
+			gtTexts.stats.hits++;
+			entry->lastUse = ++gtTexts.uses;
+			return entry;
+		}
+
+		if(gtTexts.entries[victim].string && (!entry->string || entry->lastUse < gtTexts.entries[victim].lastUse))
+			victim = i;
+	}
+
+	gtTexts.stats.misses++;
+
+	gtTextLayout* entry = &gtTexts.entries[victim];
+	free(entry->string);
+	free(entry->glyphs);
+
+	size_t length = strlen(string);
+	entry->string = (char*)malloc(length + 1);
+	entry->glyphs = (gtPlacedGlyph*)malloc((length ? length : 1) * sizeof(gtPlacedGlyph));
+	if(!entry->string || !entry->glyphs)
+	{
+		free(entry->string);
+		free(entry->glyphs);
+		entry->string = NULL;
+		entry->glyphs = NULL;
+		return NULL;
+	}
+
+	memcpy(entry->string, string, length + 1);
+	entry->hash = hash;
+	gtLayoutText(entry, atlas, string);
+	entry->lastUse = ++gtTexts.uses;
+	return entry;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws a laid out string on the memory canvas.
+ * 
+ * \details Every glyph is copied from the atlas, writing the text color where its mask is set and leaving the other pixels untouched.
+ *          Only the part of the text inside the clipping rectangle is drawn, and only that part is added to the damage list.
+ * 
+ * \param[in]    x       The x-coordinate of the upper-left corner of the text.
+ * \param[in]    y       The y-coordinate of the upper-left corner of the text.
+ * \param[in]    layout  The layout of the string.
+ * \param[in]    clip    The rectangle, in canvas coordinates, outside of which nothing is drawn.
+ * \param[in]    value   The premultiplied text color, see gtPaint(). Translucent colors are blended with the current blend mode.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtDrawText(int x, int y, gtTextLayout* layout, gtRect clip, uint32_t value)
+{
+	if(clip.left < 0) clip.left = 0;
+	if(clip.top < 0) clip.top = 0;
+	if(clip.right > host.width) clip.right = host.width;
+	if(clip.bottom > host.height) clip.bottom = host.height;
+	if(x > clip.left) clip.left = x;
+	if(y > clip.top) clip.top = y;
+	if(x + layout->width < clip.right) clip.right = x + layout->width;
+	if(y + layout->height < clip.bottom) clip.bottom = y + layout->height;
+	if(clip.left >= clip.right || clip.top >= clip.bottom)
+		return;
+
+	gtAddDamage(clip.left, clip.top, clip.right, clip.bottom);
+#ifdef GRAPHTE_BACKEND_GDI
+	//! The canvas bits are written directly, pending GDI drawing has to land first.
+	if(!host.pixelsLocked)
+		GdiFlush();
+#endif
+
+	const gtGlyphAtlas* atlas = layout->atlas;
+	BOOL opaque = gtOpaque(value);
+	for(int i = 0; i < layout->count; i++)
+	{
+		gtPlacedGlyph* glyph = &layout->glyphs[i];
+		int left = x + glyph->x, top = y + glyph->y;
+		int firstColumn = clip.left > left ? clip.left - left : 0, lastColumn = clip.right - left < atlas->cellWidth ? clip.right - left : atlas->cellWidth;
+		int firstRow = clip.top > top ? clip.top - top : 0, lastRow = clip.bottom - top < atlas->cellHeight ? clip.bottom - top : atlas->cellHeight;
+
+		for(int row = firstRow; row < lastRow; row++)
+		{
+			const unsigned char* mask = atlas->mask + (size_t)row * atlas->stride + glyph->glyph * atlas->cellWidth;
+			uint32_t* destination = host.pixels + (size_t)(top + row) * host.stride + left;
+
+			for(int column = firstColumn; column < lastColumn; column++)
+				if(mask[column])
+					destination[column] = opaque ? value : gtBlendPixel(destination[column], value, gtBlend.mode);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that records a text() or textRect() call.
+ * 
+ * \details The string and the text size are copied into the command. The bounds come from the layout, clipped to the rectangle of textRect().
+ * 
+ * \param[in]    x          The x-coordinate of the text.
+ * \param[in]    y          The y-coordinate of the text.
+ * \param[in]    width      The width of the clipping rectangle, for textRect().
+ * \param[in]    height     The height of the clipping rectangle, for textRect().
+ * \param[in]    clip       TRUE for textRect(), FALSE for text().
+ * \param[in]    layout     The layout of the string.
+ * \param[in]    textPTR    The string.
+ * \param[in]    fillColor  The color of the text.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtRecordText(int16 x, int16 y, uint16 width, uint16 height, BOOL clip, gtTextLayout* layout, char* textPTR, color fillColor)
+{
+	size_t length = strlen(textPTR) + 1;
+	int right = x + (clip && width < layout->width ? width : layout->width);
+	int bottom = y + (clip && height < layout->height ? height : layout->height);
+
+	gtTextCommand* command = (gtTextCommand*)gtRecord(COMMAND_TEXT, x, y, right, bottom, gtPaint(fillColor), sizeof(gtTextCommand) + length);
+	if(command)
+	{
+		*command = (gtTextCommand){x, y, width, height, clip, gtTexts.size, fillColor};
+		memcpy(command + 1, textPTR, length);
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function draws text in specified bounding rectangle.
+ * 
+ * \details This function draws the text from the upper-left corner of the bounding rectangle, breaking lines at every "\n", and clips it to the rectangle.
+ *          The glyphs come from an atlas rasterized once per text size and the layout of the string is cached, so drawing the same text again only
+ *          costs the pixels it covers.
+ * 
+ * \note    This function accepts inverse-scale bounding rectangles.
+ *          GDI draws with the font of the console window, the software backends with a bundled 5x7 bitmap font.
+ *
+ * \param[in]   x          Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   y          Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
+ * \param[in]   width      The width, in logical units, of the bounding rectangle.
+ * \param[in]   height     The height, in logical units, of the bounding rectangle.
+ * \param[in]   textPTR    A reference to a constant char* containing the desired text to draw.
+ * \param[in]   fillColor  The color that will be used to paint the text. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void textRect(int16 x, int16 y, uint16 width, uint16 height, char* textPTR, color fillColor)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_TEXT);
+	gtTextLayout* layout = gtFindTextLayout(textPTR);
+	if(layout && gtCommands.recording)
+		gtRecordText(x, y, width, height, TRUE, layout, textPTR, fillColor);
+	else if(layout)
+		gtDrawText(x, y, layout, (gtRect){x, y, x + width, y + height}, gtPaint(fillColor));
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function draws text at a specified point on the screen.
+ * 
+ * \details This function draws the text with its upper-left corner at the specified coordinates of the screen, breaking lines at every "\n".
+ *          The glyphs come from an atlas rasterized once per text size and the layout of the string is cached, so drawing the same text again only
+ *          costs the pixels it covers.
+ * 
+ * \note   This function accepts coordinates outside of the window area.
+ *         GDI draws with the font of the console window, the software backends with a bundled 5x7 bitmap font.
+ *
+ * \param[in]   x          Specifies the x-coordinate, in logical units, of the point at which the first character will appear.
+ * \param[in]   y          Specifies the y-coordinate, in logical units, of the point at which the first character will appear.
+ * \param[in]   textPTR    A reference to a constant char* containing the desired text to draw.
+ * \param[in]   fillColor  The color that will be used to paint the text. To create a graphTe color value, use the rgb() function.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void text(int16 x, int16 y, char* textPTR, color fillColor)
+{
+	GRAPHTE_PROFILE_BEGIN(PROFILE_TEXT);
+	gtTextLayout* layout = gtFindTextLayout(textPTR);
+	if(layout && gtCommands.recording)
+		gtRecordText(x, y, 0, 0, FALSE, layout, textPTR, fillColor);
+	else if(layout)
+		gtDrawText(x, y, layout, (gtRect){0, 0, host.width, host.height}, gtPaint(fillColor));
+	GRAPHTE_PROFILE_END();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that sets the size of the text.
+ * 
+ * \details The glyphs are scaled by the whole factor that brings the height of a line closest to the requested size, and rasterized the next time
+ *          text is drawn at a size not used recently. The last GRAPHTE_TEXT_SIZES sizes keep their glyphs and cached layouts, so switching between them is free.
+ * 
+ * \param[in]   height  The height, in pixels, of a line of text. The default is GRAPHTE_TEXT_SIZE (16).
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setTextSize(uint16 height)
+{
+	gtTexts.size = height;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that measures a string.
+ * 
+ * \details This function lays the string out the way text() draws it, which also caches the layout for the next text() call.
+ * 
+ * \param[in]   textPTR  A reference to a constant char* containing the text to measure.
+ * 
+ * \return  This function returns the width and height, in pixels, of the text block.
+ */
+////////////////////////////////////////////////////////////
+vector2u measureText(char* textPTR)
+{
+	gtTextLayout* layout = gtFindTextLayout(textPTR);
+	return layout ? (vector2u){layout->width, layout->height} : (vector2u){0, 0};
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the counters of the text cache.
+ * 
+ * \details Every text(), textRect() and measureText() call is either a hit, which reuses the layout of the string, or a miss, which lays it out.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the hit and miss counts since the start of the program.
+ */
+////////////////////////////////////////////////////////////
+cacheStats getTextCacheStats()
+{
+	return gtTexts.stats;
+}
+
+////////////////////////////////////////////////////////////
+// Profiler
+////////////////////////////////////////////////////////////
+
+#ifdef GRAPHTE_PROFILE
+//! The names of the profile zones, as shown by drawProfileOverlay() and saveProfileTrace().
+const char* gtProfileNames[PROFILE_ZONES] = {"display", "pixel", "rect", "line", "polyline", "ellipse", "triangle", "shadedTriangle", "texture", "image", "sprites", "text", "shade", "commands"};
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the profile of a completed frame.
+ * 
+ * \details When the program is compiled with GRAPHTE_PROFILE defined, every drawing call and display() is counted with the time it took and the pixels
+ *          it damaged. A frame ends with a display() call, the last GRAPHTE_PROFILE_FRAMES (120) frames are kept.
+ * 
+ * \note    Without GRAPHTE_PROFILE nothing is measured and the calls cost nothing more, this function then always returns FALSE.
+ *          Only the calls made on the thread calling display() are measured.
+ * 
+ * \param[in]    age    0 for the last completed frame, 1 for the one before and so on.
+ * \param[out]   frame  The profile of the frame.
+ * 
+ * \return       Returns TRUE if the frame is still kept and FALSE otherwise.
+ */
+////////////////////////////////////////////////////////////
+BOOL getProfileFrame(uint16 age, profileFrame* frame)
+{
+#ifdef GRAPHTE_PROFILE
+	unsigned long completed = gtProfile.started ? gtProfile.current.number - 1 : 0;
+	if(age >= completed || age >= GRAPHTE_PROFILE_FRAMES)
+		return FALSE;
+
+	*frame = gtProfile.frames[(completed - age) % GRAPHTE_PROFILE_FRAMES];
+	return TRUE;
+#else
+	(void)age;
+	(void)frame;
+	return FALSE;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that writes the measured calls as a Chrome trace.
+ * 
+ * \details The file is in the trace event JSON format read by chrome://tracing and Perfetto. Every kept frame is a span that contains the calls made
+ *          during it, calls made by other calls (the ones replayed by drawCommands()) are nested in them. Every call carries the pixels it damaged.
+ *          The last GRAPHTE_PROFILE_EVENTS (32768) calls are kept.
+ * 
+ * \note    This function needs GRAPHTE_PROFILE, it returns FALSE without it.
+ * 
+ * \param[in]   filenamePTR  A reference to a constant file path that the trace will be written to.
+ * 
+ * \return  This function returns TRUE if the whole trace was written and FALSE otherwise.
+ */
+////////////////////////////////////////////////////////////
+BOOL saveProfileTrace(char* filenamePTR)
+{
+#ifdef GRAPHTE_PROFILE
+	FILE* file = fopen(filenamePTR, "w");
+	if(!file)
+		return FALSE;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"graphTe\"}}");
+
+	unsigned long completed = gtProfile.started ? gtProfile.current.number - 1 : 0;
+	for(unsigned long number = completed > GRAPHTE_PROFILE_FRAMES ? completed - GRAPHTE_PROFILE_FRAMES + 1 : 1; number <= completed; number++)
+	{
+		profileFrame* frame = &gtProfile.frames[number % GRAPHTE_PROFILE_FRAMES];
+		fprintf(file, ",\n{\"name\":\"frame %lu\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+			frame->number, frame->start / 1000.0, frame->nanoseconds / 1000.0);
+	}
+
+	for(unsigned long long i = gtProfile.eventCount > GRAPHTE_PROFILE_EVENTS ? gtProfile.eventCount - GRAPHTE_PROFILE_EVENTS : 0; i < gtProfile.eventCount; i++)
+	{
+		gtProfileEvent* event = &gtProfile.events[i % GRAPHTE_PROFILE_EVENTS];
+		fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"graphTe\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"frame\":%lu,\"pixels\":%llu}}",
+			gtProfileNames[event->zone], event->start / 1000.0, event->nanoseconds / 1000.0, event->frame, (unsigned long long)event->pixels);
+	}
+
+	fprintf(file, "\n]}\n");
+	BOOL written = !ferror(file);
+	return fclose(file) == 0 && written;
+#else
+	(void)filenamePTR;
+	return FALSE;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that draws the profile of the last completed frame over the canvas.
+ * 
+ * \details The overlay lists the frame time, then every group of calls made during the frame with its call count, its time and the pixels it damaged,
+ *          over a bar showing its share of the frame time. It is typically drawn last, right before display().
+ * 
+ * \note    The overlay itself is not measured and is drawn right away, even between beginCommands() and endCommands().
+ *          Its text uses the current text size and stays out of the text cache, so it does not change the hits and misses of the frame.
+ *          Without GRAPHTE_PROFILE this function does nothing.
+ * 
+ * \param[in]   x   The x-coordinate of the upper-left corner of the overlay.
+ * \param[in]   y   The y-coordinate of the upper-left corner of the overlay.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void drawProfileOverlay(int16 x, int16 y)
+{
+#ifdef GRAPHTE_PROFILE
+	profileFrame frame;
+	if(!getProfileFrame(0, &frame))
+		return;
+
+	gtCommandBuffer* recording = gtCommands.recording;
+	blendMode mode = gtBlend.mode;
+	uint16 opacity = gtBlend.opacity;
+	const gtGlyphAtlas* atlas = gtFindGlyphs();
+	if(!atlas)
+		return;
+	gtProfile.paused = TRUE;
+	gtCommands.recording = NULL;
+	gtBlend.mode = BLEND_ALPHA;
+	gtBlend.opacity = 255;
+
+	//! One line for the frame and one for every group of calls made, padded into columns.
+	char lines[PROFILE_ZONES + 1][80];
+	int zones[PROFILE_ZONES + 1], count = 1, width = 0;
+	snprintf(lines[0], sizeof(lines[0]), "frame %lu: %.2f ms", frame.number, frame.nanoseconds / 1e6);
+	for(int zone = 0; zone < PROFILE_ZONES; zone++)
+	{
+		profileCounter* counter = &frame.counters[zone];
+		if(!counter->calls)
+			continue;
+
+		snprintf(lines[count], sizeof(lines[count]), "%-14s %6lu %8.3f ms %9llu px", gtProfileNames[zone], counter->calls, counter->nanoseconds / 1e6, (unsigned long long)counter->pixels);
+		zones[count++] = zone;
+	}
+
+	//! The lines are laid out here with the atlas of the current text size, so the text cache is left untouched.
+	gtPlacedGlyph glyphs[PROFILE_ZONES + 1][80];
+	gtTextLayout layouts[PROFILE_ZONES + 1];
+	int lineHeight = 0;
+	for(int i = 0; i < count; i++)
+	{
+		layouts[i].glyphs = glyphs[i];
+		gtLayoutText(&layouts[i], atlas, lines[i]);
+		if(layouts[i].width > width) width = layouts[i].width;
+		if(layouts[i].height > lineHeight) lineHeight = layouts[i].height;
+	}
+
+	rect(x, y, width + 8, count * lineHeight + 6, rgba(0, 0, 0, 180));
+	for(int i = 0; i < count; i++)
+	{
+		int top = y + 3 + i * lineHeight;
+		//! The bar shows the share of the frame time taken by the group.
+		if(i && frame.nanoseconds)
+			rect(x + 4, top, (uint16)(width * frame.counters[zones[i]].nanoseconds / frame.nanoseconds), lineHeight - 1, rgba(60, 140, 255, 140));
+		gtDrawText(x + 4, top, &layouts[i], (gtRect){0, 0, host.width, host.height}, gtPaint(rgb(255, 255, 255)));
+	}
+
+	gtBlend.mode = mode;
+	gtBlend.opacity = opacity;
+	gtCommands.recording = recording;
+	gtProfile.paused = FALSE;
+#else
+	(void)x;
+	(void)y;
+#endif
+}
+
+////////////////////////////////////////////////////////////
+// Game loop
+////////////////////////////////////////////////////////////
+
+//! The number of frame times kept for getFrameStats().
+#ifndef GRAPHTE_FRAME_SAMPLES
+	#define GRAPHTE_FRAME_SAMPLES 256
+#endif
+
+//! The maximum number of updates run for a single frame. A frame slower than that many steps drops the remaining time instead of falling further behind.
+#ifndef GRAPHTE_MAX_UPDATES
+	#define GRAPHTE_MAX_UPDATES 8
+#endif
+
+//! The time, in milliseconds, before a frame deadline at which the loop stops sleeping and spins, to absorb the inaccuracy of the system sleep.
+#ifndef GRAPHTE_SPIN_TIME
+	#define GRAPHTE_SPIN_TIME 2
+#endif
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   Structure containing the frame time statistics of the game loop.
+ * 
+ * \details The percentiles are computed over the last GRAPHTE_FRAME_SAMPLES frames, a frame time is the interval between the starts of two frames.
+ *          All times are in milliseconds.
+ */
+////////////////////////////////////////////////////////////
+typedef struct
+{
+	unsigned long frames; //! The number of frames run since the start of the program.
+	double average, p50, p95, p99, max;
+}
+frameStats;
+
+//! The state of the game loop.
+struct
+{
+	BOOL running; //! Cleared by stopGameLoop().
+	double samples[GRAPHTE_FRAME_SAMPLES]; //! A ring of the last frame times.
+	unsigned long frames; //! The number of recorded frames, the next sample goes to frames % GRAPHTE_FRAME_SAMPLES.
+}
+gtLoop;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the time of a monotonic clock.
+ * 
+ * \details This function reads a high resolution clock that is not affected by changes of the system time (the performance counter on Windows,
+ *          CLOCK_MONOTONIC elsewhere). Only differences between two values are meaningful.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the current time, in milliseconds.
+ */
+////////////////////////////////////////////////////////////
+double getTime()
+{
+	return gtMilliseconds();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that waits until a point in time.
+ * 
+ * \details This function sleeps until GRAPHTE_SPIN_TIME milliseconds before the deadline, then spins on the clock for the rest,
+ *          which wakes up within microseconds of the deadline instead of within the granularity of the system sleep.
+ * 
+ * \param[in]    deadline  The time to wait for, as returned by gtMilliseconds().
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtWaitUntil(double deadline)
+{
+	double remaining = deadline - gtMilliseconds() - GRAPHTE_SPIN_TIME;
+
+	if(remaining > 0)
+	{
+#ifdef _WIN32
+		Sleep((DWORD)remaining);
+#else
+		double wake = deadline - GRAPHTE_SPIN_TIME;
+		struct timespec time;
+		time.tv_sec = (time_t)(wake / 1000);
+		time.tv_nsec = (long)((wake - time.tv_sec * 1000.0) * 1000000);
+		while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, NULL) == EINTR);
+#endif
+	}
+
+	while(gtMilliseconds() < deadline);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that runs the game loop.
+ * 
+ * \details The update function is called at a fixed rate with a fixed step, whatever the frame rate is, so the game logic behaves the same on every
+ *          machine. Once the updates due have run, the render function draws the frame and should end with display(). It receives how far the
+ *          time has gone into the next step, from 0 to 1, to interpolate between the two last states for motion smoother than the update rate.
+ *          Frames are paced to the target frame rate by sleeping and then spinning until the deadline of the next frame.
+ * 
+ * \note    The loop runs until stopGameLoop() is called from one of the functions. If a frame takes longer than GRAPHTE_MAX_UPDATES steps,
+ *          the remaining time is dropped: the game slows down instead of spending every next frame catching up.
+ * 
+ * \param[in]   update      The function advancing the game by one step, it receives the length of the step in milliseconds.
+ * \param[in]   render      The function drawing the frame, it receives the interpolation factor between the last two updates.
+ * \param[in]   updateRate  The number of updates per second.
+ * \param[in]   frameRate   The target number of frames per second, 0 renders as fast as possible.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void runGameLoop(void (*update)(double step), void (*render)(double alpha), uint16 updateRate, uint16 frameRate)
+{
+	double step = 1000.0 / (updateRate ? updateRate : 60);
+	double period = frameRate ? 1000.0 / frameRate : 0;
+	double accumulator = 0, last = gtMilliseconds(), deadline = last;
+
+#ifdef _WIN32
+	//! The default timer resolution makes Sleep() wake up to 15.6 ms late.
+	timeBeginPeriod(1);
+#endif
+
+	gtLoop.running = TRUE;
+	while(gtLoop.running)
+	{
+		double now = gtMilliseconds();
+		double frameTime = now - last;
+		last = now;
+
+		gtLoop.samples[gtLoop.frames++ % GRAPHTE_FRAME_SAMPLES] = frameTime;
+
+		accumulator += frameTime;
+		for(int updates = 0; accumulator >= step && gtLoop.running; updates++)
+		{
+			if(updates == GRAPHTE_MAX_UPDATES)
+			{
+				accumulator = 0;
+				break;
+			}
+
+			update(step);
+			accumulator -= step;
+		}
+
+		if(!gtLoop.running)
+			break;
+
+		render(accumulator / step);
+
+		if(period)
+		{
+			//! A frame that missed its deadline by more than a period starts a new schedule rather than rushing the next frames.
+			deadline += period;
+			if(gtMilliseconds() > deadline + period)
+				deadline = gtMilliseconds();
+			else
+				gtWaitUntil(deadline);
+		}
+	}
+
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that ends the game loop.
+ * 
+ * \details runGameLoop() returns once the function that called stopGameLoop() returns. No render follows an update that stopped the loop.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void stopGameLoop()
+{
+	gtLoop.running = FALSE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that compares two doubles for qsort().
+ * 
+ * \param[in]    a  The first value.
+ * \param[in]    b  The second value.
+ * 
+ * \return       Returns a negative value, zero or a positive value if the first value is smaller, equal or greater.
+ */
+////////////////////////////////////////////////////////////
+int gtCompareDoubles(const void* a, const void* b)
+{
+	double difference = *(const double*)a - *(const double*)b;
+	return (difference > 0) - (difference < 0);
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that retrieves the frame time statistics of the game loop.
+ * 
+ * \details The statistics are computed from the last GRAPHTE_FRAME_SAMPLES frames on every call, so it is best called once in a while, not every frame.
+ *          Percentiles show the jitter an average hides: a p99 far above the p50 means some frames stall.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function returns the statistics, all zero before the first frame.
+ */
+////////////////////////////////////////////////////////////
+frameStats getFrameStats()
+{
+	frameStats stats;
+	double sorted[GRAPHTE_FRAME_SAMPLES], total = 0;
+	int count = gtLoop.frames < GRAPHTE_FRAME_SAMPLES ? (int)gtLoop.frames : GRAPHTE_FRAME_SAMPLES;
+
+	memset(&stats, 0, sizeof(stats));
+	stats.frames = gtLoop.frames;
+	if(!count)
+		return stats;
+
+	memcpy(sorted, gtLoop.samples, count * sizeof(double));
+	qsort(sorted, count, sizeof(double), gtCompareDoubles);
+	for(int i = 0; i < count; i++)
+		total += sorted[i];
+
+	//! Nearest-rank percentiles.
+	stats.average = total / count;
+	stats.p50 = sorted[(count * 50 + 99) / 100 - 1];
+	stats.p95 = sorted[(count * 95 + 99) / 100 - 1];
+	stats.p99 = sorted[(count * 99 + 99) / 100 - 1];
+	stats.max = sorted[count - 1];
+	return stats;
+}
+
+////////////////////////////////////////////////////////////
+// Parallel shading
+////////////////////////////////////////////////////////////
+
+//! The side, in pixels, of the square tiles shade() splits its region into. A tile is the unit of work taken and stolen by the threads.
+#ifndef GRAPHTE_SHADE_TILE
+	#define GRAPHTE_SHADE_TILE 32
+#endif
+
+//! The maximum number of threads shading at once, the calling thread included.
+#ifndef GRAPHTE_MAX_THREADS
+	#define GRAPHTE_MAX_THREADS 64
+#endif
+
+//! The tiles left to a thread, packed as first << 32 | end. The owner takes tiles from the front, other threads steal halves from the back.
+//! Every range fills its own cache line so the threads do not slow each other down when they only touch their own.
+typedef struct
+{
+	volatile long long tiles;
+	char padding[64 - sizeof(long long)];
+}
+gtTileRange;
+
+//! The worker threads of shade() and drawCommands(), and the job they are working on.
+struct
+{
+	gtMonitor monitor; //! Protects everything below except the tile ranges and the remaining count.
+	BOOL ready; //! TRUE once the monitor has been initialized.
+	BOOL running; //! TRUE while the worker threads are started.
+	BOOL quit; //! Set to end the worker threads.
+	int threadCount; //! The number of threads requested with setThreadCount(), 0 for one per processor.
+	int workers; //! The number of worker threads running, the calling thread of shade() is not counted.
+	gtThread threads[GRAPHTE_MAX_THREADS];
+	gtTileRange ranges[GRAPHTE_MAX_THREADS]; //! The tiles of every thread, the calling thread of shade() owns the first range.
+	void (*job)(int left, int top, int right, int bottom); //! Draws one tile of the current job.
+	color (*function)(uint16 x, uint16 y, void* userData); //! The shader of a shade() job.
+	void* userData; //! The value passed to the shader.
+	int left, top, right, bottom; //! The region of the current job.
+	int tileSize; //! The side of the tiles of the current job.
+	int columns; //! The number of tiles in a row of the region.
+	long generation; //! Incremented for every job, the workers wait for it to change.
+	int active; //! The number of workers inside the current job.
+	volatile long remaining; //! The number of tiles of the current job not shaded yet.
+}
+gtPool;
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that takes the next tile of a thread's own range.
+ * 
+ * \param[in]    index  The index of the thread.
+ * 
+ * \return       Returns the index of the tile, or -1 if the range is empty.
+ */
+////////////////////////////////////////////////////////////
+long gtTakeTile(int index)
+{
+	volatile long long* range = &gtPool.ranges[index].tiles;
+
+	while(1)
+	{
+		long long tiles = gtAtomicLoad64(range);
+		long long first = tiles >> 32, end = tiles & 0xFFFFFFFF;
+		if(first >= end)
+			return -1;
+		if(gtAtomicSwap64(range, tiles, (first + 1) << 32 | end))
+			return (long)first;
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that steals work for a thread whose range is empty.
+ * 
+ * \details The other ranges are visited in turn starting after the thread's own, and the back half of the first non-empty one is moved into
+ *          the thread's range. When every range is empty the job has no tile left to hand out.
+ * 
+ * \param[in]    index  The index of the thread.
+ * 
+ * \return       Returns the index of the first stolen tile, the rest is left in the thread's range, or -1 if nothing is left to steal.
+ */
+////////////////////////////////////////////////////////////
+long gtStealTiles(int index)
+{
+	int count = gtPool.workers + 1;
+
+	for(int offset = 1; offset < count; offset++)
+	{
+		volatile long long* victim = &gtPool.ranges[(index + offset) % count].tiles;
+
+		while(1)
+		{
+			long long tiles = gtAtomicLoad64(victim);
+			long long first = tiles >> 32, end = tiles & 0xFFFFFFFF, half = (end - first + 1) / 2;
+			if(first >= end)
+				break;
+
+			if(gtAtomicSwap64(victim, tiles, first << 32 | (end - half)))
+			{
+				//! An empty range is never changed by the other threads, the swap can only fail on a spurious failure.
+				volatile long long* own = &gtPool.ranges[index].tiles;
+				while(!gtAtomicSwap64(own, gtAtomicLoad64(own), (end - half + 1) << 32 | end));
+				return (long)(end - half);
+			}
+		}
+	}
+
+	return -1;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that runs tiles of the current job until none is left.
+ * 
+ * \param[in]    index  The index of the thread.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtRunTiles(int index)
+{
+	while(1)
+	{
+		long tile = gtTakeTile(index);
+		if(tile < 0 && (tile = gtStealTiles(index)) < 0)
+			return;
+
+		int left = gtPool.left + (int)(tile % gtPool.columns) * gtPool.tileSize;
+		int top = gtPool.top + (int)(tile / gtPool.columns) * gtPool.tileSize;
+		int right = left + gtPool.tileSize < gtPool.right ? left + gtPool.tileSize : gtPool.right;
+		int bottom = top + gtPool.tileSize < gtPool.bottom ? top + gtPool.tileSize : gtPool.bottom;
+
+		gtPool.job(left, top, right, bottom);
+
+		//! The last tile wakes the calling thread, which waits for the whole region.
+		if(!gtAtomicAdd(&gtPool.remaining, -1))
+		{
+			gtMonitorEnter(&gtPool.monitor);
+			gtMonitorWakeAll(&gtPool.monitor);
+			gtMonitorLeave(&gtPool.monitor);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that runs a worker thread of the shading pool.
+ * 
+ * \details The worker sleeps until a job is published, runs and steals tiles until none is left, then sleeps again.
+ *          Entering and leaving a job are counted, so the job is never changed while a worker still reads it.
+ * 
+ * \param[in]    argument  The index of the worker's tile range.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtPoolWorker(void* argument)
+{
+	int index = (int)(intptr_t)argument;
+
+	gtMonitorEnter(&gtPool.monitor);
+	long seen = gtPool.generation;
+
+	while(1)
+	{
+		while(gtPool.generation == seen && !gtPool.quit)
+			gtMonitorWait(&gtPool.monitor);
+		if(gtPool.quit)
+			break;
+
+		seen = gtPool.generation;
+		gtPool.active++;
+		gtMonitorLeave(&gtPool.monitor);
+
+		gtRunTiles(index);
+
+		gtMonitorEnter(&gtPool.monitor);
+		if(!--gtPool.active)
+			gtMonitorWakeAll(&gtPool.monitor);
+	}
+
+	gtMonitorLeave(&gtPool.monitor);
+	gtReleaseStroke();
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that starts the worker threads of the shading pool if they are not running.
+ * 
+ * \param   This function does not have any parameters.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void gtStartPool()
+{
+	if(gtPool.running)
+		return;
+
+	if(!gtPool.ready)
+	{
+		gtMonitorInit(&gtPool.monitor);
+		gtPool.ready = TRUE;
+	}
+
+	int count = gtPool.threadCount ? gtPool.threadCount : gtProcessorCount();
+	if(count > GRAPHTE_MAX_THREADS)
+		count = GRAPHTE_MAX_THREADS;
+
+	gtPool.quit = FALSE;
+	gtPool.workers = 0;
+	for(int i = 1; i < count; i++)
+	{
+		gtPool.ranges[i].tiles = 0;
+		if(!gtStartThread(&gtPool.threads[gtPool.workers], gtPoolWorker, (void*)(intptr_t)i))
+			break;
+		gtPool.workers++;
+	}
+	gtPool.running = TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that sets the number of threads used by shade() and drawCommands().
+ * 
+ * \details shade() and drawCommands() run on a pool of worker threads started the first time they need it, plus the calling thread. By default there is one
+ *          thread per logical processor. Changing the count stops the running workers, the new ones are started by the next call that needs them.
+ * 
+ * \note    This function must not be called from a shader.
+ * 
+ * \param[in]    count  The number of threads, the calling thread included. 1 draws on the calling thread only, 0 restores the default.
+ *                      At most GRAPHTE_MAX_THREADS threads are used.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setThreadCount(uint16 count)
+{
+	gtPool.threadCount = count;
+	if(!gtPool.running)
+		return;
+
+	gtMonitorEnter(&gtPool.monitor);
+	gtPool.quit = TRUE;
+	gtMonitorWakeAll(&gtPool.monitor);
+	gtMonitorLeave(&gtPool.monitor);
+
+	for(int i = 0; i < gtPool.workers; i++)
+		gtJoinThread(gtPool.threads[i]);
+	gtPool.workers = 0;
+	gtPool.running = FALSE;
+}
+
+//! Shades the pixels of a tile of a shade() job.
+void gtShadeTile(int left, int top, int right, int bottom)
 {
-	BitBlt(host.hdc, 0, 0, host.width, host.height, host.bufferDC, 0, 0, SRCCOPY);
+	for(int y = top; y < bottom; y++)
+	{
+		uint32_t* row = host.pixels + (size_t)y * host.stride;
+		for(int x = left; x < right; x++)
+			row[x] = pixelValue(gtPool.function(x, y, gtPool.userData));
+	}
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that moves the console cursor to another position.
+ * \brief   A function that runs a job on every tile of a region, on all the threads of the pool.
  * 
- * \details This function moves the cursor to the specified screen coordinates. If the new coordinates are not within the screen rectangle set by the most recent updateWindowBounds()
- *          function call, the system automatically adjusts the coordinates so that the console cursor stays within the rectangle.
- * 
- * \note   The console cursor's coordinates must be specified in the character grid format.(IE: x:4, y:6 is the 6th line and the 4th column).
+ * \details The tiles are dealt evenly to the threads, the calling thread included, then taken and stolen until none is left.
+ *          The function returns once every tile is done.
  * 
- * \param[in]   x   The new x-coordinate of the cursor, in character grid coordinates format.
- * \param[in]   y   The new y-coordinate of the cursor, in character grid coordinates format.
+ * \param[in]    job       The function drawing one tile, given its rectangle, right and bottom excluded.
+ * \param[in]    left      The left edge of the region.
+ * \param[in]    top       The top edge of the region.
+ * \param[in]    right     The right edge of the region, excluded.
+ * \param[in]    bottom    The bottom edge of the region, excluded.
+ * \param[in]    tileSize  The side of the tiles. The tiles of the first row and column start at the edges of the region.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void moveCursor(uint16 x, uint16 y)
+void gtRunPool(void (*job)(int left, int top, int right, int bottom), int left, int top, int right, int bottom, int tileSize)
 {
-	COORD position;
-	position.X = x;
-	position.Y = y;
-	SetConsoleCursorPosition(host.outputHandle, position);
+	int columns = (right - left + tileSize - 1) / tileSize;
+	long tiles = (long)columns * ((bottom - top + tileSize - 1) / tileSize);
+
+	gtStartPool();
+
+	//! A worker may still be leaving the previous job, which reads the job description.
+	if(gtPool.workers)
+	{
+		gtMonitorEnter(&gtPool.monitor);
+		while(gtPool.active)
+			gtMonitorWait(&gtPool.monitor);
+	}
+
+	gtPool.job = job;
+	gtPool.left = left;
+	gtPool.top = top;
+	gtPool.right = right;
+	gtPool.bottom = bottom;
+	gtPool.tileSize = tileSize;
+	gtPool.columns = columns;
+	gtPool.remaining = tiles;
+
+	for(int i = 0; i <= gtPool.workers; i++)
+	{
+		long long first = tiles * i / (gtPool.workers + 1), end = tiles * (i + 1) / (gtPool.workers + 1);
+		gtPool.ranges[i].tiles = first << 32 | end;
+	}
+
+	if(!gtPool.workers)
+	{
+		gtRunTiles(0);
+		return;
+	}
+
+	gtPool.generation++;
+	gtMonitorWakeAll(&gtPool.monitor);
+	gtMonitorLeave(&gtPool.monitor);
+
+	gtRunTiles(0);
+
+	gtMonitorEnter(&gtPool.monitor);
+	while(gtAtomicLoad(&gtPool.remaining) || gtPool.active)
+		gtMonitorWait(&gtPool.monitor);
+	gtMonitorLeave(&gtPool.monitor);
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function that changes the color of a pixel on screen.
+ * \brief   A function that computes the color of every pixel of a region in parallel.
  * 
- * \details This function sets the pixel at the specified coordinates to the specified color.
+ * \details The region is split into square tiles of GRAPHTE_SHADE_TILE pixels, dealt evenly to the threads (see setThreadCount()). A thread
+ *          that runs out of tiles steals half of the tiles left to another one, so regions that cost more in some places than in others,
+ *          like escape-time fractals, still keep every processor busy until the end. The colors are written straight into the back buffer.
+ *          The function returns once the whole region is shaded.
  * 
- * \note   Multiple calls of this function can be used to create custom vertex shape drawing.
+ * \note    The shader is called from several threads at once, in no particular order: it must only read shared data, or protect what it writes.
+ *          It must not call graphTe drawing functions or shade() itself.
+ *          The part of the region outside of the canvas is not shaded.
  * 
- * \param[in]   x          The x-coordinate, in logical units, of the points to be set.
- * \param[in]   y          The y-coordinate, in logical units, of the points to be set.
- * \param[in]   fillColor  The color to be used to paint the pixel. To create a graphTe color value, use the rgb() function.
+ * \param[in]    x         The x-coordinate of the region.
+ * \param[in]    y         The y-coordinate of the region.
+ * \param[in]    width     The width of the region.
+ * \param[in]    height    The height of the region.
+ * \param[in]    function  The shader, called with the canvas coordinates of every pixel and the user data, returning the color of that pixel.
+ * \param[in]    userData  A value passed to every call of the shader.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void pixel(int16 x, int16 y, color fillColor)
+void shade(int16 x, int16 y, uint16 width, uint16 height, color (*function)(uint16 x, uint16 y, void* userData), void* userData)
 {
-	SetPixelV(host.bufferDC, x, y, RGB(fillColor.red, fillColor.green, fillColor.blue));
+	int left = x < 0 ? 0 : x, top = y < 0 ? 0 : y;
+	int right = x + width < host.width ? x + width : host.width, bottom = y + height < host.height ? y + height : host.height;
+	if(left >= right || top >= bottom)
+		return;
+	GRAPHTE_PROFILE_BEGIN(PROFILE_SHADE);
+
+	gtAddDamage(left, top, right, bottom);
+#ifdef GRAPHTE_BACKEND_GDI
+	//! GDI batches its drawing calls, they must be completed before the threads write the DIB bits.
+	GdiFlush();
+#endif
+
+	//! No worker is inside a job between two calls, the previous one waited for all of them to leave.
+	gtPool.function = function;
+	gtPool.userData = userData;
+	gtRunPool(gtShadeTile, left, top, right, bottom, GRAPHTE_SHADE_TILE);
+	GRAPHTE_PROFILE_END();
 }
 
+////////////////////////////////////////////////////////////
+// Command buffers
+////////////////////////////////////////////////////////////
+
+//! A handle to a command buffer, as returned by createCommandBuffer(). Negative values are invalid handles.
+typedef int16 commandBuffer;
+
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function draws a rectangle on the memory canvas.
- * 
- * \details This function draws a rectangle of the specified size to the specified coordinates. The rectangle has no outline and is filled with the given graphTe color. 
- * 
- * \note   This function is more efficient than multiple pixel() calls as it gives a single GPU job call.
- *          The use of this function along with individual FillRect() calls is not advised since the DC brush color is globaly set on the host device context.
+ * \brief   A function that retrieves a command buffer.
  * 
- * \param[in]   x          The x-coordinate, in logical coordinates, of the upper-left corner of the rectangle.
- * \param[in]   y          The y-coordinate, in logical coordinates, of the upper-left corner of the rectangle.
- * \param[in]   width      The width, in logical units, of the rectangle.
- * \param[in]   height     The height, in logical units, of the rectangle.
- * \param[in]   fillColor  The color to be used to paint the rectangle. To create a graphTe color value, use the rgb() function.
+ * \param[in]    handle  The handle returned by createCommandBuffer().
  * 
- * \return  This function does not return anything.
+ * \return       Returns the command buffer, or NULL for an invalid handle.
  */
 ////////////////////////////////////////////////////////////
-void rect(int16 x, int16 y, uint16 width, uint16 height, color fillColor)
+gtCommandBuffer* gtGetCommandBuffer(commandBuffer handle)
 {
-	RECT frame;
+	if(handle < 0 || handle >= GRAPHTE_COMMAND_BUFFERS || !gtCommands.entries[handle].used)
+		return NULL;
 
-	frame.left = x;
-	frame.top = y;
-	frame.right = x + width;
-	frame.bottom = y + height;
+	return &gtCommands.entries[handle];
+}
 
-	SetDCBrushColor(host.bufferDC, RGB(fillColor.red, fillColor.green, fillColor.blue));
-	FillRect(host.bufferDC, &frame, GetStockObject(DC_BRUSH));
+//! Tells whether two commands can draw on the same pixels, in which case they keep their order.
+BOOL gtCommandsOverlap(const gtCommand* first, const gtCommand* second)
+{
+	return first->left < second->right && second->left < first->right && first->top < second->bottom && second->top < first->bottom;
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function paints the entire screen with one color.
+ * \brief   A function that creates an empty command buffer.
  * 
- * \details This function paints the screen with a single color. This function is usually called once every frame, to clear the previous contents of the target. 
+ * \details A command buffer keeps a list of drawing calls, recorded once between beginCommands() and endCommands(), then drawn as many times
+ *          as needed with drawCommands(). Static content such as a background is recorded once and replayed every frame.
  * 
- * \note   Not updating the canvas size before calling this function will result in unexpected behaviour.
- *
- * \param[in]   fillColor  The color to be used to clear the render target. To create a graphTe color value, use the rgb() function.
+ * \param   This function does not have any parameters.
  * 
- * \return  This function does not return anything.
+ * \return  This function returns the command buffer handle, or -1 if all GRAPHTE_COMMAND_BUFFERS slots are in use.
  */
 ////////////////////////////////////////////////////////////
-void fill(color fillColor)
+commandBuffer createCommandBuffer()
 {
-	rect(0, 0, host.width, host.height, fillColor);
+	for(commandBuffer handle = 0; handle < GRAPHTE_COMMAND_BUFFERS; handle++)
+	{
+		if(!gtCommands.entries[handle].used)
+		{
+			gtCommands.entries[handle] = (gtCommandBuffer){NULL, 0, 0, 0, TRUE};
+			return handle;
+		}
+	}
+
+	return -1;
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function paints a line between two given points.
+ * \brief   A function that destroys a command buffer.
  * 
- * \details This function draws a line from the first given position up to, but not including the specified second position.
+ * \details This function frees the recorded commands. If the buffer is being recorded, the recording stops.
  * 
- * \note   This function works with any line orientation, including negative points values.
- *
- * \param[in]   x1         Specifies the x-coordinate, in logical units, of the line's start point.
- * \param[in]   y1         Specifies the y-coordinate, in logical units, of the line's start point.
- * \param[in]   x2         Specifies the x-coordinate, in logical units, of the line's end point.
- * \param[in]   y2         Specifies the y-coordinate, in logical units, of the line's end point.
- * \param[in]   width      Specifies the width, in logical units, of the line's body.
- * \param[in]   fillColor  The color that the line will be painted in. To create a graphTe color value, use the rgb() function.
+ * \note    The handle must not be used after this call.
+ * 
+ * \param[in]   handle  The handle returned by createCommandBuffer().
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void line(int16 x1, int16 y1, int16 x2, int16 y2, uint16 width, color fillColor)
+void freeCommandBuffer(commandBuffer handle)
 {
-	host.linePen = CreatePen(PS_SOLID, width, RGB(fillColor.red, fillColor.green, fillColor.blue));
-	SelectObject(host.bufferDC, host.linePen);
-	MoveToEx(host.bufferDC, x1, y1, NULL);
-	LineTo(host.bufferDC, x2, y2);
-	DeleteObject(host.linePen);
-	SelectObject(host.bufferDC, GetStockObject(DC_PEN));
+	gtCommandBuffer* buffer = gtGetCommandBuffer(handle);
+	if(!buffer)
+		return;
+
+	if(gtCommands.recording == buffer)
+		gtCommands.recording = NULL;
+	free(buffer->bytes);
+	*buffer = (gtCommandBuffer){NULL, 0, 0, 0, FALSE};
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function paints an ellipse at the specified point.
+ * \brief   A function that starts recording drawing calls into a command buffer.
  * 
- * \details This function draws an ellipse. The center of the ellipse is the center of the specified bounding rectangle.
- *          The ellipse is filled with the specified fillColor and has no outline.
+ * \details The previous content of the buffer is dropped. Until endCommands(), rect(), fill(), line(), polyline(), ellipse(), circle(),
+ *          triangle(), shadedTriangle(), image(), transparentImage(), drawTexture(), drawTransparentTexture(), drawSprites(), drawSprite(),
+ *          text() and textRect() are recorded instead of drawn, along with the blend mode, opacity, antialiasing and text size they use.
  * 
- * \note   This function accepts inverse-scale bounding rectangles.
- *
- * \param[in]   x          Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   y          Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   width      The width, in logical units, of the bounding rectangle.
- * \param[in]   height     The height, in logical units, of the bounding rectangle.
- * \param[in]   fillColor  The color that the ellipse will be painted in. To create a graphTe color value, use the rgb() function.
+ * \note    The other functions (pixel(), shade(), lockPixels(), ...) still draw right away. Strings and paths are copied into the buffer,
+ *          but textures and sprite atlases are recorded by handle and must stay loaded while the buffer is used.
+ *          The memory of the buffer is kept, recording a frame of the same size again does not allocate.
+ * 
+ * \param[in]   handle  The handle returned by createCommandBuffer().
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void ellipse(int16 x, int16 y, uint16 width, uint16 height, color fillColor)
+void beginCommands(commandBuffer handle)
 {
-	SetDCPenColor(host.bufferDC, RGB(fillColor.red, fillColor.green, fillColor.blue));
-	SetDCBrushColor(host.bufferDC, RGB(fillColor.red, fillColor.green, fillColor.blue));
-	Ellipse(host.bufferDC, x, y, x + width, y + height);
+	gtCommandBuffer* buffer = gtGetCommandBuffer(handle);
+	if(!buffer)
+		return;
+
+	buffer->size = 0;
+	buffer->count = 0;
+	gtCommands.recording = buffer;
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function paints a circle at the specified point.
+ * \brief   A function that stops recording drawing calls.
  * 
- * \details This function draws a circle. The center of the ellipse is the center of the specified bounding rectangle.
- * 			The bounding rectangle's width and height are equal to the diameter of the circle.
- *          The ellipse is filled with the specified fillColor and has no outline.
+ * \details The drawing functions draw right away again.
  * 
- * \note   This function accepts inverse-scale bounding rectangles.
- *          This function serves as a convienience wrapper for the ellipse function.
- *
- * \param[in]   x          Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   y          Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   radius     The size, in logical units, of the circle's radius. (The width\height of the bounding rectangle will be twice the amount of this)
- * \param[in]   fillColor  The color that the circle will be painted in. To create a graphTe color value, use the rgb() function.
+ * \param   This function does not have any parameters.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void circle(int16 x, int16 y, uint16 radius, color fillColor)
+void endCommands()
 {
-	ellipse(x, y, 2 * radius, 2 * radius, fillColor);
+	gtCommands.recording = NULL;
+}
+
+//! The side, in pixels, of the square tiles drawCommands() splits the window into to draw on several threads. It is a multiple of
+//! GRAPHTE_TRIANGLE_BLOCK, so that the triangles are traversed in the same blocks as on a single thread.
+#ifndef GRAPHTE_RASTER_TILE
+	#define GRAPHTE_RASTER_TILE 128
+#endif
+#if GRAPHTE_RASTER_TILE % GRAPHTE_TRIANGLE_BLOCK
+	#error "GRAPHTE_RASTER_TILE must be a multiple of GRAPHTE_TRIANGLE_BLOCK"
+#endif
+
+//! The commands of a run drawn on several threads, binned into the tiles of the window.
+struct
+{
+	gtCommand** commands; //! The commands of the run, in their order.
+	size_t commandCapacity;
+	uint32_t* starts; //! The first entry of every tile, followed by the number of entries.
+	size_t startCapacity;
+	uint32_t* entries; //! The commands drawn in every tile, in their order, tile after tile.
+	size_t entryCapacity;
+	int columns; //! The number of tiles in a row of the window.
+}
+gtBins;
+
+#ifdef GRAPHTE_SOFTWARE
+//! Tells whether a command is drawn by the rasterizers of graphTe alone, without touching any cache, which lets several threads draw it at once.
+BOOL gtTileable(const gtCommand* command)
+{
+	return command->type == COMMAND_RECT || command->type == COMMAND_LINE || command->type == COMMAND_POLYLINE ||
+	       command->type == COMMAND_ELLIPSE || command->type == COMMAND_TRIANGLE || command->type == COMMAND_SHADED_TRIANGLE;
+}
+
+//! Finds the tiles a command can draw in, as a range of columns and rows. Returns FALSE for a command outside of the window.
+BOOL gtCommandTiles(const gtCommand* command, int* firstColumn, int* firstRow, int* lastColumn, int* lastRow)
+{
+	int left = command->left < 0 ? 0 : command->left, top = command->top < 0 ? 0 : command->top;
+	int right = command->right > host.width ? host.width : command->right, bottom = command->bottom > host.height ? host.height : command->bottom;
+	if(left >= right || top >= bottom)
+		return FALSE;
+
+	*firstColumn = left / GRAPHTE_RASTER_TILE;
+	*firstRow = top / GRAPHTE_RASTER_TILE;
+	*lastColumn = (right - 1) / GRAPHTE_RASTER_TILE;
+	*lastRow = (bottom - 1) / GRAPHTE_RASTER_TILE;
+	return TRUE;
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function draws an image at the specified point.
+ * \brief   A function that draws a command with the rasterizers of graphTe, in the drawing area of the calling thread.
  * 
- * \details This function renders a external bitmap buffer to the specified screen bounding rectangle. This function can load from a file a
- * 	        bitmap, icon, cursor or animated cursor. The primary use of this function is to render images on screen.
+ * \details The command is drawn with the state it was recorded with, like drawCommands() does with the public drawing functions,
+ *          but without tracking the damage, which is done once for the whole run.
  * 
- * \note   This function accepts inverse-scale bounding rectangles.
- *
- * \param[in]   x            Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   y            Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   width        The width, in logical units, of the bounding rectangle.
- * \param[in]   height       The height, in logical units, of the bounding rectangle.
- * \param[in]   filenamePTR  A reference to a constant file path that will be used to retrieve the bitmap.
+ * \param[in]    command  A command for which gtTileable() is TRUE.
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void image(int16 x, int16 y, uint16 width, uint16 height, char* filenamePTR)
+void gtRasterCommand(const gtCommand* command)
 {
-	char filename[_CMAX];
-	strcpy(filename, filenamePTR); 
-	HBITMAP imageBitmap = LoadImageA(NULL, filename, IMAGE_BITMAP, width, height, LR_LOADFROMFILE);
-	SelectObject(host.imageDC, imageBitmap);
+	const void* arguments = command + 1;
+
+	gtBlend.mode = (blendMode)command->mode;
+	gtBlend.opacity = command->opacity;
+	gtStroke.antialias = command->antialias;
+
+	switch(command->type)
+	{
+		case COMMAND_RECT:
+		case COMMAND_ELLIPSE:
+		{
+			const gtRectCommand* shape = (const gtRectCommand*)arguments;
+			if(command->type == COMMAND_RECT)
+				gtPaintRect(shape->x, shape->y, shape->x + shape->width, shape->y + shape->height, gtPaint(shape->fillColor));
+			else
+				gtRasterEllipse(shape->x, shape->y, shape->width, shape->height, gtPaint(shape->fillColor));
+			break;
+		}
+		case COMMAND_LINE:
+		{
+			const gtLineCommand* segment = (const gtLineCommand*)arguments;
+			vector2f points[2] = {{(float)segment->x1, (float)segment->y1}, {(float)segment->x2, (float)segment->y2}};
+			gtStrokePath(points, 2, segment->width ? segment->width : 1, gtPaint(segment->fillColor));
+			break;
+		}
+		case COMMAND_POLYLINE:
+		{
+			const gtPolylineCommand* path = (const gtPolylineCommand*)arguments;
+			gtStrokePath((const vector2f*)(path + 1), path->count, path->width, gtPaint(path->fillColor));
+			break;
+		}
+		case COMMAND_TRIANGLE:
+		case COMMAND_SHADED_TRIANGLE:
+		{
+			//! The rasterizer reorders the corners, the recorded ones are left as they are.
+			vertex corners[3];
+			memcpy(corners, ((const gtTriangleCommand*)arguments)->corners, sizeof(corners));
+			gtRasterTriangle(corners, command->type == COMMAND_SHADED_TRIANGLE);
+			break;
+		}
+	}
+}
+
+//! Draws the commands binned into a tile of the window, in their order. The tile belongs to the calling thread alone until it is done.
+void gtDrawTile(int left, int top, int right, int bottom)
+{
+	int tile = top / GRAPHTE_RASTER_TILE * gtBins.columns + left / GRAPHTE_RASTER_TILE;
 
-	BitBlt(host.bufferDC, x, y, width, height, host.imageDC, 0, 0, SRCCOPY);
-	
-	DeleteObject(imageBitmap);
+	gtTile.left = left;
+	gtTile.top = top;
+	gtTile.right = right;
+	gtTile.bottom = bottom;
+	gtTile.active = TRUE;
+
+	for(uint32_t i = gtBins.starts[tile]; i < gtBins.starts[tile + 1]; i++)
+		gtRasterCommand(gtBins.commands[gtBins.entries[i]]);
+
+	gtTile.active = FALSE;
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function draws an image with transparency at the specified point.
+ * \brief   A function that draws a run of commands on all the threads of the pool.
  * 
- * \details This function renders a external bitmap buffer to the specified screen bounding rectangle. This function can load from a file a
- * 	        bitmap, icon, cursor or animated cursor. The primary use of this function is to render images on screen. This function acts different from the 
- *          image() function by the use of an additional parameter transparentColor. The bitmap image will have every pixel that matches the transparentColor
- *          skipped, making a similar effect to transparent image formats.
+ * \details Every command is binned into the GRAPHTE_RASTER_TILE tiles its rectangle touches, then every tile is drawn by a single thread,
+ *          which draws its commands in their order, clipped to the tile. No pixel is written by two threads, and every pixel goes through
+ *          the same commands in the same order as on a single thread, so the result is exactly the same.
+ *          The damage and the depth buffer are prepared beforehand on the calling thread.
  * 
- * \note   This function accepts inverse-scale bounding rectangles.
- *
- * \param[in]   x                Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   y                Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   width            The width, in logical units, of the bounding rectangle.
- * \param[in]   height           The height, in logical units, of the bounding rectangle.
- * \param[in]   filenamePTR      A reference to a constant file path that will be used to retrieve the bitmap.
- * \param[in]   transparentColor The color that will be replaced with transparency at the render step. To create a graphTe color value, use the rgb() function.
+ * \param[in]    bytes  The first command of the run.
+ * \param[in]    count  The number of commands, gtTileable() is TRUE for all of them.
  * 
- * \return  This function does not return anything.
+ * \return       Returns FALSE if the bins could not be allocated, nothing is drawn then.
  */
 ////////////////////////////////////////////////////////////
-void transparentImage(int16 x, int16 y, uint16 width, uint16 height, char* filenamePTR, color transparentColor)
+BOOL gtDrawTiles(char* bytes, uint32_t count)
 {
-	char filename[_CMAX];
-	strcpy(filename, filenamePTR); 
-	HBITMAP imageBitmap = LoadImageA(NULL, filename, IMAGE_BITMAP, width, height, LR_LOADFROMFILE);
-	SelectObject(host.imageDC, imageBitmap);
+	int columns = (host.width + GRAPHTE_RASTER_TILE - 1) / GRAPHTE_RASTER_TILE, rows = (host.height + GRAPHTE_RASTER_TILE - 1) / GRAPHTE_RASTER_TILE;
+	size_t tiles = (size_t)columns * rows, entryCount = 0;
+	int firstColumn, firstRow, lastColumn, lastRow;
+	BOOL depth = FALSE;
+
+	if(!gtReserve((void**)&gtBins.commands, &gtBins.commandCapacity, count, sizeof(gtCommand*)) ||
+	   !gtReserve((void**)&gtBins.starts, &gtBins.startCapacity, tiles + 1, sizeof(uint32_t)))
+		return FALSE;
+	memset(gtBins.starts, 0, (tiles + 1) * sizeof(uint32_t));
+	gtBins.columns = columns;
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		gtCommand* command = (gtCommand*)bytes;
+		bytes += command->size;
+		gtBins.commands[i] = command;
+		if(!gtCommandTiles(command, &firstColumn, &firstRow, &lastColumn, &lastRow))
+			continue;
+
+		for(int row = firstRow; row <= lastRow; row++)
+			for(int column = firstColumn; column <= lastColumn; column++)
+				gtBins.starts[row * columns + column]++;
+		entryCount += (size_t)(lastColumn - firstColumn + 1) * (lastRow - firstRow + 1);
+		depth = depth || command->type == COMMAND_SHADED_TRIANGLE;
+	}
+
+	if(!gtReserve((void**)&gtBins.entries, &gtBins.entryCapacity, entryCount, sizeof(uint32_t)))
+		return FALSE;
+
+	//! The counts become the end of every tile's entries, then the commands are placed from the last one, which leaves every tile sorted
+	//! and its start in place of its end.
+	for(size_t tile = 1; tile <= tiles; tile++)
+		gtBins.starts[tile] += gtBins.starts[tile - 1];
+	for(uint32_t i = count; i-- > 0; )
+	{
+		if(!gtCommandTiles(gtBins.commands[i], &firstColumn, &firstRow, &lastColumn, &lastRow))
+			continue;
+
+		gtAddDamage(gtBins.commands[i]->left, gtBins.commands[i]->top, gtBins.commands[i]->right, gtBins.commands[i]->bottom);
+		for(int row = firstRow; row <= lastRow; row++)
+			for(int column = firstColumn; column <= lastColumn; column++)
+				gtBins.entries[--gtBins.starts[row * columns + column]] = i;
+	}
 
-	TransparentBlt(host.bufferDC, x, y, width, height, host.imageDC, 0, 0, width, height, RGB(transparentColor.red, transparentColor.green, transparentColor.blue));
+	if(depth)
+		gtPrepareDepth();
 
-	DeleteObject(imageBitmap);
+	gtRunPool(gtDrawTile, 0, 0, host.width, host.height, GRAPHTE_RASTER_TILE);
+	return TRUE;
+}
+#endif
+
+//! Tells whether drawCommands() draws on several threads: on the software backends, for a window of several tiles, when the pool has several threads.
+BOOL gtTiledDrawing()
+{
+#ifdef GRAPHTE_SOFTWARE
+	if(gtCommands.recording || gtPool.threadCount == 1 || (host.width <= GRAPHTE_RASTER_TILE && host.height <= GRAPHTE_RASTER_TILE))
+		return FALSE;
+
+	gtStartPool();
+	return gtPool.workers > 0;
+#else
+	return FALSE;
+#endif
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function draws text in specified bounding rectangle.
+ * \brief   A function that draws the commands of a command buffer.
  * 
- * \details This function draws formatted text in the specified bounding rectangle. It formats the text according to the specified
- *          method (expanding tabs, justifying charecters, breaking lines, and so forth).
+ * \details The commands are drawn in their order, each one with the blend mode, opacity, antialiasing and text size it was recorded with.
+ *          Commands entirely outside of the window are skipped. The current drawing state is left as it was.
+ *          On the software backends, consecutive rectangles, lines, ellipses and triangles are drawn on several threads (see setThreadCount()):
+ *          the window is split into tiles of GRAPHTE_RASTER_TILE pixels, every command is binned into the tiles it touches, and every tile is
+ *          drawn by one thread. The result is exactly the same as on a single thread.
  * 
- * \note    This function accepts inverse-scale bounding rectangles.
- *
- * \param[in]   x          Specifies the x-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   y          Specifies the y-coordinate, in logical units, of the bounding rectangle's upper-left corner.
- * \param[in]   width      The width, in logical units, of the bounding rectangle.
- * \param[in]   height     The height, in logical units, of the bounding rectangle.
- * \param[in]   textPTR    A reference to a constant char* containing the desired text to draw.
- * \param[in]   fillColor  The color that will be used to paint the text. To create a graphTe color value, use the rgb() function.
+ * \note    Drawing a command buffer while recording another one copies its commands into the recorded one.
+ *          Images, textures, sprites and text are drawn on the calling thread, between the runs drawn in parallel.
+ * 
+ * \param[in]   handle  The handle returned by createCommandBuffer().
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void textRect(int16 x, int16 y, uint16 width, uint16 height, char* textPTR, color fillColor)
+void drawCommands(commandBuffer handle)
 {
-	char text[_CMAX];
-	strcpy(text, textPTR);
+	gtCommandBuffer* buffer = gtGetCommandBuffer(handle);
+	//! A buffer replayed into itself would grow while it is read.
+	if(!buffer || buffer == gtCommands.recording)
+		return;
+	GRAPHTE_PROFILE_BEGIN(PROFILE_COMMANDS);
+
+	blendMode mode = gtBlend.mode;
+	uint16 opacity = gtBlend.opacity, textSize = gtTexts.size;
+	BOOL antialias = gtStroke.antialias, tiled = gtTiledDrawing();
 
-	RECT textBox;
-	textBox.left = x;
-	textBox.top = y;
-	textBox.right = x + width;
-	textBox.bottom = y + height;
+	for(size_t offset = 0; offset < buffer->size; )
+	{
+#ifdef GRAPHTE_SOFTWARE
+		size_t end = offset;
+		uint32_t count = 0;
+		while(tiled && end < buffer->size && gtTileable((gtCommand*)(buffer->bytes + end)))
+		{
+			end += ((gtCommand*)(buffer->bytes + end))->size;
+			count++;
+		}
+		if(count > 1 && gtDrawTiles(buffer->bytes + offset, count))
+		{
+			offset = end;
+			continue;
+		}
+#endif
 
-	SetTextColor(host.bufferDC, RGB(fillColor.red, fillColor.green, fillColor.blue));
-	DrawText(host.bufferDC, text, strlen(text), &textBox, DT_LEFT);
+		gtCommand* command = (gtCommand*)(buffer->bytes + offset);
+		void* arguments = command + 1;
+		offset += command->size;
+
+		if(!gtCommands.recording && (command->right <= 0 || command->bottom <= 0 || command->left >= host.width || command->top >= host.height))
+			continue;
+
+		gtBlend.mode = (blendMode)command->mode;
+		gtBlend.opacity = command->opacity;
+		gtStroke.antialias = command->antialias;
+
+		switch(command->type)
+		{
+			case COMMAND_RECT:
+			case COMMAND_ELLIPSE:
+			{
+				gtRectCommand* shape = (gtRectCommand*)arguments;
+				if(command->type == COMMAND_RECT)
+					rect(shape->x, shape->y, shape->width, shape->height, shape->fillColor);
+				else
+					ellipse(shape->x, shape->y, shape->width, shape->height, shape->fillColor);
+				break;
+			}
+			case COMMAND_LINE:
+			{
+				gtLineCommand* segment = (gtLineCommand*)arguments;
+				line(segment->x1, segment->y1, segment->x2, segment->y2, segment->width, segment->fillColor);
+				break;
+			}
+			case COMMAND_POLYLINE:
+			{
+				gtPolylineCommand* path = (gtPolylineCommand*)arguments;
+				polyline((vector2f*)(path + 1), path->count, path->width, path->fillColor);
+				break;
+			}
+			case COMMAND_TRIANGLE:
+			case COMMAND_SHADED_TRIANGLE:
+			{
+				gtTriangleCommand* shape = (gtTriangleCommand*)arguments;
+				vertex* corners = shape->corners;
+				if(command->type == COMMAND_TRIANGLE)
+					triangle((vector2f){corners[0].x, corners[0].y}, (vector2f){corners[1].x, corners[1].y}, (vector2f){corners[2].x, corners[2].y}, corners[0].fillColor);
+				else
+					shadedTriangle(corners[0], corners[1], corners[2]);
+				break;
+			}
+			case COMMAND_TEXTURE:
+			{
+				gtTextureCommand* picture = (gtTextureCommand*)arguments;
+				if(picture->transparent)
+					drawTransparentTexture(picture->x, picture->y, picture->handle, picture->transparentColor);
+				else
+					drawTexture(picture->x, picture->y, picture->handle);
+				break;
+			}
+			case COMMAND_IMAGE:
+			{
+				gtImageCommand* picture = (gtImageCommand*)arguments;
+				if(picture->transparent)
+					transparentImage(picture->x, picture->y, picture->width, picture->height, (char*)(picture + 1), picture->transparentColor);
+				else
+					image(picture->x, picture->y, picture->width, picture->height, (char*)(picture + 1));
+				break;
+			}
+			case COMMAND_SPRITES:
+			{
+				gtSpritesCommand* batch = (gtSpritesCommand*)arguments;
+				drawSprites(batch->atlas, (spriteDraw*)(batch + 1), batch->count);
+				break;
+			}
+			case COMMAND_TEXT:
+			{
+				gtTextCommand* label = (gtTextCommand*)arguments;
+				gtTexts.size = label->size;
+				if(label->clip)
+					textRect(label->x, label->y, label->width, label->height, (char*)(label + 1), label->fillColor);
+				else
+					text(label->x, label->y, (char*)(label + 1), label->fillColor);
+				break;
+			}
+		}
+	}
+
+	gtBlend.mode = mode;
+	gtBlend.opacity = opacity;
+	gtStroke.antialias = antialias;
+	gtTexts.size = textSize;
+	GRAPHTE_PROFILE_END();
 }
 
 ////////////////////////////////////////////////////////////
 /**
- * \brief   A function draws text at a specified point on the screen.
+ * \brief   A function that reorders the commands of a command buffer to group the ones drawn with the same state.
  * 
- * \details This function draws formatted text at the specified coordinates of the screen. It formats the text according to the specified
- *          method (expanding tabs, justifying charecters, breaking lines, and so forth).
+ * \details Commands drawn with the same color, image or atlas (and the same blend state) are moved next to each other, which saves
+ *          switching the GDI brushes and bitmaps between them. A command is only moved past commands it does not overlap, so the result
+ *          looks the same as drawing the commands in their recorded order.
  * 
- * \note   This function accepts coordinates outside of the window area.
- *
- * \param[in]   x          Specifies the x-coordinate, in logical units, of the point at which the first character will appear.
- * \param[in]   y          Specifies the y-coordinate, in logical units, of the point at which the first character will appear.
- * \param[in]   textPTR    A reference to a constant char* containing the desired text to draw.
- * \param[in]   fillColor  The color that will be used to paint the text. To create a graphTe color value, use the rgb() function.
+ * \note    Sorting takes time proportional to the square of the number of commands. It is meant to be done once, after recording static content.
+ * 
+ * \param[in]   handle  The handle returned by createCommandBuffer().
  * 
  * \return  This function does not return anything.
  */
 ////////////////////////////////////////////////////////////
-void text(int16 x, int16 y, char* textPTR, color fillColor)
+void sortCommands(commandBuffer handle)
 {
-	char text[_CMAX];
-	strcpy(text, textPTR);
+	gtCommandBuffer* buffer = gtGetCommandBuffer(handle);
+	if(!buffer || buffer == gtCommands.recording || buffer->count < 2)
+		return;
+
+	uint32_t count = buffer->count;
+	gtCommand** commands = (gtCommand**)malloc(count * sizeof(gtCommand*));
+	uint32_t* waiting = (uint32_t*)calloc(count, sizeof(uint32_t)); //! The number of earlier overlapping commands not placed yet.
+	char* bytes = (char*)malloc(buffer->capacity);
+	if(!commands || !waiting || !bytes)
+	{
+		free(commands);
+		free(waiting);
+		free(bytes);
+		return;
+	}
+
+	size_t offset = 0, size = 0;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		commands[i] = (gtCommand*)(buffer->bytes + offset);
+		offset += commands[i]->size;
+	}
+	for(uint32_t i = 0; i < count; i++)
+		for(uint32_t j = i + 1; j < count; j++)
+			if(gtCommandsOverlap(commands[i], commands[j]))
+				waiting[j]++;
+
+	uint64_t key = 0;
+	for(uint32_t step = 0; step < count; step++)
+	{
+		uint32_t next = count;
 
-	RECT textBox;
-	textBox.left = x;
-	textBox.top = y;
-	textBox.right = x + 10;
-	textBox.bottom = y + 10;
+		//! A command is ready once every earlier command it overlaps is placed. The first ready command with the key of the last placed one
+		//! is taken, otherwise the first ready one.
+		for(uint32_t i = 0; i < count; i++)
+		{
+			if(!commands[i] || waiting[i])
+				continue;
+			if(next == count)
+				next = i;
+			if(step && commands[i]->key == key)
+			{
+				next = i;
+				break;
+			}
+		}
 
-	SetTextColor(host.bufferDC, RGB(fillColor.red, fillColor.green, fillColor.blue));
-	DrawText(host.bufferDC, text, strlen(text), &textBox, DT_NOCLIP);
+		gtCommand* command = commands[next];
+		memcpy(bytes + size, command, command->size);
+		size += command->size;
+		key = command->key;
+		commands[next] = NULL;
+
+		for(uint32_t i = next + 1; i < count; i++)
+			if(commands[i] && gtCommandsOverlap(command, commands[i]))
+				waiting[i]--;
+	}
+
+	free(buffer->bytes);
+	buffer->bytes = bytes;
+	free(commands);
+	free(waiting);
 }
 
 ////////////////////////////////////////////////////////////
@@ -635,7 +9627,13 @@ uint16 getVGAColor(vgaColor fillColor, vgaColor bgColor)
 ////////////////////////////////////////////////////////////
 void setPrintColor(vgaColor fillColor, vgaColor bgColor)
 {
+#ifdef _WIN32
 	SetConsoleTextAttribute(host.outputHandle, getVGAColor(fillColor, bgColor));
+#else
+	//! The VGA numbering swaps the red and blue bits of the ANSI numbering and keeps the intensity in bit 3.
+	static const unsigned char ansi[8] = {0, 4, 2, 6, 1, 5, 3, 7};
+	printf("\x1b[%d;%dm", (fillColor & 8 ? 90 : 30) + ansi[fillColor & 7], (bgColor & 8 ? 100 : 40) + ansi[bgColor & 7]);
+#endif
 }
 
 ////////////////////////////////////////////////////////////
@@ -651,7 +9649,15 @@ void setPrintColor(vgaColor fillColor, vgaColor bgColor)
 ////////////////////////////////////////////////////////////
 void setWindowTitle(char* title)
 {
+#ifdef GRAPHTE_BACKEND_GDI
 	SetConsoleTitle(title);
+#else
+	strncpy(host.title, title, _CMAX - 1);
+	#ifdef GRAPHTE_BACKEND_TERMINAL
+	char sequence[_CMAX + 8];
+	gtTerminalWrite(sequence, snprintf(sequence, sizeof(sequence), "\x1b]0;%s\x07", host.title));
+	#endif
+#endif
 }
 
 ////////////////////////////////////////////////////////////
@@ -667,7 +9673,9 @@ void setWindowTitle(char* title)
 ////////////////////////////////////////////////////////////
 char* getWindowTitle()
 {	
+#ifdef GRAPHTE_BACKEND_GDI
 	GetWindowTextA(host.hwnd, host.title, _CMAX);
+#endif
 	return host.title;
 }
 
@@ -678,6 +9686,7 @@ char* getWindowTitle()
  * \details This function resizes the conHost window to the specified widht/height.
  * 
  * \note    The provided window size must be bigger than 120/120 pixels and smaller than 4000/4000 pixels.
+ *          The canvas is resized right away, without requiring an update() call, and keeps its content where the old and new sizes overlap.
  * 
  * \param[in]  width   The width, in logical units, that the new window will have.
  * \param[in]  height  The height, in logical units, that the new window will have.
@@ -687,17 +9696,24 @@ char* getWindowTitle()
 ////////////////////////////////////////////////////////////
 void setWindowSize(uint16 width, uint16 height)
 {
+#ifdef GRAPHTE_BACKEND_GDI
 	updateWindowBounds();
 	MoveWindow(host.hwnd, host.rect.left, host.rect.top, width, height, TRUE);
 
-	Sleep(100);
+	//! The window rectangle can lag behind MoveWindow(), the canvas takes the requested size instead of waiting for it.
+	host.resizePending = FALSE;
+	if(gtResizeBuffers(width, height))
+		disableConsoleCursor();
+#else
+	gtResizeBuffers(width, height);
+#endif
 }
 
 ////////////////////////////////////////////////////////////
 /**
  * \brief   A function that retrieves the size of the current window.
  * 
- * \details This function retrieves the size of the current conHost window, while also updating the memory window bounds.
+ * \details This function retrieves the size of the canvas, which follows the size of the current conHost window, while also updating the memory window bounds.
  * 
  * \param   This function does not have any parameters.
  * 
@@ -710,6 +9726,28 @@ vector2u getWindowSize()
 	return (vector2u){host.width, host.height};
 }
 
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that sets the function called when the canvas is resized.
+ * 
+ * \details The callback receives the new width and height of the canvas, and is called after setWindowSize() and update() change the size,
+ *          or from display() once a window resized by the user has kept its new size for GRAPHTE_RESIZE_DEBOUNCE milliseconds.
+ *          The canvas is ready to be drawn on when the callback runs, so it is the place to redraw content that does not change every frame.
+ * 
+ * \note    On the terminal backend the canvas size is chosen by the program, it scales to whatever size the terminal has. The callback is also called
+ *          when the terminal is resized, with the canvas size that shows one pixel per half cell of the new terminal, which can be passed on to
+ *          setWindowSize() to keep the picture sharp.
+ * 
+ * \param[in]  callback  The function to be called, or NULL to remove the current one.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void setResizeCallback(void (*callback)(uint16 width, uint16 height))
+{
+	host.resizeCallback = callback;
+}
+
 ////////////////////////////////////////////////////////////
 /**
  * \brief   A function that modifes the position of the window.
@@ -724,8 +9762,13 @@ vector2u getWindowSize()
 ////////////////////////////////////////////////////////////
 void setWindowPosition(uint16 x, uint16 y)
 {
+#ifdef GRAPHTE_BACKEND_GDI
 	updateWindowBounds();
-	MoveWindow(host.hwnd, x, y, host.width, host.height, TRUE);
+	MoveWindow(host.hwnd, x, y, host.rect.right - host.rect.left, host.rect.bottom - host.rect.top, TRUE);
+#else
+	host.x = x;
+	host.y = y;
+#endif
 }
 
 ////////////////////////////////////////////////////////////
@@ -742,7 +9785,63 @@ void setWindowPosition(uint16 x, uint16 y)
 vector2u getWindowPosition()
 {
 	updateWindowBounds();
+#ifdef GRAPHTE_BACKEND_GDI
 	return (vector2u){host.rect.left, host.rect.top};
+#else
+	return (vector2u){(uint16)host.x, (uint16)host.y};
+#endif
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that takes the next input event.
+ * 
+ * \details Key presses and releases, mouse moves, clicks and wheel steps are read by a background thread as soon as they happen and kept
+ *          in order, each with the time it was read at. This function is typically called in a loop once per frame, until it returns FALSE,
+ *          so no input is lost between two frames no matter how long a frame takes. Resizes of the canvas are reported as EVENT_RESIZE.
+ * 
+ * \note    The input() , checkKeyLiveInput() and getMousePosition() functions read the state built from the same events, so they can be
+ *          mixed with this function.
+ *          The framebuffer backend is headless: it only receives the events given to pushEvent() and its own resizes.
+ *          At most GRAPHTE_EVENT_QUEUE_SIZE events are kept, the oldest ones are dropped when they are not taken in time.
+ * 
+ * \param[out]   item  The event taken, left unchanged if there is none.
+ * 
+ * \return       Returns TRUE if an event was taken and FALSE if no event is waiting.
+ */
+////////////////////////////////////////////////////////////
+BOOL pollEvent(event* item)
+{
+	gtFetchEvents();
+	if(gtEvents.pending.head == gtEvents.pending.tail)
+		return FALSE;
+
+	*item = gtEvents.pending.events[gtEvents.pending.head & (GRAPHTE_EVENT_QUEUE_SIZE - 1)];
+	gtEvents.pending.head++;
+	return TRUE;
+}
+
+////////////////////////////////////////////////////////////
+/**
+ * \brief   A function that adds an input event as if it had been read from the system.
+ * 
+ * \details The event is queued after every event read so far, and it updates the state read by input(), checkKeyLiveInput() and getMousePosition().
+ *          This is how a headless program (or a replay of recorded input) drives code written against pollEvent().
+ * 
+ * \note    Mouse positions are given in canvas pixels on every backend.
+ * 
+ * \param[in]    item  The event to be added. A time of 0 is replaced by the current time.
+ * 
+ * \return  This function does not return anything.
+ */
+////////////////////////////////////////////////////////////
+void pushEvent(event item)
+{
+	if(!item.time)
+		item.time = gtMilliseconds();
+
+	gtFetchEvents();
+	gtAcceptEvent(item);
 }
 
 ////////////////////////////////////////////////////////////
@@ -752,6 +9851,8 @@ vector2u getWindowPosition()
  * \details This function retrieves the pressed key at the function call frame.
  * 
  * \note    This function should not be used without a certain reason as event type input can be unexpected when using a frame based system.
+ *          The characters come from the EVENT_KEY_DOWN events, see pollEvent(). The framebuffer backend is headless and only returns the
+ *          characters given to pushEvent(). The terminal backend returns the characters typed in the terminal, escape sequences excluded.
  * 
  * \param   This function does not have any parameters.
  * 
@@ -760,10 +9861,13 @@ vector2u getWindowPosition()
 ////////////////////////////////////////////////////////////
 char input()
 {
-	if(kbhit())
-		return getch();
-	else 
+	gtFetchEvents();
+	if(gtEvents.characterHead == gtEvents.characterTail)
 		return 0;
+
+	char key = gtEvents.characters[gtEvents.characterHead];
+	gtEvents.characterHead = (gtEvents.characterHead + 1) % sizeof(gtEvents.characters);
+	return key;
 }
 
 ////////////////////////////////////////////////////////////
@@ -774,6 +9878,7 @@ char input()
  * 
  * \note    This function should not be used without a certain reason as event type input can be unexpected when using a frame based system.
  *          In some circumstances this function will not block the program execution.
+ *          The framebuffer backend is headless, so this function returns 0 without blocking unless a character was given to pushEvent().
  * 
  * \param   This function does not have any parameters.
  * 
@@ -782,7 +9887,17 @@ char input()
 ////////////////////////////////////////////////////////////
 char forceInput()
 {
-	return getch();
+#if defined(GRAPHTE_BACKEND_GDI) || defined(GRAPHTE_BACKEND_TERMINAL)
+	char key;
+
+	//! The characters are read by the input reader thread, the queue is checked every millisecond.
+	while(!(key = input()))
+		Sleep(1);
+
+	return key;
+#else
+	return input();
+#endif
 }
 
 ////////////////////////////////////////////////////////////
@@ -794,7 +9909,11 @@ char forceInput()
  * \note    This function takes a WORD paremater for the key structure making it compatible with winAPI virtual key codes.
  *          These codes can be found here:  https://docs.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes .
  * 			A hex value can be passed as a paremter instead in case of unspecified keys.
- *          If this function is used for mouse input , the quick-edit mode of conHost must be disabled.
+ *          The state is built from the input events, see pollEvent(): a key pressed and released between two calls is still reported once.
+ *          Mouse buttons are only seen over the console window, initHost() disables the quick-edit mode of conHost for them.
+ *          The framebuffer backend is headless and only sees the keys given to pushEvent().
+ *          Terminals only report key presses: the terminal backend reports every press once, then keeps reporting the key as pressed while its
+ *          auto-repeat arrives faster than GRAPHTE_KEY_REPEAT milliseconds. Mouse buttons are reported until they are released.
  * 
  * \param[in]  keyCode  The WORD representing the code for the virtual key which state is referenced.
  * 
@@ -803,7 +9922,24 @@ char forceInput()
 ////////////////////////////////////////////////////////////
 BOOL checkKeyLiveInput(WORD keyCode)
 {
-	return GetAsyncKeyState(keyCode);
+	if(keyCode > 0xFF)
+		return FALSE;
+
+	gtFetchEvents();
+	if(gtEvents.keyPending[keyCode])
+	{
+		gtEvents.keyPending[keyCode] = FALSE;
+		return TRUE;
+	}
+	if(gtEvents.keyDown[keyCode])
+		return TRUE;
+
+#ifdef GRAPHTE_BACKEND_TERMINAL
+	//! Terminals only report presses, a key counts as held while its auto-repeat keeps arriving.
+	return gtMilliseconds() - gtEvents.keyTime[keyCode] < GRAPHTE_KEY_REPEAT && gtEvents.keyTime[keyCode] - gtEvents.keyPrevious[keyCode] < GRAPHTE_KEY_REPEAT;
+#else
+	return FALSE;
+#endif
 }
 
 ////////////////////////////////////////////////////////////
@@ -813,6 +9949,8 @@ BOOL checkKeyLiveInput(WORD keyCode)
  * \details This function retrieves the position of teh mouse cursorm, in screen coordinates. The coordinates are re-maped in reference
  *          to the window size and position.
  * 
+ * \note    The position is the one of the last mouse event, see pollEvent(). On the terminal backend it is -1 while the mouse is outside of the picture.
+ * 
  * \param   This function does not havy any parameters.
  * 
  * \return  This function returns a structure containing the coordinates of the mouse position.
@@ -820,11 +9958,8 @@ BOOL checkKeyLiveInput(WORD keyCode)
 ////////////////////////////////////////////////////////////
 POINT getMousePosition()
 {
-	POINT mPos;
-	GetCursorPos(&mPos);
-	ScreenToClient(GetForegroundWindow(), &mPos);
-
-	return mPos;
+	gtFetchEvents();
+	return gtEvents.mouse;
 }
 
 ////////////////////////////////////////////////////////////
@@ -836,6 +9971,7 @@ POINT getMousePosition()
  * 
  * \note    The specified path must be smaller than 256 characters.
  *          The recomended format for the sound file is ".wav".
+ *          Sound is only available on Windows, on other platforms this function does nothing.
  * 
  * \param[in]  filenamePTR  A reference to a constant char* with the path to the file to be played.
  * 
@@ -844,10 +9980,12 @@ POINT getMousePosition()
 ////////////////////////////////////////////////////////////
 void playSound(char* filenamePTR)
 {
+#ifdef _WIN32
 	char filename[_CMAX];
 	strcpy(filename, filenamePTR);
 
 	PlaySoundA(filename, NULL, SND_FILENAME | SND_ASYNC);
+#endif
 }
 
 #endif //end graphTe.h
@@ -871,4 +10009,49 @@ void playSound(char* filenamePTR)
  *     source directory and linking the required modules with your compiler: gdi32, msimg32, winmm
  * 
  *     Example of a compile command: gcc *.c -lgdi32 -lmsimg32 -lwinmm
- */
\ No newline at end of file
+ * 
+ * \section fourth_sec Headless framebuffer backend
+ * 
+ *     Defining GRAPHTE_BACKEND_FRAMEBUFFER before including graphTe.h (the default on platforms other than Windows)
+ *     keeps the same functions but draws into a CPU-owned 32-bit pixel array instead of the console window.
+ *     display() becomes a buffer swap and saveFrame() dumps the displayed frame as a PPM or raw file, which makes
+ *     the primitives deterministic and measurable without a GPU or a window.
+ * 
+ *     Example of a compile command: gcc *.c -lm -pthread
+ * 
+ * \section fifth_sec Terminal backend
+ * 
+ *     Defining GRAPHTE_BACKEND_TERMINAL renders the same pixel array on any POSIX terminal with 24-bit color support.
+ *     Every character cell shows two pixels with an upper half block, the buffer is scaled to fit the terminal, and
+ *     display() only rewrites the cells that changed since the previous frame, which keeps it usable over SSH.
+ * 
+ *     Keys and mouse reports (xterm any-motion tracking with the SGR encoding) are read by a background thread and
+ *     returned in order by pollEvent().
+ * 
+ *     Example of a compile command: gcc -DGRAPHTE_BACKEND_TERMINAL *.c -lm -pthread
+ * 
+ * \section sixth_sec Profiling
+ * 
+ *     Defining GRAPHTE_PROFILE measures every drawing call and display() on any backend: the calls, the time and the
+ *     damaged pixels of each kind of call are counted per frame. getProfileFrame() returns the counters of the last
+ *     frames, drawProfileOverlay() draws them over the canvas and saveProfileTrace() writes the calls as a Chrome trace.
+ *     Without the define the measures are compiled out.
+ * 
+ *     Example of a compile command: gcc -DGRAPHTE_PROFILE *.c -lm -pthread
+ * 
+ * \section seventh_sec Capturing frames
+ * 
+ *     On the software backends startCapture() records every displayed frame to a file or to the standard input of a command,
+ *     as a Y4M video or as raw 32-bit rows. A background thread converts and writes each frame straight from the front buffer
+ *     while the next one is drawn, and stopCapture() closes the stream.
+ * 
+ *     Example of a capture: startCapture("|ffmpeg -i - session.mp4", CAPTURE_Y4M, 60);
+ * 
+ * \section eighth_sec Asset archives
+ * 
+ *     tools/pack packs the files of a directory into a single archive, with a hashed index of their names and the bitmaps
+ *     stored decoded, optionally compressed with LZ4. Once mountArchive() has mapped the archive, image(), loadTexture() and
+ *     loadSpriteAtlas() find their files in it without opening them, and readArchiveFile() returns any other packed file.
+ * 
+ *     Example of a mount: mountArchive("assets.gtp"); image(0, 0, 0, 0, "pieces/atlas.bmp");
+ */
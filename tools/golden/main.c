@@ -0,0 +1,429 @@
+//Checks that graphTe draws the same images whatever the pixel row kernels and the number of threads, on the framebuffer backend.
+//Build: gcc -O2 -I../.. main.c -lm -pthread
+//Run it from this directory, the image scene loads the assets of the examples.
+//Every scene is drawn with the scalar kernels on a single thread, which is the reference, then with every instruction set the
+//processor supports, on 1 and on 4 threads, and compared with the reference:
+//	./a.out
+//The reference images can also be stored, to check later builds (or other machines) against them:
+//	./a.out record references
+//	./a.out check references
+//The comparison is exact by default. -t N accepts pixels whose channels differ by at most N, -p D accepts pixels whose perceptual
+//(redmean) distance is at most D, both go before the command. For every failed comparison the expected and actual images are written
+//as PPM files into the current directory, with a diff image where the differing pixels are red over a dimmed copy of the reference.
+
+#define GRAPHTE_BACKEND_FRAMEBUFFER
+#include "graphTe.h"
+
+const uint16 width = 320, height = 240;
+
+char* imagePath = "../../examples/tetris/assets/controls.bmp";
+
+typedef struct
+{
+	char* name;
+	void (*draw)();
+}
+scene;
+
+typedef struct
+{
+	char name[16];
+	kernelLevel level;
+	uint16 threads;
+}
+configuration;
+
+const char* levelNames[4] = {"scalar", "sse2", "avx2", "avx512"};
+
+//the largest accepted difference of a channel, and of the perceptual distance, -1 when not used
+int channelTolerance = 0;
+double perceptualTolerance = -1;
+
+uint32_t seed;
+
+//a pseudo-random number in [0, range), every scene starts from the same seed
+int randomInt(int range)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (int)((seed >> 8) % (uint32_t)range);
+}
+
+color randomColor(uint16 alpha)
+{
+	return rgba(randomInt(256), randomInt(256), randomInt(256), alpha);
+}
+
+////////////////////////////////////////////////////////////
+// Scenes
+////////////////////////////////////////////////////////////
+
+//opaque rectangles and ellipses, some of them crossing the edges of the canvas
+void drawShapes()
+{
+	fill(rgb(20, 24, 32));
+	for(int i = 0; i < 60; i++)
+	{
+		int16 x = randomInt(width + 60) - 30, y = randomInt(height + 60) - 30;
+		if(i % 3)
+			rect(x, y, randomInt(80), randomInt(80), randomColor(255));
+		else
+			ellipse(x, y, randomInt(80), randomInt(80), randomColor(255));
+	}
+	circle(-20, -20, 50, rgb(255, 255, 255));
+	circle(width - 30, height - 30, 50, rgb(255, 0, 0));
+}
+
+//translucent shapes in every blend mode, with and without opacity
+void drawBlending()
+{
+	fill(rgb(90, 90, 90));
+	for(int mode = BLEND_ALPHA; mode <= BLEND_MULTIPLY; mode++)
+	{
+		setBlendMode((blendMode)mode);
+		for(int i = 0; i < 20; i++)
+		{
+			setOpacity(i % 2 ? 255 : 140);
+			int16 x = randomInt(width), y = randomInt(height);
+			if(i % 4)
+				rect(x - 40, y - 30, randomInt(90), randomInt(70), randomColor(randomInt(256)));
+			else
+				ellipse(x - 40, y - 30, randomInt(90), randomInt(70), randomColor(randomInt(256)));
+		}
+	}
+	setBlendMode(BLEND_ALPHA);
+	setOpacity(255);
+}
+
+//lines of every width in every direction, then antialiased paths
+void drawLines()
+{
+	fill(rgb(0, 0, 0));
+	for(int i = 0; i < 48; i++)
+	{
+		float angle = i * 3.14159265f / 24;
+		line(width / 2, height / 2, width / 2 + (int16)(150 * cosf(angle)), height / 2 + (int16)(150 * sinf(angle)), 1 + i % 5, randomColor(i % 2 ? 255 : 160));
+	}
+
+	setAntialiasing(TRUE);
+	for(int i = 0; i < 12; i++)
+	{
+		vector2f points[8] = {{(float)randomInt(width), (float)randomInt(height)}};
+		for(int j = 1; j < 8; j++)
+			points[j] = (vector2f){points[j - 1].x + randomInt(61) - 30 + 0.25f, points[j - 1].y + randomInt(61) - 30 + 0.5f};
+		polyline(points, 8, 0.5f + i % 4, randomColor(i % 3 ? 255 : 120));
+	}
+	setAntialiasing(FALSE);
+}
+
+//flat and shaded triangles, crossing each other through the depth buffer
+void drawTriangles()
+{
+	fill(rgb(30, 30, 60));
+	clearDepth();
+	for(int i = 0; i < 40; i++)
+	{
+		float x = randomInt(width), y = randomInt(height), z = randomInt(1000) / 1000.0f;
+		vertex a = {x, y, z, randomColor(255)};
+		vertex b = {x + randomInt(121) - 60, y + randomInt(121) - 60, 1 - z, randomColor(255)};
+		vertex c = {x + randomInt(121) - 60, y + randomInt(121) - 60, z, randomColor(255)};
+		if(i % 2)
+			shadedTriangle(a, b, c);
+		else
+			triangle((vector2f){a.x, a.y}, (vector2f){b.x, b.y}, (vector2f){c.x, c.y}, randomColor(i % 3 ? 255 : 100));
+	}
+}
+
+//scaled images, with a transparent color and with opacity
+void drawImages()
+{
+	fill(rgb(200, 40, 40));
+	image(-20, -10, 200, 150, imagePath);
+	transparentImage(140, 60, 160, 170, imagePath, rgb(0, 0, 0));
+	setOpacity(128);
+	image(60, 120, 240, 100, imagePath);
+	setOpacity(255);
+}
+
+void drawText()
+{
+	fill(rgb(250, 250, 240));
+	for(int i = 0; i < 5; i++)
+	{
+		setTextSize(8 + i * 6);
+		text(4, 4 + i * 44, "graphTe 0123456789", randomColor(i % 2 ? 255 : 150));
+	}
+	setTextSize(0);
+	textRect(200, 10, 100, 40, "clipped to a rectangle", rgb(0, 0, 200));
+}
+
+//a recorded scene replayed by drawCommands(), which draws it through the screen tiles when threads are available
+void drawCommandBuffer()
+{
+	commandBuffer commands = createCommandBuffer();
+	beginCommands(commands);
+	fill(rgb(10, 10, 10));
+	for(int i = 0; i < 300; i++)
+	{
+		int16 x = randomInt(width), y = randomInt(height);
+		setBlendMode(i % 7 ? BLEND_ALPHA : BLEND_ADD);
+		switch(i % 4)
+		{
+			case 0: rect(x - 20, y - 20, randomInt(60), randomInt(60), randomColor(i % 2 ? 255 : 128)); break;
+			case 1: ellipse(x - 20, y - 20, randomInt(60), randomInt(60), randomColor(200)); break;
+			case 2: line(x, y, x + randomInt(81) - 40, y + randomInt(81) - 40, 1 + i % 3, randomColor(255)); break;
+			case 3: shadedTriangle((vertex){x, y, 0, randomColor(255)}, (vertex){x + randomInt(61) - 30, y + randomInt(61) - 30, 0, randomColor(255)}, (vertex){x + randomInt(61) - 30, y + randomInt(61) - 30, 0, randomColor(255)}); break;
+		}
+	}
+	setBlendMode(BLEND_ALPHA);
+	endCommands();
+
+	drawCommands(commands);
+	freeCommandBuffer(commands);
+}
+
+color gradient(uint16 x, uint16 y, void* userData)
+{
+	return rgb(x * 255 / width, y * 255 / height, (x ^ y) & 0xFF);
+}
+
+void drawShade()
+{
+	shade(-10, 5, width, height, gradient, NULL);
+}
+
+scene scenes[] =
+{
+	{"shapes", drawShapes},
+	{"blending", drawBlending},
+	{"lines", drawLines},
+	{"triangles", drawTriangles},
+	{"images", drawImages},
+	{"text", drawText},
+	{"commands", drawCommandBuffer},
+	{"shade", drawShade}
+};
+const int sceneCount = sizeof(scenes) / sizeof(scenes[0]);
+
+////////////////////////////////////////////////////////////
+// Images
+////////////////////////////////////////////////////////////
+
+//draws a scene with the kernels and threads of a configuration into a new width x height image
+uint32_t* render(scene* item, configuration* setup)
+{
+	gtUseKernels(setup->level);
+	setThreadCount(setup->threads);
+	seed = 12345;
+
+	//nothing of the previous scene may show through, neither in the pixels nor in the depth buffer
+	fill(rgb(0, 0, 0));
+	clearDepth();
+	item->draw();
+
+	uint32_t* pixels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+	for(int y = 0; y < height; y++)
+		memcpy(pixels + (size_t)y * width, host.pixels + (size_t)y * host.stride, width * sizeof(uint32_t));
+	display();
+
+	return pixels;
+}
+
+BOOL writeImage(const char* path, const uint32_t* pixels)
+{
+	FILE* file = fopen(path, "wb");
+	if(!file)
+		return FALSE;
+
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	for(size_t i = 0; i < (size_t)width * height; i++)
+	{
+		unsigned char rgb[3] = {pixels[i] >> 16 & 0xFF, pixels[i] >> 8 & 0xFF, pixels[i] & 0xFF};
+		fwrite(rgb, 1, 3, file);
+	}
+
+	return fclose(file) == 0;
+}
+
+//reads a PPM written by writeImage(), NULL when the file is missing or has another size
+uint32_t* readImage(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if(!file)
+		return NULL;
+
+	int fileWidth, fileHeight, maximum;
+	uint32_t* pixels = NULL;
+	if(fscanf(file, "P6 %d %d %d", &fileWidth, &fileHeight, &maximum) == 3 && fileWidth == width && fileHeight == height && maximum == 255 && fgetc(file) != EOF)
+	{
+		pixels = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+		for(size_t i = 0; i < (size_t)width * height; i++)
+		{
+			unsigned char rgb[3] = {0, 0, 0};
+			if(fread(rgb, 1, 3, file) != 3)
+			{
+				free(pixels);
+				pixels = NULL;
+				break;
+			}
+			pixels[i] = (uint32_t)rgb[0] << 16 | rgb[1] << 8 | rgb[2];
+		}
+	}
+
+	fclose(file);
+	return pixels;
+}
+
+//TRUE when two pixels are equal within the selected tolerance
+BOOL samePixel(uint32_t expected, uint32_t actual)
+{
+	int red = (int)(expected >> 16 & 0xFF) - (int)(actual >> 16 & 0xFF);
+	int green = (int)(expected >> 8 & 0xFF) - (int)(actual >> 8 & 0xFF);
+	int blue = (int)(expected & 0xFF) - (int)(actual & 0xFF);
+
+	if(perceptualTolerance >= 0)
+	{
+		//the "redmean" weighting, which follows the sensitivity of the eye to each channel better than a plain distance
+		double mean = ((expected >> 16 & 0xFF) + (actual >> 16 & 0xFF)) / 2.0;
+		double distance = sqrt((2 + mean / 256) * red * red + 4 * green * green + (2 + (255 - mean) / 256) * blue * blue);
+		return distance <= perceptualTolerance;
+	}
+
+	return abs(red) <= channelTolerance && abs(green) <= channelTolerance && abs(blue) <= channelTolerance;
+}
+
+//compares an image with its reference, writes the images and their diff when they differ, returns the number of differing pixels
+long compareImages(const char* name, const uint32_t* expected, const uint32_t* actual)
+{
+	uint32_t* diff = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+	long differing = 0;
+
+	for(size_t i = 0; i < (size_t)width * height; i++)
+	{
+		if(samePixel(expected[i], actual[i]))
+		{
+			uint32_t gray = ((expected[i] >> 16 & 0xFF) + (expected[i] >> 8 & 0xFF) + (expected[i] & 0xFF)) / 12;
+			diff[i] = gray << 16 | gray << 8 | gray;
+		}
+		else
+		{
+			diff[i] = 0xFF0000;
+			differing++;
+		}
+	}
+
+	if(differing)
+	{
+		char path[128];
+		snprintf(path, sizeof(path), "%s.expected.ppm", name);
+		writeImage(path, expected);
+		snprintf(path, sizeof(path), "%s.actual.ppm", name);
+		writeImage(path, actual);
+		snprintf(path, sizeof(path), "%s.diff.ppm", name);
+		writeImage(path, diff);
+	}
+
+	free(diff);
+	return differing;
+}
+
+int main(int argc, char** argv)
+{
+	int argument = 1;
+	for(; argument + 1 < argc && argv[argument][0] == '-'; argument += 2)
+	{
+		if(!strcmp(argv[argument], "-t"))
+			channelTolerance = atoi(argv[argument + 1]);
+		else if(!strcmp(argv[argument], "-p"))
+			perceptualTolerance = atof(argv[argument + 1]);
+	}
+
+	char* command = argument < argc ? argv[argument] : "compare";
+	char* directory = argument + 1 < argc ? argv[argument + 1] : NULL;
+	if(strcmp(command, "compare") && (!directory || (strcmp(command, "record") && strcmp(command, "check"))))
+	{
+		fprintf(stderr, "usage: %s [-t channel tolerance] [-p perceptual tolerance] [compare | record <directory> | check <directory>]\n", argv[0]);
+		return 2;
+	}
+
+	initHost();
+	setWindowSize(width, height);
+	setDepthBuffer(DEPTH_16);
+
+	//the scalar kernels on a single thread first, then every supported instruction set on 1 and 4 threads
+	configuration setups[8];
+	int setupCount = 0;
+	for(int level = KERNELS_SCALAR; level <= KERNELS_AVX512; level++)
+	{
+		if(gtUseKernels((kernelLevel)level) != level)
+			break;
+		for(uint16 threads = 1; threads <= 4; threads += 3)
+		{
+			snprintf(setups[setupCount].name, sizeof(setups[setupCount].name), "%s-%u", levelNames[level], threads);
+			setups[setupCount].level = (kernelLevel)level;
+			setups[setupCount++].threads = threads;
+		}
+	}
+
+	FILE* asset = fopen(imagePath, "rb");
+	if(asset)
+		fclose(asset);
+	else
+		fprintf(stderr, "%s not found, the images scene is skipped\n", imagePath);
+
+	int failures = 0;
+	for(int i = 0; i < sceneCount; i++)
+	{
+		if(!asset && scenes[i].draw == drawImages)
+			continue;
+
+		char path[256];
+		snprintf(path, sizeof(path), "%s/%s.ppm", directory ? directory : ".", scenes[i].name);
+
+		uint32_t* reference = render(&scenes[i], &setups[0]);
+		if(!strcmp(command, "record"))
+		{
+			BOOL written = writeImage(path, reference);
+			printf("%-10s %s %s\n", scenes[i].name, written ? "recorded in" : "CANNOT WRITE", path);
+			failures += !written;
+			free(reference);
+			continue;
+		}
+
+		//the stored image is the reference of every configuration, the scalar single thread one included
+		int first = 1;
+		if(!strcmp(command, "check"))
+		{
+			uint32_t* stored = readImage(path);
+			if(!stored)
+			{
+				printf("%-10s MISSING %s\n", scenes[i].name, path);
+				failures++;
+				free(reference);
+				continue;
+			}
+			free(reference);
+			reference = stored;
+			first = 0;
+		}
+
+		for(int j = first; j < setupCount; j++)
+		{
+			char name[64];
+			snprintf(name, sizeof(name), "%s-%s", scenes[i].name, setups[j].name);
+
+			uint32_t* actual = render(&scenes[i], &setups[j]);
+			long differing = compareImages(name, reference, actual);
+			printf("%-10s %-10s %s", scenes[i].name, setups[j].name, differing ? "FAILED" : "ok");
+			if(differing)
+				printf(", %ld pixels differ, see %s.diff.ppm", differing, name);
+			printf("\n");
+
+			failures += differing != 0;
+			free(actual);
+		}
+		free(reference);
+	}
+
+	releaseHost();
+	return failures != 0;
+}
@@ -0,0 +1,328 @@
+//Packs the files of a directory into an asset archive, which graphTe maps with mountArchive().
+//Build: gcc -O2 -I../.. main.c -lm -pthread
+//Every file is stored under its path relative to the directory, with '/' separators, which is the path the program opens it with
+//when it runs from that directory. The bitmaps graphTe decodes are stored decoded, at the size of the file, so they are drawn straight
+//from the archive. Hidden files and archives (.gtp) are left out.
+//	./a.out assets.gtp ../../examples/Chess
+//-c compresses with LZ4 every file it makes smaller. Compressed images are decompressed once, when they are first drawn:
+//	./a.out -c assets.gtp ../../examples/tetris
+//-l lists the content of an archive, read through mountArchive():
+//	./a.out -l assets.gtp
+
+#define GRAPHTE_BACKEND_FRAMEBUFFER
+#include "graphTe.h"
+#include <ctype.h>
+#include <dirent.h>
+
+typedef struct
+{
+	char* name; //! The path relative to the packed directory.
+	unsigned char* payload;
+	gtArchiveEntry entry;
+}
+packedFile;
+
+packedFile* files = NULL;
+int fileCount = 0, fileCapacity = 0;
+
+//adds every file under root/prefix, prefix being empty or ending with '/'
+void collect(const char* root, const char* prefix)
+{
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s", root, prefix);
+	DIR* directory = opendir(path);
+	if(!directory)
+		return;
+
+	struct dirent* item;
+	while((item = readdir(directory)))
+	{
+		size_t length = strlen(item->d_name);
+		if(item->d_name[0] == '.' || (length > 4 && !strcmp(item->d_name + length - 4, ".gtp")))
+			continue;
+
+		char name[512];
+		struct stat info;
+		snprintf(name, sizeof(name), "%s%s", prefix, item->d_name);
+		snprintf(path, sizeof(path), "%s/%s", root, name);
+		if(stat(path, &info))
+			continue;
+
+		if(S_ISDIR(info.st_mode))
+		{
+			strncat(name, "/", sizeof(name) - strlen(name) - 1);
+			collect(root, name);
+		}
+		else if(S_ISREG(info.st_mode))
+		{
+			if(fileCount == fileCapacity)
+			{
+				fileCapacity = fileCapacity ? fileCapacity * 2 : 64;
+				files = (packedFile*)realloc(files, fileCapacity * sizeof(packedFile));
+			}
+			memset(&files[fileCount], 0, sizeof(packedFile));
+			files[fileCount++].name = strdup(name);
+		}
+	}
+
+	closedir(directory);
+}
+
+int compareNames(const void* a, const void* b)
+{
+	return strcmp(((const packedFile*)a)->name, ((const packedFile*)b)->name);
+}
+
+////////////////////////////////////////////////////////////
+// LZ4 compression
+////////////////////////////////////////////////////////////
+
+//writes the bytes extending a length of 15 or more
+size_t writeLength(unsigned char* destination, size_t written, size_t length)
+{
+	for(length -= 15; length >= 255; length -= 255)
+		destination[written++] = 255;
+	destination[written++] = (unsigned char)length;
+	return written;
+}
+
+//writes a sequence: the literals, then a match of length bytes at distance, or no match when length is 0
+size_t writeSequence(unsigned char* destination, size_t written, const unsigned char* literals, size_t literalCount, size_t distance, size_t length)
+{
+	size_t matchCode = length ? length - 4 : 0;
+	destination[written++] = (unsigned char)((literalCount < 15 ? literalCount : 15) << 4 | (matchCode < 15 ? matchCode : 15));
+	if(literalCount >= 15)
+		written = writeLength(destination, written, literalCount);
+	memcpy(destination + written, literals, literalCount);
+	written += literalCount;
+
+	if(!length)
+		return written;
+
+	destination[written++] = (unsigned char)(distance & 0xFF);
+	destination[written++] = (unsigned char)(distance >> 8);
+	if(matchCode >= 15)
+		written = writeLength(destination, written, matchCode);
+	return written;
+}
+
+//compresses into an LZ4 block with a greedy search over a hash table of 4-byte sequences, destination holds size + size / 255 + 16 bytes
+//the format requires the last match to start 12 bytes before the end at the latest and the last 5 bytes to be literals
+size_t compressLZ4(const unsigned char* source, size_t size, unsigned char* destination)
+{
+	static size_t table[1 << 16]; //the last position + 1 of every hashed sequence, 0 when none
+	size_t anchor = 0, position = 0, written = 0;
+	memset(table, 0, sizeof(table));
+
+	while(position + 12 <= size)
+	{
+		uint32_t sequence;
+		memcpy(&sequence, source + position, 4);
+		uint32_t slot = (sequence * 2654435761u) >> 16;
+		size_t candidate = table[slot];
+		table[slot] = position + 1;
+
+		if(!candidate || position + 1 - candidate > 65535 || memcmp(source + candidate - 1, source + position, 4))
+		{
+			position++;
+			continue;
+		}
+
+		candidate--;
+		size_t length = 4;
+		while(position + length + 5 < size && source[candidate + length] == source[position + length])
+			length++;
+
+		written = writeSequence(destination, written, source + anchor, position - anchor, position - candidate, length);
+		position += length;
+		anchor = position;
+	}
+
+	return writeSequence(destination, written, source + anchor, size - anchor, 0, 0);
+}
+
+////////////////////////////////////////////////////////////
+// Packing
+////////////////////////////////////////////////////////////
+
+BOOL endsWith(const char* text, const char* suffix)
+{
+	size_t length = strlen(text), suffixLength = strlen(suffix);
+	if(length < suffixLength)
+		return FALSE;
+	for(size_t i = 0; i < suffixLength; i++)
+		if(tolower((unsigned char)text[length - suffixLength + i]) != suffix[i])
+			return FALSE;
+	return TRUE;
+}
+
+//reads the file into the payload, decoded when it is a bitmap, then compresses it when asked to and when that makes it smaller
+BOOL loadFile(const char* root, packedFile* file, BOOL compress)
+{
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s", root, file->name);
+	gtArchiveEntry* entry = &file->entry;
+
+	uint16 width, height;
+	BOOL translucent;
+	gtMappedFile mapping;
+	uint32_t* pixels = endsWith(file->name, ".bmp") ? gtLoadBitmap(path, 0, 0, &width, &height, &translucent, &mapping) : NULL;
+	if(pixels)
+	{
+		entry->flags = GRAPHTE_ARCHIVE_PIXELS | (translucent ? GRAPHTE_ARCHIVE_TRANSLUCENT : 0);
+		entry->width = width;
+		entry->height = height;
+		entry->rawSize = (uint32_t)width * height * sizeof(uint32_t);
+		file->payload = (unsigned char*)malloc(entry->rawSize);
+		memcpy(file->payload, pixels, entry->rawSize);
+		if(mapping.data)
+			gtUnmapFile(&mapping);
+		else
+			free(pixels);
+	}
+	else
+	{
+		FILE* input = fopen(path, "rb");
+		if(!input)
+			return FALSE;
+		fseek(input, 0, SEEK_END);
+		long length = ftell(input);
+		rewind(input);
+		file->payload = (unsigned char*)malloc(length > 0 ? length : 1);
+		entry->rawSize = (uint32_t)fread(file->payload, 1, length > 0 ? length : 0, input);
+		fclose(input);
+	}
+	entry->size = entry->rawSize;
+
+	if(compress)
+	{
+		unsigned char* block = (unsigned char*)malloc(entry->rawSize + entry->rawSize / 255 + 16);
+		size_t size = compressLZ4(file->payload, entry->rawSize, block);
+		if(size < entry->rawSize)
+		{
+			free(file->payload);
+			file->payload = block;
+			entry->size = (uint32_t)size;
+			entry->flags |= GRAPHTE_ARCHIVE_LZ4;
+		}
+		else
+			free(block);
+	}
+
+	entry->hash = gtHash(file->name);
+	entry->nameLength = (uint32_t)strlen(file->name);
+	return TRUE;
+}
+
+int pack(const char* archivePath, const char* root, BOOL compress)
+{
+	collect(root, "");
+	if(!fileCount)
+	{
+		fprintf(stderr, "no files found in %s\n", root);
+		return 1;
+	}
+	qsort(files, fileCount, sizeof(packedFile), compareNames);
+
+	gtArchiveHeader header = {GRAPHTE_ARCHIVE_MAGIC, GRAPHTE_ARCHIVE_VERSION, (uint32_t)fileCount, 1};
+	while(header.bucketCount < 2 * (uint32_t)fileCount)
+		header.bucketCount *= 2;
+	header.bucketOffset = sizeof(gtArchiveHeader);
+	header.entryOffset = header.bucketOffset + header.bucketCount * sizeof(uint32_t);
+
+	//the names follow the entries, then every payload starts at the next aligned offset
+	uint32_t offset = header.entryOffset + fileCount * sizeof(gtArchiveEntry);
+	for(int i = 0; i < fileCount; i++)
+	{
+		if(!loadFile(root, &files[i], compress))
+		{
+			fprintf(stderr, "cannot read %s/%s\n", root, files[i].name);
+			return 1;
+		}
+		files[i].entry.nameOffset = offset;
+		offset += files[i].entry.nameLength;
+	}
+	for(int i = 0; i < fileCount; i++)
+	{
+		offset = (offset + GRAPHTE_ARCHIVE_ALIGNMENT - 1) / GRAPHTE_ARCHIVE_ALIGNMENT * GRAPHTE_ARCHIVE_ALIGNMENT;
+		files[i].entry.offset = offset;
+		offset += files[i].entry.size;
+	}
+
+	uint32_t* buckets = (uint32_t*)calloc(header.bucketCount, sizeof(uint32_t));
+	for(int i = 0; i < fileCount; i++)
+	{
+		uint32_t slot = files[i].entry.hash & (header.bucketCount - 1);
+		while(buckets[slot])
+			slot = (slot + 1) & (header.bucketCount - 1);
+		buckets[slot] = i + 1;
+	}
+
+	FILE* output = fopen(archivePath, "wb");
+	if(!output)
+	{
+		fprintf(stderr, "cannot write %s\n", archivePath);
+		return 1;
+	}
+
+	BOOL written = fwrite(&header, sizeof(header), 1, output) == 1;
+	written &= fwrite(buckets, sizeof(uint32_t), header.bucketCount, output) == header.bucketCount;
+	for(int i = 0; i < fileCount; i++)
+		written &= fwrite(&files[i].entry, sizeof(gtArchiveEntry), 1, output) == 1;
+	for(int i = 0; i < fileCount; i++)
+		written &= fwrite(files[i].name, 1, files[i].entry.nameLength, output) == files[i].entry.nameLength;
+
+	static const unsigned char padding[GRAPHTE_ARCHIVE_ALIGNMENT] = {0};
+	size_t stored = 0, raw = 0;
+	for(int i = 0; i < fileCount; i++)
+	{
+		long position = ftell(output);
+		written &= fwrite(padding, 1, files[i].entry.offset - position, output) == files[i].entry.offset - position;
+		written &= fwrite(files[i].payload, 1, files[i].entry.size, output) == files[i].entry.size;
+		stored += files[i].entry.size;
+		raw += files[i].entry.rawSize;
+	}
+	written &= fclose(output) == 0;
+
+	if(!written)
+	{
+		fprintf(stderr, "cannot write %s\n", archivePath);
+		return 1;
+	}
+	printf("%d files, %zu bytes of content stored in %zu bytes, %s\n", fileCount, raw, stored, archivePath);
+	return 0;
+}
+
+int list(const char* archivePath)
+{
+	if(!mountArchive((char*)archivePath))
+	{
+		fprintf(stderr, "%s is not a valid archive\n", archivePath);
+		return 1;
+	}
+
+	for(uint32_t i = 0; i < gtArchive.header->entryCount; i++)
+	{
+		const gtArchiveEntry* entry = &gtArchive.entries[i];
+		char kind[32] = "file";
+		if(entry->flags & GRAPHTE_ARCHIVE_PIXELS)
+			snprintf(kind, sizeof(kind), "image %ux%u%s", entry->width, entry->height, entry->flags & GRAPHTE_ARCHIVE_TRANSLUCENT ? " alpha" : "");
+		printf("%-40.*s %-20s %10u %10u%s\n", (int)entry->nameLength, (const char*)gtArchive.file.data + entry->nameOffset, kind, entry->rawSize, entry->size, entry->flags & GRAPHTE_ARCHIVE_LZ4 ? " lz4" : "");
+	}
+
+	unmountArchive();
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc == 3 && !strcmp(argv[1], "-l"))
+		return list(argv[2]);
+	if(argc == 3)
+		return pack(argv[1], argv[2], FALSE);
+	if(argc == 4 && !strcmp(argv[1], "-c"))
+		return pack(argv[2], argv[3], TRUE);
+
+	fprintf(stderr, "usage: %s [-c] <archive> <directory> | -l <archive>\n", argv[0]);
+	return 2;
+}